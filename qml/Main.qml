@@ -95,6 +95,16 @@ ApplicationWindow {
                 }
             }
 
+            Label {
+                visible: connectionManager.fleetExpected > 0
+                text: connectionManager.fleetReadyMs >= 0
+                      ? "Fleet ready in " + (connectionManager.fleetReadyMs / 1000).toFixed(1) + " s"
+                      : "Fleet " + (connectionManager.fleetExpected - connectionManager.fleetWaiting)
+                        + "/" + connectionManager.fleetExpected + " ready"
+                font.pixelSize: 13
+                color: connectionManager.fleetReadyMs >= 0 ? "#81c784" : "#ffb74d"
+            }
+
             Rectangle {
                 Layout.preferredWidth: connectedLabel.implicitWidth + 24
                 Layout.preferredHeight: 32
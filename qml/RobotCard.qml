@@ -9,16 +9,25 @@ Rectangle {
     property string robotAddress: "00:00:00:00:00:00"
     property string connectionState: "Disconnected"
     property int rssi: -100
+    property int linkQuality: 0
+    property real updateRate: 0.0
+    property real lossPercent: 0.0
+    property real jitterMs: 0.0
+    property var linkCounters: ({})
     property string lastData: ""
     property string lastDataTime: ""
     property int robotIndex: 0
     property string deviceType: "Unknown"
+    property int snapshotSlot: -1       // FleetSnapshot slot feeding the charts
+    property bool stale: false          // connected, but no data within its deadline
 
     // BMS data
     property real totalVoltage: 0.0
     property real current: 0.0
     property int soc: 0
-    property var cellVoltages: []
+    property string cellReadout: ""     // "C1 3.301V  C2 ...", built by RobotListModel
+    property string cellSummary: ""     // min, max and spread
+    property int cellSpreadMv: 0
 
     // Falcons Robot data
     property int playState: 0
@@ -41,6 +50,7 @@ Rectangle {
             case "Connected":  return "#4caf50"
             case "Connecting": return "#2196f3"
             case "Error":      return "#f44336"
+            case "Watching":   return "#7e57c2"
             default:           return "#555555"
         }
     }
@@ -55,6 +65,12 @@ Rectangle {
         }
     }
 
+    // A reused delegate shows another robot: drop this card's view state
+    function resetView() {
+        wifiListExpanded.visible = false
+        contentFlick.contentY = 0
+    }
+
     color: "#1e1e1e"
     border.color: isFalconsRobot ? playStateColor : stateColor
     border.width: 2
@@ -73,7 +89,7 @@ Rectangle {
         z: 1
 
         contentItem: Label {
-            text: "✕  Disconnect"
+            text: connectionState === "Watching" ? "✕  Stop watching" : "✕  Disconnect"
             font.pixelSize: 14
             color: "white"
             horizontalAlignment: Text.AlignHCenter
@@ -158,12 +174,67 @@ Rectangle {
                     }
                 }
 
+                // Stale badge: the link is up but the device stopped sending
+                Rectangle {
+                    visible: stale && connectionState === "Ready"
+                    Layout.preferredWidth: staleBadgeLabel.implicitWidth + 12
+                    Layout.preferredHeight: 22
+                    radius: 11
+                    color: "#e65100"
+
+                    Label {
+                        id: staleBadgeLabel
+                        anchors.centerIn: parent
+                        text: "Stale"
+                        font.pixelSize: 10
+                        font.bold: true
+                        color: "white"
+                    }
+
+                    ToolTip.visible: staleMouse.containsMouse
+                    ToolTip.text: lastDataTime ? "No data since " + lastDataTime : "No data received"
+
+                    MouseArea {
+                        id: staleMouse
+                        anchors.fill: parent
+                        hoverEnabled: true
+                    }
+                }
+
+                // RSSI sparkline (filtered, -100..-40 dBm), drawn from the fleet snapshot
+                Sparkline {
+                    Layout.preferredWidth: 60
+                    Layout.preferredHeight: 16
+                    visible: connectionState === "Ready"
+                    snapshotSlot: root.snapshotSlot
+                    channel: TelemetryItem.Rssi
+                    minimum: -100
+                    maximum: -40
+                    capacity: 40
+                    color: rssi > -70 ? "#4caf50" :
+                           rssi > -85 ? "#ff9800" : "#f44336"
+                }
+
                 Label {
                     text: rssi + " dBm"
                     font.pixelSize: 12
                     color: rssi > -70 ? "#4caf50" :
                            rssi > -85 ? "#ff9800" : "#f44336"
                     visible: connectionState === "Connected" || connectionState === "Ready"
+
+                    ToolTip.visible: rssiMouse.containsMouse && connectionState === "Ready"
+                    ToolTip.text: "Link quality " + linkQuality + "%\n"
+                                  + updateRate.toFixed(1) + " notif/s, jitter " + jitterMs.toFixed(1) + " ms"
+                                  + (linkCounters.sequenced
+                                     ? "\nLoss " + lossPercent.toFixed(2) + "% (" + linkCounters.lost + " lost, "
+                                       + linkCounters.reordered + " reordered)"
+                                     : "")
+
+                    MouseArea {
+                        id: rssiMouse
+                        anchors.fill: parent
+                        hoverEnabled: true
+                    }
                 }
             }
 
@@ -189,7 +260,7 @@ Rectangle {
             ColumnLayout {
                 Layout.fillWidth: true
                 spacing: 10
-                visible: isFalconsRobot && connectionState === "Ready"
+                visible: isFalconsRobot && (connectionState === "Ready" || connectionState === "Watching")
 
                 // ── Play State Display & Control ──
                 ColumnLayout {
@@ -349,7 +420,8 @@ Rectangle {
                             visible: false
 
                             Repeater {
-                                model: root.wifiList
+                                // Built when expanded, not for every card
+                                model: wifiListExpanded.visible ? root.wifiList : []
 
                                 Button {
                                     Layout.fillWidth: true
@@ -461,11 +533,23 @@ Rectangle {
                     }
                 }
 
+                // Current range per second over the last minute
+                MinMaxBandChart {
+                    Layout.fillWidth: true
+                    Layout.preferredHeight: 28
+                    visible: root.snapshotSlot >= 0
+                    snapshotSlot: root.snapshotSlot
+                    channel: TelemetryItem.Current
+                    minimum: -20
+                    maximum: 20
+                    color: "#2196f3"
+                }
+
                 // ── Cell Voltages ──
                 ColumnLayout {
                     Layout.fillWidth: true
                     spacing: 4
-                    visible: root.cellVoltages.length > 0
+                    visible: root.cellReadout.length > 0
 
                     Rectangle {
                         Layout.fillWidth: true
@@ -479,53 +563,30 @@ Rectangle {
                         color: "#aaaaaa"
                     }
 
-                    Repeater {
-                        model: root.cellVoltages.length
-
-                        RowLayout {
-                            Layout.fillWidth: true
-                            spacing: 8
-
-                            required property int index
-
-                            Label {
-                                text: "C" + (index + 1)
-                                font.pixelSize: 11
-                                color: "#888888"
-                                Layout.preferredWidth: 24
-                            }
+                    // One bar per cell, drawn from the fleet snapshot
+                    CellBarStrip {
+                        Layout.fillWidth: true
+                        Layout.preferredHeight: 36
+                        snapshotSlot: root.snapshotSlot
+                        minimumVoltage: 2.5
+                        maximumVoltage: 4.2
+                    }
 
-                            Rectangle {
-                                Layout.fillWidth: true
-                                height: 14
-                                radius: 3
-                                color: "#252525"
-
-                                Rectangle {
-                                    property real cellV: root.cellVoltages[index] || 0
-                                    property real pct: Math.max(0, Math.min(100, (cellV - 2.5) / 1.7 * 100))
-                                    width: parent.width * pct / 100
-                                    height: parent.height
-                                    radius: 3
-                                    color: pct > 60 ? "#4caf50" :
-                                           pct > 25 ? "#ff9800" : "#f44336"
-
-                                    Behavior on width {
-                                        NumberAnimation { duration: 300; easing.type: Easing.OutCubic }
-                                    }
-                                }
-                            }
+                    // Per-cell readout; plain text, readable on the touchscreen
+                    Label {
+                        Layout.fillWidth: true
+                        text: root.cellReadout
+                        wrapMode: Text.WordWrap
+                        font.pixelSize: 11
+                        font.family: "monospace"
+                        color: "#cccccc"
+                    }
 
-                            Label {
-                                text: (root.cellVoltages[index] || 0).toFixed(3) + "V"
-                                font.pixelSize: 11
-                                font.family: "monospace"
-                                font.bold: true
-                                color: "#cccccc"
-                                Layout.preferredWidth: 54
-                                horizontalAlignment: Text.AlignRight
-                            }
-                        }
+                    Label {
+                        text: root.cellSummary
+                        font.pixelSize: 11
+                        font.family: "monospace"
+                        color: root.cellSpreadMv > 100 ? "#ff9800" : "#888888"
                     }
                 }
             }
@@ -534,6 +595,7 @@ Rectangle {
             Label {
                 text: connectionState === "Connecting" ? "Connecting\u2026" :
                       connectionState === "Connected" || connectionState === "Ready"
+                          || connectionState === "Watching"
                           ? (isFalconsRobot ? "Waiting for robot data\u2026" : "Waiting for data\u2026") : ""
                 font.pixelSize: 14
                 color: "#666666"
@@ -542,7 +604,7 @@ Rectangle {
                     if (connectionState === "Disconnected" || connectionState === "Error")
                         return false
                     if (isFalconsRobot)
-                        return connectionState !== "Ready"
+                        return connectionState !== "Ready" && connectionState !== "Watching"
                     return totalVoltage === 0
                 }
             }
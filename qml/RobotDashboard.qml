@@ -60,6 +60,32 @@ Item {
                         onClicked: connectionManager.writePlayStateAll(modelData.state)
                     }
                 }
+
+                Label {
+                    property var fleet: connectionManager.fleetCommand
+                    visible: fleet.totalCount > 0
+                    text: fleet.confirmedCount + "/" + fleet.totalCount
+                          + (fleet.active ? " …" : " · " + fleet.elapsedMs.toFixed(0) + " ms")
+                    font.pixelSize: 10
+                    color: fleet.active ? "#ffb300"
+                         : fleet.failedCount > 0 ? "#f44336" : "#4caf50"
+
+                    HoverHandler { id: fleetHover }
+                    ToolTip.visible: fleetHover.hovered
+                    ToolTip.text: {
+                        var lines = [fleet.commandName]
+                        for (var i = 0; i < fleet.results.length; ++i) {
+                            var r = fleet.results[i]
+                            var line = r.name + ": " + r.status
+                            if (r.ackMs >= 0) line += "  ack " + r.ackMs.toFixed(0) + " ms"
+                            if (r.confirmMs >= 0) line += "  confirm " + r.confirmMs.toFixed(0) + " ms"
+                            if (r.attempts > 1) line += "  (" + r.attempts + " tries)"
+                            if (r.error) line += "  " + r.error
+                            lines.push(line)
+                        }
+                        return lines.join("\n")
+                    }
+                }
             }
 
             Label {
@@ -68,6 +94,56 @@ Item {
                 color: connectionManager.connectedCount > 0 ? "#4caf50" : "#888888"
             }
 
+            // ── Fleet battery and link overview ──
+            Label {
+                property var aggregates: connectionManager.fleetAggregates
+                visible: aggregates.minSoc >= 0 || aggregates.lowBatteryCount > 0 || aggregates.staleCount > 0
+                text: {
+                    var parts = []
+                    if (aggregates.minSoc >= 0)
+                        parts.push("🔋 " + aggregates.minSoc + "% min")
+                    if (aggregates.minCellVoltage > 0)
+                        parts.push(aggregates.minCellVoltage.toFixed(2) + " V cell")
+                    if (aggregates.minSoc >= 0)
+                        parts.push(aggregates.totalCurrent.toFixed(1) + " A")
+                    if (aggregates.lowBatteryCount > 0)
+                        parts.push(aggregates.lowBatteryCount + " low")
+                    if (aggregates.staleCount > 0)
+                        parts.push(aggregates.staleCount + " stale")
+                    return parts.join("  ·  ")
+                }
+                font.pixelSize: 12
+                color: aggregates.lowBatteryCount > 0 ? "#f44336"
+                     : aggregates.staleCount > 0 ? "#ff9800" : "#aaaaaa"
+
+                HoverHandler { id: aggregatesHover }
+                ToolTip.visible: aggregatesHover.hovered
+                ToolTip.text: {
+                    var states = aggregates.stateCounts
+                    var types = aggregates.typeCounts
+                    var lines = [
+                        "Ready " + states[3] + ", setting up " + (states[1] + states[2])
+                            + ", watching " + states[5] + ", down " + (states[0] + states[4]),
+                        "Robots " + types[1] + ", BMS packs " + types[2] + ", other " + types[0]
+                    ]
+                    if (aggregates.minSoc >= 0)
+                        lines.push("Lowest SoC: " + aggregates.minSocName + " (" + aggregates.minSocAddress + ")")
+                    return lines.join("\n")
+                }
+            }
+
+            Button {
+                text: "⏱"
+                font.pixelSize: 13
+                visible: connectionManager.connectedCount > 0
+                ToolTip.visible: hovered
+                ToolTip.text: "Command latency"
+                onClicked: {
+                    latencyPopup.report = connectionManager.commandLatencyReport()
+                    latencyPopup.open()
+                }
+            }
+
             Button {
                 text: "Disconnect All"
                 font.pixelSize: 13
@@ -88,6 +164,82 @@ Item {
             }
         }
 
+        // ── Command latency dump ──
+        Popup {
+            id: latencyPopup
+            property string report: ""
+            property string exportedPath: ""
+            parent: Overlay.overlay
+            anchors.centerIn: parent
+            width: Math.min(parent.width - 40, 720)
+            modal: true
+            onClosed: exportedPath = ""
+
+            background: Rectangle {
+                color: "#1e1e1e"
+                border.color: "#555555"
+                radius: 8
+            }
+
+            ColumnLayout {
+                anchors.fill: parent
+                spacing: 8
+
+                Label {
+                    text: "Play-state command latency (ms per stage)"
+                    font.pixelSize: 14
+                    font.bold: true
+                    color: "white"
+                }
+
+                ScrollView {
+                    Layout.fillWidth: true
+                    Layout.preferredHeight: 320
+                    clip: true
+
+                    TextArea {
+                        text: latencyPopup.report
+                        readOnly: true
+                        font.family: "monospace"
+                        font.pixelSize: 11
+                        color: "#dddddd"
+                        wrapMode: TextEdit.NoWrap
+                        background: null
+                    }
+                }
+
+                Label {
+                    visible: latencyPopup.exportedPath !== ""
+                    text: "Saved to " + latencyPopup.exportedPath
+                    font.pixelSize: 10
+                    color: "#81c784"
+                    elide: Text.ElideMiddle
+                    Layout.fillWidth: true
+                }
+
+                RowLayout {
+                    Layout.alignment: Qt.AlignRight
+                    spacing: 8
+
+                    Button {
+                        text: "Reset"
+                        onClicked: {
+                            connectionManager.resetCommandLatency()
+                            latencyPopup.report = connectionManager.commandLatencyReport()
+                        }
+                    }
+                    Button {
+                        text: "Export CSV"
+                        onClicked: latencyPopup.exportedPath = connectionManager.exportCommandLatency()
+                    }
+                    Button {
+                        text: "Close"
+                        onClicked: latencyPopup.close()
+                    }
+                }
+            }
+        }
+
         // ── Device cards grid ──
         Rectangle {
             Layout.fillWidth: true
@@ -101,29 +253,45 @@ Item {
                 cellWidth: Math.max(300, width / Math.max(1, Math.floor(width / 340)))
                 cellHeight: 480
 
+                // Only the visible cards (plus one row) exist; scrolled-out cards are reused
+                reuseItems: true
+                cacheBuffer: cellHeight
+
                 model: connectionManager.robotListModel
 
                 delegate: Item {
                     width: deviceGrid.cellWidth
                     height: deviceGrid.cellHeight
 
+                    GridView.onReused: card.resetView()
+
                     RobotCard {
+                        id: card
                         anchors.fill: parent
                         anchors.margins: 6
                         robotName: model.name
                         robotAddress: model.address
                         connectionState: model.connectionState
                         rssi: model.rssi
+                        linkQuality: model.linkQuality !== undefined ? model.linkQuality : 0
+                        updateRate: model.updateRate !== undefined ? model.updateRate : 0
+                        lossPercent: model.lossPercent !== undefined ? model.lossPercent : 0
+                        jitterMs: model.jitterMs !== undefined ? model.jitterMs : 0
+                        linkCounters: model.linkCounters !== undefined ? model.linkCounters : ({})
                         lastData: model.lastData
                         lastDataTime: model.lastDataTime
                         robotIndex: index
                         deviceType: model.deviceType !== undefined ? model.deviceType : "Unknown"
+                        snapshotSlot: model.snapshotSlot !== undefined ? model.snapshotSlot : -1
+                        stale: model.stale !== undefined ? model.stale : false
 
                         // BMS data
                         totalVoltage: model.totalVoltage
                         current: model.current
                         soc: model.soc
-                        cellVoltages: model.cellVoltages !== undefined ? model.cellVoltages : []
+                        cellReadout: model.cellReadout !== undefined ? model.cellReadout : ""
+                        cellSummary: model.cellSummary !== undefined ? model.cellSummary : ""
+                        cellSpreadMv: model.cellSpreadMv !== undefined ? model.cellSpreadMv : 0
 
                         // Falcons Robot data
                         playState: model.playState !== undefined ? model.playState : 0
@@ -5,6 +5,13 @@ import QtQuick.Layouts
 Item {
     id: root
 
+    // Scan continuously while this page is shown; duty-cycled otherwise
+    Binding {
+        target: bleScanner
+        property: "discoveryRequested"
+        value: root.SwipeView.isCurrentItem
+    }
+
     ColumnLayout {
         anchors.fill: parent
         anchors.margins: 16
@@ -43,6 +50,22 @@ Item {
                 text: deviceListView.count + " devices found"
                 font.pixelSize: 14
                 color: "#aaaaaa"
+
+                ToolTip.visible: countMouse.containsMouse
+                ToolTip.text: bleScanner.publishedUpdateCount + " of " + bleScanner.rawUpdateCount
+                              + " advertisement updates shown (every "
+                              + bleScanner.publishIntervalMs + " ms, ≥ "
+                              + bleScanner.rssiThreshold + " dB)\n"
+                              + bleScanner.deviceCount + "/" + bleScanner.maxDevices + " devices tracked, "
+                              + bleScanner.evictedCount + " evicted, ~"
+                              + Math.round(bleScanner.memoryEstimate / 1024) + " KiB\n"
+                              + "Scan: " + bleScanner.scanSummary
+
+                MouseArea {
+                    id: countMouse
+                    anchors.fill: parent
+                    hoverEnabled: true
+                }
             }
         }
 
@@ -62,7 +85,7 @@ Item {
                 clip: true
                 spacing: 6
 
-                model: bleScanner.discoveredDevices
+                model: bleScanner.devices
 
                 delegate: Rectangle {
                     width: deviceListView.width
@@ -89,12 +112,12 @@ Item {
                             Layout.preferredWidth: 48
                             Layout.preferredHeight: 48
                             radius: 24
-                            color: modelData.rssi > -70 ? "#1b5e20" :
-                                   modelData.rssi > -85 ? "#e65100" : "#b71c1c"
+                            color: model.rssi > -70 ? "#1b5e20" :
+                                   model.rssi > -85 ? "#e65100" : "#b71c1c"
 
                             Label {
                                 anchors.centerIn: parent
-                                text: modelData.rssi
+                                text: model.rssi
                                 font.pixelSize: 12
                                 font.bold: true
                                 color: "white"
@@ -108,7 +131,7 @@ Item {
                             RowLayout {
                                 spacing: 6
                                 Label {
-                                    text: modelData.name || "Unknown"
+                                    text: model.name || "Unknown"
                                     font.pixelSize: 16
                                     font.bold: true
                                     color: "white"
@@ -118,34 +141,84 @@ Item {
 
                                 // Device type badge
                                 Rectangle {
-                                    visible: {
-                                        var n = modelData.name || ""
-                                        return n.startsWith("Falcons-") || n.indexOf("SmartBMS") >= 0
-                                    }
+                                    visible: model.deviceType !== "Unknown"
                                     width: dtBadgeLbl.implicitWidth + 10
                                     height: 18
                                     radius: 9
-                                    color: (modelData.name || "").startsWith("Falcons-") ? "#1a237e" : "#004d40"
+                                    color: model.deviceType === "FalconsRobot" ? "#1a237e" : "#004d40"
 
                                     Label {
                                         id: dtBadgeLbl
                                         anchors.centerIn: parent
-                                        text: (modelData.name || "").startsWith("Falcons-") ? "Robot" : "BMS"
+                                        text: model.deviceType === "FalconsRobot" ? "Robot" : "BMS"
                                         font.pixelSize: 9
                                         font.bold: true
                                         color: "white"
                                     }
                                 }
+
+                                // Remembered devices reconnect on their own
+                                Rectangle {
+                                    visible: connectionManager.knownDevices.count > 0
+                                             && connectionManager.knownDevices.isKnown(model.address)
+                                    width: knownBadgeLbl.implicitWidth + 10
+                                    height: 18
+                                    radius: 9
+                                    color: "#37474f"
+
+                                    Label {
+                                        id: knownBadgeLbl
+                                        anchors.centerIn: parent
+                                        text: "Known"
+                                        font.pixelSize: 9
+                                        font.bold: true
+                                        color: "white"
+                                    }
+
+                                    MouseArea {
+                                        id: knownMouse
+                                        anchors.fill: parent
+                                        hoverEnabled: true
+                                        onClicked: connectionManager.knownDevices.forget(model.address)
+                                    }
+                                    ToolTip.visible: knownMouse.containsMouse
+                                    ToolTip.text: "Connects at launch and when it advertises. Click to forget."
+                                }
                             }
 
                             Label {
-                                text: modelData.address
+                                text: model.address
                                 font.pixelSize: 12
                                 color: "#999999"
                                 font.family: "monospace"
                             }
                         }
 
+                        // Broadcasting devices can be monitored without a connection
+                        Button {
+                            text: "Watch"
+                            visible: model.broadcasting
+                            font.pixelSize: 14
+                            Layout.preferredWidth: 90
+                            Layout.preferredHeight: 40
+                            contentItem: Label {
+                                text: parent.text
+                                font: parent.font
+                                color: "white"
+                                horizontalAlignment: Text.AlignHCenter
+                                verticalAlignment: Text.AlignVCenter
+                            }
+                            background: Rectangle {
+                                color: parent.hovered ? "#5e35b1" : "#7e57c2"
+                                radius: 6
+                            }
+                            onClicked: {
+                                console.log("Watching device:", model.address)
+                                var device = bleScanner.getDeviceByAddress(model.address)
+                                connectionManager.watchRobot(device)
+                            }
+                        }
+
                         Button {
                             text: "Connect"
                             font.pixelSize: 14
@@ -163,8 +236,8 @@ Item {
                                 radius: 6
                             }
                             onClicked: {
-                                console.log("Connecting to device:", modelData.address)
-                                var device = bleScanner.getDeviceByAddress(modelData.address)
+                                console.log("Connecting to device:", model.address)
+                                var device = bleScanner.getDeviceByAddress(model.address)
                                 connectionManager.connectRobot(device)
                             }
                         }
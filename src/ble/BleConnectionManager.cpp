@@ -1,21 +1,84 @@
 #include "BleConnectionManager.h"
 #include "BleDeviceScanner.h"
+#include "BleWorker.h"
+#include "LinkPublisher.h"
+#include "src/protocol/RpcClient.h"
+#include "src/protocol/BulkTransfer.h"
+#include "src/protocol/MonotonicClock.h"
 #include <QDebug>
-
-BleConnectionManager::BleConnectionManager(QObject *parent)
+#include <QDateTime>
+#include <QDir>
+#include <QSettings>
+#include <QStandardPaths>
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <utility>
+
+BleConnectionManager::BleConnectionManager(BleWorker *worker, QObject *parent)
     : QObject(parent)
+    , m_worker(worker)
+    , m_linkDeltas(QSharedPointer<LinkDeltaQueue>::create())
+    , m_fleetSnapshot(QSharedPointer<FleetSnapshot>::create())
     , m_scanner(nullptr)
     , m_connectedCount(0)
+    , m_maxDevices(DEFAULT_MAX_DEVICES)
+    , m_linkStateCounts{}
     , m_nextRobotId(1)
+    , m_nextLinkId(1)
+    , m_fleetCommand(new FleetCommandFanout(this))
+    , m_commandLatency(new CommandLatencyTracker(this))
+    , m_knownDevices(new KnownDeviceRegistry(this))
+    , m_launchNs(MonotonicClock::nowNs())
+    , m_fleetExpected(0)
+    , m_fleetReadyMs(-1)
 {
     m_robotListModel = new RobotListModel(this);
+    m_linkDeltas->setReceiver(this);
+
+    setMaxDevices(QSettings().value(QStringLiteral("connections/maxDevices"), DEFAULT_MAX_DEVICES).toInt());
+
+    connect(m_fleetCommand, &FleetCommandFanout::writeRequested,
+            this, &BleConnectionManager::onFleetWriteRequested);
+    connect(m_fleetCommand, &FleetCommandFanout::boostRequested,
+            this, &BleConnectionManager::onFleetBoostRequested);
 }
 
 BleConnectionManager::~BleConnectionManager()
 {
+    // Links still publishing while they tear down must not wake a dead receiver
+    m_linkDeltas->setReceiver(nullptr);
     disconnectAll();
 }
 
+void BleConnectionManager::setScanner(BleDeviceScanner *scanner)
+{
+    if (m_scanner) {
+        QObject::disconnect(m_scanner, nullptr, this, nullptr);
+    }
+    m_scanner = scanner;
+    if (m_scanner) {
+        connect(m_scanner, &BleDeviceScanner::telemetryReceived,
+                this, &BleConnectionManager::onScannerTelemetry);
+        connect(m_scanner, &BleDeviceScanner::deviceDiscovered,
+                this, &BleConnectionManager::onScannerDeviceDiscovered);
+    }
+}
+
+void BleConnectionManager::setMaxDevices(int count)
+{
+    count = std::clamp(count, 1, FleetSnapshot::MAX_SLOTS);
+    if (m_maxDevices != count) {
+        m_maxDevices = count;
+        emit maxDevicesChanged();
+    }
+}
+
+int BleConnectionManager::connectionCount() const
+{
+    return m_links.size() + m_connectQueue.size();
+}
+
 void BleConnectionManager::connectRobot(const QBluetoothDeviceInfo &device)
 {
     // Check if already connected to this device
@@ -25,14 +88,13 @@ void BleConnectionManager::connectRobot(const QBluetoothDeviceInfo &device)
         return;
     }
 
-    // Check if we've reached the maximum
-    int totalConnections = m_connections.size() + m_jbdConnections.size() + m_falconsConnections.size();
-    if (totalConnections >= MAX_ROBOTS) {
-        qWarning() << "Maximum number of robots reached:" << MAX_ROBOTS;
+    if (connectionCount() >= m_maxDevices) {
+        qWarning() << "Maximum number of devices reached:" << m_maxDevices;
         return;
     }
 
     qDebug() << "Connecting to device:" << device.name() << address;
+    m_autoConnectSuppressed.remove(address);
 
     // Determine device type: Falcons Robot > JBD BMS > NUS fallback
     bool isFalconsDevice = FalconsRobotConnection::isFalconsDevice(device);
@@ -57,57 +119,350 @@ void BleConnectionManager::connectRobot(const QBluetoothDeviceInfo &device)
         robot.setDeviceType(Robot::SmartBMS);
     m_robotListModel->addRobot(robot);
 
-    int modelIndex = m_robotListModel->count() - 1;
+    // A device that reached Ready before is opened with the address type it used then
+    startConnection(device, robot.deviceType(), m_knownDevices->device(device.address()).addressType);
+}
 
-    // Pause scanning during connection to avoid BlueZ HCI contention
-    if (m_scanner && m_scanner->isScanning()) {
-        m_scanner->stopScan();
+void BleConnectionManager::connectKnownDevices()
+{
+    QList<KnownDevice> admitted;
+    QList<Robot> robots;
+    const QList<KnownDevice> known = m_knownDevices->devices();
+    for (const KnownDevice &device : known) {
+        if (!device.autoConnect) continue;
+        if (admitKnownDevice(device, admitted.size())) {
+            admitted.append(device);
+            robots.append(knownRobot(device, device.toDeviceInfo()));
+        }
     }
 
-    if (isFalconsDevice) {
-        qDebug() << "Detected Falcons Robot device, using FalconsRobotConnection";
+    // The whole fleet's rows go in with one insert; connections start once they exist
+    m_robotListModel->addRobots(robots);
+    for (const KnownDevice &device : std::as_const(admitted)) {
+        const QString address = device.address.toString();
+        m_fleetWaiting.insert(address);
+        m_autoConnectAttemptMs.insert(address, sinceLaunchMs());
+        startConnection(device.toDeviceInfo(), device.deviceType, device.addressType);
+    }
 
-        FalconsRobotConnection *connection = new FalconsRobotConnection(this);
+    m_fleetExpected = m_fleetWaiting.size();
+    qDebug() << "Connecting" << m_fleetExpected << "known devices directly,"
+             << sinceLaunchMs() << "ms after launch";
+    emit fleetReadyChanged();
+}
 
-        connect(connection, &FalconsRobotConnection::connectionStateChanged,
-                this, &BleConnectionManager::onFalconsConnectionStateChanged);
-        connect(connection, &FalconsRobotConnection::robotDataUpdated,
-                this, &BleConnectionManager::onFalconsRobotDataUpdated);
-        connect(connection, &FalconsRobotConnection::errorOccurred,
-                this, &BleConnectionManager::onFalconsErrorOccurred);
+bool BleConnectionManager::connectKnownDevice(const KnownDevice &known, const QBluetoothDeviceInfo &device)
+{
+    if (!admitKnownDevice(known, 0)) {
+        return false;
+    }
 
-        m_falconsConnections.append(connection);
-        connection->connectToDevice(device);
+    m_robotListModel->addRobot(knownRobot(known, device));
+    m_autoConnectAttemptMs.insert(known.address.toString(), sinceLaunchMs());
+    startConnection(device, known.deviceType, known.addressType);
+    return true;
+}
 
-    } else if (isJbdDevice) {
-        qDebug() << "Detected JBD BMS device, using JbdBmsConnection";
+bool BleConnectionManager::admitKnownDevice(const KnownDevice &known, int batched) const
+{
+    const QString address = known.address.toString();
+    if (m_robotListModel->indexOf(known.address) >= 0) {
+        return false;
+    }
+    if (connectionCount() + batched >= m_maxDevices) {
+        qWarning() << "Maximum number of devices reached:" << m_maxDevices << "- not connecting" << address;
+        return false;
+    }
+
+    qDebug() << "Connecting to known device:" << known.name << address;
+    return true;
+}
+
+Robot BleConnectionManager::knownRobot(const KnownDevice &known, const QBluetoothDeviceInfo &device)
+{
+    Robot robot(m_nextRobotId++, known.name, known.address);
+    robot.setConnectionState(Robot::Connecting);
+    robot.setDeviceType(known.deviceType);
+    robot.setRobotIdentity(known.identity);
+    if (device.rssi() != 0) {
+        robot.setRssi(device.rssi());
+    }
+    return robot;
+}
+
+void BleConnectionManager::onScannerDeviceDiscovered(const QBluetoothDeviceInfo &device)
+{
+    if (!m_knownDevices->isAutoConnect(device.address())) return;
+
+    const QString address = device.address().toString();
+    if (m_autoConnectSuppressed.contains(address)) return;
+
+    // Advertisements keep coming while a link is down; don't hammer it
+    const auto last = m_autoConnectAttemptMs.constFind(address);
+    if (last != m_autoConnectAttemptMs.constEnd()
+        && sinceLaunchMs() - last.value() < AUTO_CONNECT_RETRY_MS) {
+        return;
+    }
+
+    const KnownDevice known = m_knownDevices->device(device.address());
+    const int index = findConnectionByAddress(address);
+    if (index < 0) {
+        connectKnownDevice(known, device);
+        return;
+    }
 
-        JbdBmsConnection *connection = new JbdBmsConnection(this);
+    FleetStore *store = m_robotListModel->store();
+    const FleetStore::Handle robot = m_robotListModel->handleAt(index);
+    const Robot::ConnectionState state = store->connectionState(robot);
+    if (state != Robot::Error && state != Robot::Disconnected) {
+        return;
+    }
+
+    qDebug() << "Known device advertising again, reconnecting:" << store->name(robot) << address;
+    m_autoConnectAttemptMs.insert(address, sinceLaunchMs());
+    releaseConnection(address);
+    store->setConnectionState(robot, Robot::Connecting);
+    m_robotListModel->commit(index);
+    startConnection(device, known.deviceType, known.addressType);
+}
+
+void BleConnectionManager::onDeviceReady(int index)
+{
+    const FleetStore *store = m_robotListModel->store();
+    const FleetStore::Handle robot = m_robotListModel->handleAt(index);
+    const QBluetoothAddress address = store->address(robot);
+
+    KnownDevice known = m_knownDevices->device(address);
+    known.address = address;
+    // The type this link reached Ready with, so the next direct connect uses it too
+    const auto link = m_links.constFind(address.toString());
+    if (link != m_links.constEnd()) {
+        known.addressType = link->addressType;
+    }
+    known.deviceType = store->deviceType(robot);
+    known.name = store->name(robot);
+    const QString identity = store->robotIdentity(robot);
+    if (!identity.isEmpty()) {
+        known.identity = identity;
+    }
+    known.lastReady = QDateTime::currentDateTime();
+    m_knownDevices->remember(known);
+
+    emit robotConnected(index);
+    clearFleetWaiting(address.toString());
+}
 
-        connect(connection, &JbdBmsConnection::connectionStateChanged,
-                this, &BleConnectionManager::onJbdConnectionStateChanged);
-        connect(connection, &JbdBmsConnection::bmsDataUpdated,
-                this, &BleConnectionManager::onJbdBmsDataUpdated);
-        connect(connection, &JbdBmsConnection::errorOccurred,
-                this, &BleConnectionManager::onJbdErrorOccurred);
+void BleConnectionManager::clearFleetWaiting(const QString &address)
+{
+    if (m_fleetWaiting.remove(address)) {
+        fleetWaitingReduced();
+    }
+}
+
+void BleConnectionManager::fleetWaitingReduced()
+{
+    if (m_fleetWaiting.isEmpty() && m_fleetReadyMs < 0) {
+        m_fleetReadyMs = sinceLaunchMs();
+        qDebug() << "Known fleet Ready" << m_fleetReadyMs << "ms after launch";
+    }
+    emit fleetReadyChanged();
+}
+
+void BleConnectionManager::watchRobot(const QBluetoothDeviceInfo &device)
+{
+    QString address = device.address().toString();
+    if (findConnectionByAddress(address) >= 0) {
+        qWarning() << "Already connected to or watching device:" << address;
+        return;
+    }
 
-        m_jbdConnections.append(connection);
-        connection->connectToDevice(device);
+    const AdvertisementTelemetry telemetry = AdvertisementTelemetry::decode(device);
+    if (!telemetry.isValid()) {
+        qWarning() << "Device does not broadcast telemetry:" << address;
+        return;
+    }
+
+    qDebug() << "Watching device:" << device.name() << address;
+
+    Robot robot(m_nextRobotId++, device.name(), device.address());
+    robot.setConnectionState(Robot::Watching);
+    robot.setDeviceType(telemetry.kind == AdvertisementTelemetry::RobotRecord ? Robot::FalconsRobot
+                                                                             : Robot::SmartBMS);
+    m_robotListModel->addRobot(robot);
+    onScannerTelemetry(device, telemetry);
+}
+
+bool BleConnectionManager::promoteWatchedRobot(int index,
+                                               std::function<void(FalconsRobotConnection*)> command)
+{
+    FleetStore *store = m_robotListModel->store();
+    const FleetStore::Handle robot = m_robotListModel->handleAt(index);
+    const QString address = store->address(robot).toString();
+
+    // Already being promoted: the newest command replaces the queued one
+    if (m_pendingCommands.contains(address)) {
+        m_pendingCommands.insert(address, command);
+        return true;
+    }
+
+    if (store->connectionState(robot) != Robot::Watching || store->deviceType(robot) != Robot::FalconsRobot) {
+        return false;
+    }
+    if (connectionCount() >= m_maxDevices) {
+        qWarning() << "Maximum number of devices reached:" << m_maxDevices << "- cannot promote" << address;
+        return false;
+    }
+
+    const QBluetoothDeviceInfo device = m_scanner ? m_scanner->getDeviceByAddress(address)
+                                                  : QBluetoothDeviceInfo();
+    if (!device.isValid()) {
+        qWarning() << "No advertisement seen for watched robot" << address;
+        return false;
+    }
+
+    qDebug() << "Promoting watched robot to a connection:" << store->name(robot) << address;
+    m_pendingCommands.insert(address, command);
+    m_telemetrySequence.remove(address);
+
+    store->setConnectionState(robot, Robot::Connecting);
+    m_robotListModel->commit(index);
+    startConnection(device, Robot::FalconsRobot, m_knownDevices->device(device.address()).addressType);
+    return true;
+}
+
+void BleConnectionManager::onScannerTelemetry(const QBluetoothDeviceInfo &device,
+                                              const AdvertisementTelemetry &telemetry)
+{
+    const QString address = device.address().toString();
+    int index = findConnectionByAddress(address);
+    if (index < 0) return;
+
+    // Once connected, GATT data is authoritative
+    FleetStore *store = m_robotListModel->store();
+    const FleetStore::Handle robot = m_robotListModel->handleAt(index);
+    if (store->connectionState(robot) != Robot::Watching) return;
+
+    const auto last = m_telemetrySequence.constFind(address);
+    if (last != m_telemetrySequence.constEnd() && last.value() == telemetry.sequence
+        && store->rssi(robot) == device.rssi()) {
+        return;
+    }
+    m_telemetrySequence.insert(address, telemetry.sequence);
+
+    store->setRssi(robot, device.rssi());
+    if (!device.name().isEmpty()) {
+        store->setName(robot, device.name());
+    }
+    if (telemetry.kind == AdvertisementTelemetry::RobotRecord) {
+        store->setPlayState(robot, telemetry.playState);
+        store->setBatteryVoltage(robot, telemetry.batteryVoltage);
+    } else {
+        store->setSoc(robot, telemetry.soc);
+        store->setTotalVoltage(robot, telemetry.totalVoltage);
+        store->setCurrent(robot, telemetry.current);
+    }
+    store->setLastPacketTime(robot, MonotonicClock::nowNs());
+    m_robotListModel->commit(index);
+}
+
+void BleConnectionManager::startConnection(const QBluetoothDeviceInfo &device, Robot::DeviceType type,
+                                           QLowEnergyController::RemoteAddressType addressType)
+{
+    m_connectQueue.append({ device, type, addressType });
+    drainConnectQueue();
+
+    // Scanning pauses while connections are queued or set up
+    updateScanSchedule();
+}
+
+void BleConnectionManager::drainConnectQueue()
+{
+    int pending = 0;
+    int active = 0;
+    countLinks(pending, active);
+    while (!m_connectQueue.isEmpty() && pending < MAX_CONCURRENT_SETUPS) {
+        const QueuedConnection next = m_connectQueue.takeFirst();
+        openConnection(next.device, next.type, next.addressType);
+        pending++;
+    }
+}
+
+void BleConnectionManager::openConnection(const QBluetoothDeviceInfo &device, Robot::DeviceType type,
+                                          QLowEnergyController::RemoteAddressType addressType)
+{
+    const QString address = device.address().toString();
+    Link link;
+    link.id = m_nextLinkId++;
+    link.type = type;
+    link.name = device.name();
+    link.device = device;
+    link.addressType = addressType;
+
+    // Connections are created parentless, wired to a publisher and then handed to the worker
+    QObject *connection = nullptr;
+    LinkPublisher *publisher = nullptr;
+    if (type == Robot::FalconsRobot) {
+        qDebug() << "Detected Falcons Robot device, using FalconsRobotConnection";
+        link.falcons = new FalconsRobotConnection(m_worker->timers());
+        publisher = LinkPublisher::attach(link.falcons, address, link.id, m_linkDeltas);
+        connection = link.falcons;
+    } else if (type == Robot::SmartBMS) {
+        qDebug() << "Detected JBD BMS device, using JbdBmsConnection";
+        link.jbd = new JbdBmsConnection(m_worker->timers());
+        publisher = LinkPublisher::attach(link.jbd, address, link.id, m_linkDeltas);
+        connection = link.jbd;
     } else {
         qDebug() << "Using NUS BleRobotConnection";
+        link.nus = new BleRobotConnection(m_worker->timers());
+        publisher = LinkPublisher::attach(link.nus, address, link.id, m_linkDeltas);
+        connect(publisher, &LinkPublisher::rpcFinished,
+                this, &BleConnectionManager::onRpcCallFinished);
+        connect(publisher, &LinkPublisher::transferProgress,
+                this, &BleConnectionManager::transferProgress);
+        connect(publisher, &LinkPublisher::transferFinished,
+                this, &BleConnectionManager::onTransferFinished);
+        connection = link.nus;
+    }
 
-        BleRobotConnection *connection = new BleRobotConnection(this);
+    attachLink(address, link, connection, publisher);
 
-        connect(connection, &BleRobotConnection::connectionStateChanged,
-                this, &BleConnectionManager::onConnectionStateChanged);
-        connect(connection, &BleRobotConnection::dataReceived,
-                this, &BleConnectionManager::onDataReceived);
-        connect(connection, &BleRobotConnection::errorOccurred,
-                this, &BleConnectionManager::onErrorOccurred);
+    if (link.falcons) {
+        FalconsRobotConnection *falcons = link.falcons;
+        BleWorker::post(falcons, [falcons, device, addressType]() { falcons->connectToDevice(device, addressType); });
+    } else if (link.jbd) {
+        JbdBmsConnection *jbd = link.jbd;
+        BleWorker::post(jbd, [jbd, device, addressType]() { jbd->connectToDevice(device, addressType); });
+    } else {
+        BleRobotConnection *nus = link.nus;
+        BleWorker::post(nus, [nus, device, addressType]() { nus->connectToDevice(device, addressType); });
+    }
+}
 
-        m_connections.append(connection);
-        connection->connectToDevice(device);
+void BleConnectionManager::attachLink(const QString &address, const Link &link, QObject *connection,
+                                      LinkPublisher *publisher)
+{
+    const int slot = m_fleetSnapshot->claim();
+    if (slot >= 0) {
+        publisher->setSnapshot(m_fleetSnapshot, slot, link.type);
+    } else {
+        qWarning() << "No fleet snapshot slot left for" << address;
+    }
+    const int index = findConnectionByAddress(address);
+    if (index >= 0) {
+        m_robotListModel->store()->setSnapshotSlot(m_robotListModel->handleAt(index), slot);
+        m_robotListModel->commit(index);
     }
+
+    m_worker->adopt(connection);
+    m_links.insert(address, link);
+    m_linkStateCounts[link.state]++;
+}
+
+void BleConnectionManager::setLinkState(Link &link, Robot::ConnectionState state)
+{
+    m_linkStateCounts[link.state]--;
+    m_linkStateCounts[state]++;
+    link.state = state;
 }
 
 void BleConnectionManager::disconnectRobot(int index)
@@ -119,45 +474,98 @@ void BleConnectionManager::disconnectRobot(int index)
 
     qDebug() << "Disconnecting robot at index:" << index;
 
-    Robot robot = m_robotListModel->robotAt(index);
-    QString address = robot.bluetoothAddress().toString();
+    const QString address = m_robotListModel->store()->address(m_robotListModel->handleAt(index)).toString();
+
+    releaseConnection(address);
+    m_autoConnectSuppressed.insert(address);
+    m_autoConnectAttemptMs.remove(address);
+    clearFleetWaiting(address);
 
-    // Check if it's a NUS connection
-    for (int i = 0; i < m_connections.size(); ++i) {
-        if (m_connections[i]->robotAddress() == address) {
-            BleRobotConnection *connection = m_connections[i];
-            connection->disconnect();
-            m_connections.removeAt(i);
-            connection->deleteLater();
+    m_telemetrySequence.remove(address);
+    m_pendingCommands.remove(address);
+
+    m_robotListModel->removeRobot(index);
+    updateConnectedCount();
+    emit robotDisconnected(index);
+}
+
+void BleConnectionManager::releaseConnection(const QString &address)
+{
+    for (int i = 0; i < m_connectQueue.size(); ++i) {
+        if (m_connectQueue[i].device.address().toString() == address) {
+            m_connectQueue.removeAt(i);
             break;
         }
     }
 
-    // Check if it's a JBD connection
-    for (int i = 0; i < m_jbdConnections.size(); ++i) {
-        if (m_jbdConnections[i]->deviceAddress() == address) {
-            JbdBmsConnection *connection = m_jbdConnections[i];
-            connection->disconnect();
-            m_jbdConnections.removeAt(i);
-            connection->deleteLater();
-            break;
+    if (releaseLink(address)) {
+        const int index = findConnectionByAddress(address);
+        if (index >= 0) {
+            FleetStore *store = m_robotListModel->store();
+            const FleetStore::Handle robot = m_robotListModel->handleAt(index);
+            store->setSnapshotSlot(robot, -1);
+            store->setStale(robot, false);
+            m_robotListModel->commit(index);
         }
     }
+}
 
-    // Check if it's a Falcons connection
-    for (int i = 0; i < m_falconsConnections.size(); ++i) {
-        if (m_falconsConnections[i]->robotAddress() == address) {
-            FalconsRobotConnection *connection = m_falconsConnections[i];
-            connection->disconnect();
-            m_falconsConnections.removeAt(i);
-            connection->deleteLater();
-            break;
-        }
+bool BleConnectionManager::releaseLink(const QString &address)
+{
+    const Link link = m_links.take(address);
+    if (link.falcons) {
+        FalconsRobotConnection *connection = link.falcons;
+        BleWorker::post(connection, [connection]() { connection->disconnect(); });
+    } else if (link.jbd) {
+        JbdBmsConnection *connection = link.jbd;
+        BleWorker::post(connection, [connection]() { connection->disconnect(); });
+    } else if (link.nus) {
+        BleRobotConnection *connection = link.nus;
+        BleWorker::post(connection, [connection]() { connection->disconnect(); });
+    } else if (link.simulated) {
+        SimulatedLink *connection = link.simulated;
+        BleWorker::post(connection, [connection]() { connection->stop(); });
     }
 
-    m_robotListModel->removeRobot(index);
-    updateConnectedCount();
-    emit robotDisconnected(index);
+    // Deleted on the worker, after the disconnect above; its publisher frees the snapshot slot
+    QObject *connection = link.connection();
+    if (!connection) {
+        return false;
+    }
+    m_linkStateCounts[link.state]--;
+    connection->deleteLater();
+    m_fleetCommand->linkStateChanged(address, Robot::Disconnected);
+    return true;
+}
+
+bool BleConnectionManager::retryOtherAddressType(const QString &address, const LinkDelta &delta)
+{
+    // Only a link that never got past Connecting can have failed on the address type;
+    // the other one gets a single try, and onDeviceReady remembers whichever worked
+    const Link link = m_links.value(address);
+    if ((delta.state != Robot::Error && delta.state != Robot::Disconnected)
+        || link.state != Robot::Connecting || link.addressTypeRetried || link.simulated) {
+        return false;
+    }
+
+    const QLowEnergyController::RemoteAddressType other =
+        link.addressType == QLowEnergyController::PublicAddress
+            ? QLowEnergyController::RandomAddress : QLowEnergyController::PublicAddress;
+    qDebug() << "Connecting" << address << "failed, retrying as a"
+             << (other == QLowEnergyController::PublicAddress ? "public" : "random") << "address";
+
+    releaseConnection(address);
+    openConnection(link.device, link.type, other);
+    m_links[address].addressTypeRetried = true;
+    return true;
+}
+
+QObject *BleConnectionManager::Link::connection() const
+{
+    if (falcons) return falcons;
+    if (jbd) return jbd;
+    if (simulated) return simulated;
+    return nus;
 }
 
 void BleConnectionManager::disconnectRobotByAddress(const QString &address)
@@ -170,11 +578,65 @@ void BleConnectionManager::disconnectRobotByAddress(const QString &address)
 
 void BleConnectionManager::disconnectAll()
 {
-    qDebug() << "Disconnecting all devices";
-    
-    while (m_robotListModel->count() > 0) {
-        disconnectRobot(0);
+    QList<int> indexes(m_robotListModel->count());
+    std::iota(indexes.begin(), indexes.end(), 0);
+    qDebug() << "Disconnecting all" << indexes.size() << "devices";
+
+    disconnectRobots(indexes);
+    m_simulated.clear();
+}
+
+void BleConnectionManager::disconnectRobots(QList<int> indexes)
+{
+    const qint64 startNs = MonotonicClock::nowNs();
+
+    // Highest first, the order robotDisconnected() reports them in
+    std::sort(indexes.begin(), indexes.end(), std::greater<int>());
+    indexes.erase(std::unique(indexes.begin(), indexes.end()), indexes.end());
+    indexes.removeIf([this](int index) { return index < 0 || index >= m_robotListModel->count(); });
+    if (indexes.isEmpty()) {
+        return;
     }
+
+    const FleetStore *store = m_robotListModel->store();
+    QSet<QString> addresses;
+    addresses.reserve(indexes.size());
+    for (int index : std::as_const(indexes)) {
+        addresses.insert(store->address(m_robotListModel->handleAt(index)).toString());
+    }
+
+    m_connectQueue.removeIf([&addresses](const QueuedConnection &queued) {
+        return addresses.contains(queued.device.address().toString());
+    });
+
+    // Every link is told at once: the worker runs the disconnects back to back without
+    // waiting for any of them to complete, so the radios tear down in parallel
+    bool waitingReduced = false;
+    for (const QString &address : std::as_const(addresses)) {
+        releaseLink(address);
+        m_autoConnectSuppressed.insert(address);
+        m_autoConnectAttemptMs.remove(address);
+        m_telemetrySequence.remove(address);
+        m_pendingCommands.remove(address);
+        waitingReduced |= m_fleetWaiting.remove(address);
+    }
+    if (waitingReduced) {
+        fleetWaitingReduced();
+    }
+
+    m_robotListModel->removeRobots(indexes);
+    updateConnectedCount();
+    for (int index : std::as_const(indexes)) {
+        emit robotDisconnected(index);
+    }
+
+    const int count = indexes.size();
+    qDebug() << "Disconnected" << count << "devices in"
+             << (MonotonicClock::nowNs() - startNs) / 1000000.0 << "ms";
+    m_worker->post([count, startNs]() {
+        qDebug() << "BLE worker ran the disconnects of" << count << "devices"
+                 << (MonotonicClock::nowNs() - startNs) / 1000000.0 << "ms after the request";
+    });
 }
 
 void BleConnectionManager::sendToRobot(int index, const QByteArray &data)
@@ -184,16 +646,12 @@ void BleConnectionManager::sendToRobot(int index, const QByteArray &data)
         return;
     }
 
-    // Find NUS connection for this robot by address
-    Robot robot = m_robotListModel->robotAt(index);
-    QString address = robot.bluetoothAddress().toString();
-    for (BleRobotConnection *connection : m_connections) {
-        if (connection->robotAddress() == address) {
-            connection->sendData(data);
-            return;
-        }
+    BleRobotConnection *connection = findNusConnection(index);
+    if (!connection) {
+        qWarning() << "No NUS connection found for robot at index:" << index << "(may be a BMS device)";
+        return;
     }
-    qWarning() << "No NUS connection found for robot at index:" << index << "(may be a BMS device)";
+    BleWorker::post(connection, [connection, data]() { connection->sendData(data); });
 }
 
 void BleConnectionManager::sendToRobot(int index, const QString &text)
@@ -205,8 +663,10 @@ void BleConnectionManager::sendToAll(const QByteArray &data)
 {
     qDebug() << "Broadcasting data to all robots:" << data.toHex();
     
-    for (BleRobotConnection *connection : m_connections) {
-        connection->sendData(data);
+    for (const Link &link : std::as_const(m_links)) {
+        if (BleRobotConnection *connection = link.nus) {
+            BleWorker::post(connection, [connection, data]() { connection->sendData(data); });
+        }
     }
 }
 
@@ -215,362 +675,572 @@ void BleConnectionManager::sendToAll(const QString &text)
     sendToAll(text.toUtf8());
 }
 
-void BleConnectionManager::onConnectionStateChanged()
+// ── Link Deltas ──
+
+void BleConnectionManager::drainLinkDeltas()
 {
-    BleRobotConnection *connection = qobject_cast<BleRobotConnection*>(sender());
-    if (!connection) {
-        return;
+    const QList<LinkDelta> deltas = m_linkDeltas->takeAll();
+    for (const LinkDelta &delta : deltas) {
+        applyLinkDelta(delta);
     }
+}
 
-    int index = findConnectionByAddress(connection->robotAddress());
-    if (index < 0) {
-        return;
-    }
+void BleConnectionManager::applyLinkDelta(const LinkDelta &delta)
+{
+    // Deltas published before a link was released are dropped here, and so are those of a
+    // connection still tearing down after a new link was opened on its address
+    const auto linkIt = m_links.find(delta.address);
+    if (linkIt == m_links.end() || linkIt->id != delta.linkId) return;
+    const int index = findConnectionByAddress(delta.address);
+    if (index < 0) return;
 
-    Robot robot = m_robotListModel->robotAt(index);
-    robot.setConnectionState(connection->connectionState());
-    robot.setRssi(connection->rssi());
-    robot.setName(connection->robotName());
-    m_robotListModel->updateRobot(index, robot);
+    const QString &address = delta.address;
+    if (delta.has(LinkDelta::State) && retryOtherAddressType(address, delta)) return;
 
-    updateConnectedCount();
+    const Robot::DeviceType type = linkIt->type;
+    if (delta.has(LinkDelta::State)) {
+        setLinkState(*linkIt, delta.state);
+        linkIt->name = delta.name;
+    }
 
-    if (connection->connectionState() == Robot::Ready) {
-        emit robotConnected(index);
+    // Latency stages carry the worker's stamps, so they are marked before the model update
+    if (delta.has(LinkDelta::PlayStateWritten)) {
+        m_commandLatency->mark(address, CommandLatencyTracker::Write, delta.writtenNs);
+    }
+    if (delta.has(LinkDelta::PlayStateAcked)) {
+        m_commandLatency->mark(address, CommandLatencyTracker::Ack, delta.playStateAckNs);
+    }
+    if (delta.has(LinkDelta::PlayStateNotified)) {
+        m_commandLatency->mark(address, CommandLatencyTracker::Notify, delta.notifiedNs);
     }
 
-    // Resume scanning once connection has settled
-    if (connection->connectionState() == Robot::Ready ||
-        connection->connectionState() == Robot::Error ||
-        connection->connectionState() == Robot::Disconnected) {
-        if (m_scanner && !m_scanner->isScanning()) {
-            m_scanner->startScan();
+    // Written in place; commit() publishes the fields that changed as one dataChanged
+    FleetStore *store = m_robotListModel->store();
+    const FleetStore::Handle robot = m_robotListModel->handleAt(index);
+    const qint64 newlyLost = delta.has(LinkDelta::Statistics)
+        ? delta.statistics.lost - store->linkStatistics(robot).lost : 0;
+
+    if (delta.has(LinkDelta::State)) {
+        store->setConnectionState(robot, delta.state);
+        store->setName(robot, delta.name);
+        if (type == Robot::FalconsRobot) {
+            store->setDeviceType(robot, Robot::FalconsRobot);
         }
     }
-}
-
-void BleConnectionManager::onDataReceived(const QByteArray &data)
-{
-    BleRobotConnection *connection = qobject_cast<BleRobotConnection*>(sender());
-    if (!connection) {
-        return;
+    if (delta.has(LinkDelta::Rssi)) {
+        store->setRssi(robot, delta.rssi);
+        store->setLinkQuality(robot, delta.linkQuality);
+        store->setRssiHistory(robot, delta.rssiHistory);
     }
-
-    int index = findConnectionByAddress(connection->robotAddress());
-    if (index < 0) {
-        return;
+    if (delta.has(LinkDelta::Statistics)) {
+        store->setLinkStatistics(robot, delta.statistics);
+    }
+    if (delta.has(LinkDelta::Stale)) {
+        store->setStale(robot, delta.stale);
+    }
+    if (delta.has(LinkDelta::RobotData)) {
+        store->setPlayState(robot, delta.playState);
+        store->setWifiSsid(robot, delta.wifiSsid);
+        store->setWifiList(robot, delta.wifiList);
+        store->setBatteryVoltage(robot, delta.batteryVoltage);
+        store->setRobotIdentity(robot, delta.robotIdentity);
+        store->setName(robot, delta.name);
+        store->setLastPacketTime(robot, delta.receivedNs);
+    }
+    if (delta.has(LinkDelta::BmsData)) {
+        store->setTotalVoltage(robot, delta.totalVoltage);
+        store->setCurrent(robot, delta.current);
+        store->setSoc(robot, delta.soc);
+        store->setCellVoltages(robot, delta.cellVoltages);
+        store->setLastPacketTime(robot, delta.receivedNs);
+    }
+    if (delta.has(LinkDelta::Packet)) {
+        store->setLastPacket(robot, delta.packet);
+        store->setLastPacketTime(robot, delta.receivedNs);
+    }
+    m_robotListModel->commit(index);
+    if (delta.fields & (LinkDelta::RobotData | LinkDelta::BmsData | LinkDelta::Packet)) {
+        m_deltaLatency.record((MonotonicClock::nowNs() - delta.receivedNs) / 1000);
     }
 
-    qDebug() << "Data received from robot" << index << ":" << data.toHex();
-
-    Robot robot = m_robotListModel->robotAt(index);
-    robot.setLastPacketReceived(data);
-    robot.setLastPacketTime(QDateTime::currentDateTime());
-    m_robotListModel->updateRobot(index, robot);
-}
+    if (delta.has(LinkDelta::RobotData)) {
+        // Identity is read after Ready; keep the registry entry current
+        KnownDevice known = m_knownDevices->device(store->address(robot));
+        if (known.isValid() && !delta.robotIdentity.isEmpty() && known.identity != delta.robotIdentity) {
+            known.identity = delta.robotIdentity;
+            m_knownDevices->remember(known);
+        }
 
-void BleConnectionManager::onErrorOccurred(const QString &error)
-{
-    BleRobotConnection *connection = qobject_cast<BleRobotConnection*>(sender());
-    if (!connection) {
-        return;
+        if (!m_commandLatency->isWaitingFor(address, CommandLatencyTracker::Notify)) {
+            m_commandLatency->mark(address, CommandLatencyTracker::ModelUpdate);
+        }
     }
 
-    int index = findConnectionByAddress(connection->robotAddress());
-    if (index < 0) {
-        return;
+    // A state the robot already has is never notified; as in FleetCommandFanout::checkConfirmed,
+    // the write response then confirms the command on its own
+    if (delta.has(LinkDelta::PlayStateAcked) && !delta.playStateAckValue.isEmpty()
+        && quint8(delta.playStateAckValue.at(0)) == store->playState(robot)
+        && m_commandLatency->isWaitingFor(address, CommandLatencyTracker::Notify)) {
+        m_commandLatency->mark(address, CommandLatencyTracker::Notify, delta.playStateAckNs);
+        m_commandLatency->mark(address, CommandLatencyTracker::ModelUpdate);
     }
 
-    qWarning() << "Robot" << index << "error:" << error;
-    emit robotError(index, error);
-}
+    // Notifications going missing: give the link more airtime
+    if (newlyLost > 0 && m_scanner) {
+        m_scanner->scheduler()->reportCongestion();
+    }
 
-void BleConnectionManager::onJbdConnectionStateChanged()
-{
-    JbdBmsConnection *connection = qobject_cast<JbdBmsConnection*>(sender());
-    if (!connection) {
-        return;
+    // Fleet command progress
+    if (delta.has(LinkDelta::PlayStateAcked)) {
+        m_fleetCommand->writeAcknowledged(address, FalconsRobotConnection::CHAR_PLAY_STATE_UUID,
+                                          delta.playStateAckValue);
+    }
+    if (delta.has(LinkDelta::WifiSsidAcked)) {
+        m_fleetCommand->writeAcknowledged(address, FalconsRobotConnection::CHAR_WIFI_SSID_UUID,
+                                          delta.wifiSsidAckValue);
+    }
+    if (delta.has(LinkDelta::PlayStateNotified)) {
+        m_fleetCommand->playStateNotified(address, delta.playState);
+    }
+    if (delta.has(LinkDelta::WifiSsidNotified)) {
+        m_fleetCommand->wifiSsidNotified(address, delta.wifiSsid);
     }
 
-    int index = findConnectionByAddress(connection->deviceAddress());
-    if (index < 0) {
-        return;
+    if (delta.has(LinkDelta::State)) {
+        m_fleetCommand->linkStateChanged(address, delta.state);
+        updateConnectedCount();
     }
 
-    Robot robot = m_robotListModel->robotAt(index);
-    robot.setConnectionState(connection->connectionState());
-    robot.setRssi(connection->rssi());
-    robot.setName(connection->deviceName());
-    m_robotListModel->updateRobot(index, robot);
+    // Signals below may re-enter (QML disconnecting a robot); nothing cached above is used after them
+    if (delta.has(LinkDelta::Error)) {
+        qWarning() << "Device" << index << "error:" << delta.error;
+        emit robotError(index, delta.error);
+    }
 
-    updateConnectedCount();
+    if (!delta.has(LinkDelta::State)) return;
 
-    if (connection->connectionState() == Robot::Ready) {
-        emit robotConnected(index);
+    if (delta.state == Robot::Ready) {
+        const int readyIndex = findConnectionByAddress(address);
+        if (readyIndex >= 0) {
+            onDeviceReady(readyIndex);
+        }
     }
 
-    // Resume scanning once connection has settled
-    if (connection->connectionState() == Robot::Ready ||
-        connection->connectionState() == Robot::Error ||
-        connection->connectionState() == Robot::Disconnected) {
-        if (m_scanner && !m_scanner->isScanning()) {
-            m_scanner->startScan();
+    // Deliver the command that promoted a watched robot
+    if (m_pendingCommands.contains(address)) {
+        FalconsRobotConnection *connection = findFalconsConnection(address);
+        if (delta.state == Robot::Ready && connection) {
+            m_pendingCommands.take(address)(connection);
+        } else if (delta.state == Robot::Error || delta.state == Robot::Disconnected) {
+            qWarning() << "Promotion of" << address << "failed, command dropped";
+            m_pendingCommands.remove(address);
         }
     }
 }
 
-void BleConnectionManager::onJbdBmsDataUpdated()
+int BleConnectionManager::findConnectionByAddress(const QString &address)
 {
-    JbdBmsConnection *connection = qobject_cast<JbdBmsConnection*>(sender());
-    if (!connection) {
-        return;
-    }
+    // The robot model covers every link type and watched robots
+    return m_robotListModel->indexOf(QBluetoothAddress(address));
+}
 
-    int index = findConnectionByAddress(connection->deviceAddress());
-    if (index < 0) {
-        return;
+FalconsRobotConnection *BleConnectionManager::findFalconsConnection(const QString &address) const
+{
+    return m_links.value(address).falcons;
+}
+
+void BleConnectionManager::updateConnectedCount()
+{
+    const int count = m_linkStateCounts[Robot::Ready] + m_linkStateCounts[Robot::Connected];
+    if (m_connectedCount != count) {
+        m_connectedCount = count;
+        emit connectedCountChanged();
     }
 
-    Robot robot = m_robotListModel->robotAt(index);
-    robot.setTotalVoltage(connection->totalVoltage());
-    robot.setCurrent(connection->current());
-    robot.setSoc(connection->soc());
-    robot.setCellVoltages(connection->cellVoltages());
-    robot.setLastPacketTime(QDateTime::currentDateTime());
-    m_robotListModel->updateRobot(index, robot);
+    drainConnectQueue();
+    updateScanSchedule();
 }
 
-void BleConnectionManager::onJbdErrorOccurred(const QString &error)
+qint64 BleConnectionManager::sinceLaunchMs() const
 {
-    JbdBmsConnection *connection = qobject_cast<JbdBmsConnection*>(sender());
-    if (!connection) {
+    return (MonotonicClock::nowNs() - m_launchNs) / 1000000;
+}
+
+void BleConnectionManager::countLinks(int &pending, int &active) const
+{
+    // Connecting/Connected links are still in setup; Ready links carry traffic
+    pending = m_linkStateCounts[Robot::Connecting] + m_linkStateCounts[Robot::Connected];
+    active = m_linkStateCounts[Robot::Ready];
+}
+
+void BleConnectionManager::updateScanSchedule()
+{
+    if (!m_scanner) return;
+
+    // Only GATT setup contends with scanning; queued and still-connecting links
+    // may wait out a whole connect timeout and must not hold discovery off
+    ScanScheduler *scheduler = m_scanner->scheduler();
+    scheduler->setPendingSetups(m_linkStateCounts[Robot::Connected]);
+    scheduler->setActiveLinks(m_linkStateCounts[Robot::Ready]);
+}
+
+// ── Play State / WiFi Control ──
+
+void BleConnectionManager::postPlayState(FalconsRobotConnection *connection, int state)
+{
+    // Stopping a robot (INVALID) must not wait behind polls or setup traffic
+    const GattOperationQueue::Priority priority = state == 0 ? GattOperationQueue::Emergency
+                                                             : GattOperationQueue::Control;
+    BleWorker::post(connection, [connection, state, priority]() {
+        connection->writePlayState(state, priority);
+    });
+}
+
+void BleConnectionManager::writePlayState(int index, int state)
+{
+    if (index < 0 || index >= m_robotListModel->count()) {
+        qWarning() << "Invalid robot index:" << index;
         return;
     }
 
-    int index = findConnectionByAddress(connection->deviceAddress());
-    if (index < 0) {
+    const QString address = m_robotListModel->store()->address(m_robotListModel->handleAt(index)).toString();
+    m_commandLatency->begin(address);
+
+    // A robot still being promoted gets its queued command replaced instead
+    FalconsRobotConnection *connection = findFalconsConnection(address);
+    if (connection && !m_pendingCommands.contains(address)) {
+        m_commandLatency->mark(address, CommandLatencyTracker::Dispatch);
+        postPlayState(connection, state);
         return;
     }
 
-    qWarning() << "BMS" << index << "error:" << error;
-    emit robotError(index, error);
+    const bool promoted = promoteWatchedRobot(index, [this, address, state](FalconsRobotConnection *connection) {
+        m_commandLatency->mark(address, CommandLatencyTracker::Dispatch);
+        postPlayState(connection, state);
+    });
+    if (!promoted) {
+        qWarning() << "No Falcons connection found for robot at index:" << index;
+    }
 }
 
-int BleConnectionManager::findConnectionIndex(BleRobotConnection *connection)
+void BleConnectionManager::writePlayStateAll(int state)
 {
-    for (int i = 0; i < m_connections.size(); ++i) {
-        if (m_connections[i] == connection) {
-            return i;
-        }
+    qDebug() << "Broadcasting play state to all Falcons robots:" << state;
+
+    const QList<FleetTarget> targets = readyFalconsTargets();
+    for (const FleetTarget &target : targets) {
+        m_commandLatency->begin(target.address);
     }
-    return -1;
-}
+    for (const FleetTarget &target : targets) {
+        m_commandLatency->mark(target.address, CommandLatencyTracker::Dispatch);
+    }
+    m_fleetCommand->startPlayState(targets, state);
 
-int BleConnectionManager::findConnectionByAddress(const QString &address)
-{
-    // Search in the robot model (covers both NUS and JBD connections)
+    // Watched robots are not part of the fan-out; each gets connected and sent the state
+    const FleetStore *store = m_robotListModel->store();
     for (int i = 0; i < m_robotListModel->count(); ++i) {
-        if (m_robotListModel->robotAt(i).bluetoothAddress().toString() == address) {
-            return i;
+        const FleetStore::Handle robot = m_robotListModel->handleAt(i);
+        if (store->connectionState(robot) == Robot::Watching && store->deviceType(robot) == Robot::FalconsRobot) {
+            writePlayState(i, state);
         }
     }
-    return -1;
 }
 
-void BleConnectionManager::updateConnectedCount()
+void BleConnectionManager::onFleetWriteRequested(const QString &address)
 {
-    int count = 0;
-    for (BleRobotConnection *connection : m_connections) {
-        if (connection->connectionState() == Robot::Ready || 
-            connection->connectionState() == Robot::Connected) {
-            count++;
-        }
-    }
-    for (JbdBmsConnection *connection : m_jbdConnections) {
-        if (connection->connectionState() == Robot::Ready ||
-            connection->connectionState() == Robot::Connected) {
-            count++;
-        }
-    }
-    for (FalconsRobotConnection *connection : m_falconsConnections) {
-        if (connection->connectionState() == Robot::Ready ||
-            connection->connectionState() == Robot::Connected) {
-            count++;
-        }
-    }
+    FalconsRobotConnection *connection = findFalconsConnection(address);
+    if (!connection) return;
 
-    if (m_connectedCount != count) {
-        m_connectedCount = count;
-        emit connectedCountChanged();
+    if (m_fleetCommand->command() == FleetCommandFanout::PlayState) {
+        // Fleet-wide play state always goes out on the emergency lane
+        const int state = m_fleetCommand->playState();
+        BleWorker::post(connection, [connection, state]() {
+            connection->writePlayState(state, GattOperationQueue::Emergency);
+        });
+    } else if (m_fleetCommand->command() == FleetCommandFanout::WifiSsid) {
+        const QString ssid = m_fleetCommand->ssid();
+        BleWorker::post(connection, [connection, ssid]() { connection->writeWifiSsid(ssid); });
     }
 }
 
-void BleConnectionManager::updateRobotModel(int index)
+void BleConnectionManager::onFleetBoostRequested(const QString &address)
 {
-    if (index < 0 || index >= m_robotListModel->count()) {
-        return;
+    FalconsRobotConnection *connection = findFalconsConnection(address);
+    if (connection) {
+        BleWorker::post(connection, [connection]() { connection->boostConnection(); });
     }
+}
 
-    // This is only used for NUS connections now
-    Robot robot = m_robotListModel->robotAt(index);
-    QString address = robot.bluetoothAddress().toString();
+// ── Command Latency Instrumentation ──
 
-    for (BleRobotConnection *connection : m_connections) {
-        if (connection->robotAddress() == address) {
-            robot.setConnectionState(connection->connectionState());
-            robot.setRssi(connection->rssi());
-            robot.setName(connection->robotName());
-            m_robotListModel->updateRobot(index, robot);
-            return;
-        }
-    }
+QString BleConnectionManager::commandLatencyReport() const
+{
+    return m_commandLatency->report();
 }
 
-void BleConnectionManager::updateJbdRobotModel(int index)
+QString BleConnectionManager::exportCommandLatency(const QString &path)
 {
-    // Not needed — handled directly in onJbdConnectionStateChanged / onJbdBmsDataUpdated
+    QString target = path;
+    if (target.isEmpty()) {
+        const QString dir = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
+        QDir().mkpath(dir);
+        target = dir + QStringLiteral("/command-latency-%1.csv")
+                           .arg(QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss"));
+    }
+    return m_commandLatency->exportCsv(target) ? target : QString();
 }
 
-int BleConnectionManager::findJbdConnectionIndex(JbdBmsConnection *connection)
+void BleConnectionManager::resetCommandLatency()
 {
-    for (int i = 0; i < m_jbdConnections.size(); ++i) {
-        if (m_jbdConnections[i] == connection) {
-            return i;
-        }
-    }
-    return -1;
+    m_commandLatency->reset();
 }
 
-int BleConnectionManager::findFalconsConnectionIndex(FalconsRobotConnection *connection)
+// ── Link Quality ──
+
+QString BleConnectionManager::linkStatisticsReport() const
 {
-    for (int i = 0; i < m_falconsConnections.size(); ++i) {
-        if (m_falconsConnections[i] == connection) {
-            return i;
+    // Summaries are read on the worker, all of them in one blocking call
+    const QList<Link> links = m_links.values();
+    return m_worker->call<QString>([links]() {
+        QStringList lines;
+        for (const Link &link : links) {
+            if (link.falcons) {
+                lines.append(link.name + ": " + link.falcons->linkStatisticsSummary());
+            } else if (link.nus) {
+                lines.append(link.name + ": " + link.nus->linkStatisticsSummary());
+            }
         }
-    }
-    return -1;
+        return lines.join('\n');
+    });
 }
 
-// ── Falcons Robot Connection Handlers ──
+// ── Connection Parameters ──
 
-void BleConnectionManager::onFalconsConnectionStateChanged()
+QString BleConnectionManager::connectionParametersReport() const
 {
-    FalconsRobotConnection *connection = qobject_cast<FalconsRobotConnection*>(sender());
-    if (!connection) return;
+    const QList<Link> links = m_links.values();
+    return m_worker->call<QString>([links]() {
+        QStringList lines;
+        for (const Link &link : links) {
+            QString summary;
+            if (link.falcons) {
+                summary = link.falcons->connectionParametersSummary();
+            } else if (link.jbd) {
+                summary = link.jbd->connectionParametersSummary();
+            } else if (link.nus) {
+                summary = link.nus->connectionParametersSummary();
+            }
+            lines.append(link.name + ": " + summary);
+        }
+        return lines.join('\n');
+    });
+}
 
-    int index = findConnectionByAddress(connection->robotAddress());
-    if (index < 0) return;
+QList<FleetTarget> BleConnectionManager::readyFalconsTargets() const
+{
+    QList<FleetTarget> ready;
+    const FleetStore *store = m_robotListModel->store();
+    for (int i = 0; i < m_robotListModel->count(); ++i) {
+        const FleetStore::Handle robot = m_robotListModel->handleAt(i);
+        const QString address = store->address(robot).toString();
+        const Link link = m_links.value(address);
+        if (!link.falcons || link.state != Robot::Ready) continue;
+
+        FleetTarget target;
+        target.address = address;
+        target.name = store->name(robot);
+        target.playState = store->playState(robot);
+        target.wifiSsid = store->wifiSsid(robot);
+        ready.append(target);
+    }
+    return ready;
+}
 
-    Robot robot = m_robotListModel->robotAt(index);
-    robot.setConnectionState(connection->connectionState());
-    robot.setRssi(connection->rssi());
-    robot.setName(connection->robotName());
-    robot.setDeviceType(Robot::FalconsRobot);
-    m_robotListModel->updateRobot(index, robot);
+void BleConnectionManager::writeWifiSsid(int index, const QString &ssid)
+{
+    if (index < 0 || index >= m_robotListModel->count()) {
+        qWarning() << "Invalid robot index:" << index;
+        return;
+    }
 
-    updateConnectedCount();
+    const QString address = m_robotListModel->store()->address(m_robotListModel->handleAt(index)).toString();
 
-    if (connection->connectionState() == Robot::Ready) {
-        emit robotConnected(index);
+    FalconsRobotConnection *connection = findFalconsConnection(address);
+    if (connection && !m_pendingCommands.contains(address)) {
+        BleWorker::post(connection, [connection, ssid]() { connection->writeWifiSsid(ssid); });
+        return;
     }
 
-    // Resume scanning once connection has settled
-    if (connection->connectionState() == Robot::Ready ||
-        connection->connectionState() == Robot::Error ||
-        connection->connectionState() == Robot::Disconnected) {
-        if (m_scanner && !m_scanner->isScanning()) {
-            m_scanner->startScan();
-        }
+    const bool promoted = promoteWatchedRobot(index, [ssid](FalconsRobotConnection *connection) {
+        BleWorker::post(connection, [connection, ssid]() { connection->writeWifiSsid(ssid); });
+    });
+    if (!promoted) {
+        qWarning() << "No Falcons connection found for robot at index:" << index;
     }
 }
 
-void BleConnectionManager::onFalconsRobotDataUpdated()
+void BleConnectionManager::writeWifiSsidAll(const QString &ssid)
 {
-    FalconsRobotConnection *connection = qobject_cast<FalconsRobotConnection*>(sender());
-    if (!connection) return;
+    qDebug() << "Broadcasting WiFi SSID to all Falcons robots:" << ssid;
+    m_fleetCommand->startWifiSsid(readyFalconsTargets(), ssid, WIFI_SWITCH_DEADLINE_MS);
+}
 
-    int index = findConnectionByAddress(connection->robotAddress());
-    if (index < 0) return;
+// ── Request/Response RPC (NUS robots) ──
+
+BleRobotConnection *BleConnectionManager::findNusConnection(int index, bool requireReady) const
+{
+    if (index < 0 || index >= m_robotListModel->count()) {
+        return nullptr;
+    }
 
-    Robot robot = m_robotListModel->robotAt(index);
-    robot.setPlayState(connection->playState());
-    robot.setWifiSsid(connection->wifiSsid());
-    robot.setWifiList(connection->wifiList());
-    robot.setBatteryVoltage(connection->batteryVoltage());
-    robot.setRobotIdentity(connection->robotIdentity());
-    robot.setName(connection->robotName());
-    robot.setLastPacketTime(QDateTime::currentDateTime());
-    m_robotListModel->updateRobot(index, robot);
+    const QString address = m_robotListModel->store()->address(m_robotListModel->handleAt(index)).toString();
+    const Link link = m_links.value(address);
+    if (requireReady && link.state != Robot::Ready) {
+        return nullptr;
+    }
+    return link.nus;
 }
 
-void BleConnectionManager::onFalconsErrorOccurred(const QString &error)
+int BleConnectionManager::callRobot(int index, int method, const QByteArray &payload, int timeoutMs)
 {
-    FalconsRobotConnection *connection = qobject_cast<FalconsRobotConnection*>(sender());
-    if (!connection) return;
-
-    int index = findConnectionByAddress(connection->robotAddress());
-    if (index < 0) return;
+    BleRobotConnection *connection = findNusConnection(index, true);
+    if (!connection) {
+        qWarning() << "No ready NUS connection for RPC at index:" << index;
+        return -1;
+    }
 
-    qWarning() << "Falcons Robot" << index << "error:" << error;
-    emit robotError(index, error);
+    // Waits only for the request to be queued, not for the response
+    return BleWorker::call<int>(connection, [connection, method, payload, timeoutMs]() {
+        return int(connection->rpcClient()->call(static_cast<uint8_t>(method), payload,
+                                                 RpcClient::Callback(), timeoutMs));
+    });
 }
 
-// ── Play State / WiFi Control ──
+bool BleConnectionManager::cancelRobotCall(int index, int callId)
+{
+    BleRobotConnection *connection = findNusConnection(index);
+    if (!connection || callId <= 0 || callId > 0xFFFF) {
+        return false;
+    }
+    return BleWorker::call<bool>(connection, [connection, callId]() {
+        return connection->rpcClient()->cancel(static_cast<quint16>(callId));
+    });
+}
 
-void BleConnectionManager::writePlayState(int index, int state)
+QString BleConnectionManager::rpcLatencyReport(int index) const
 {
-    if (index < 0 || index >= m_robotListModel->count()) {
-        qWarning() << "Invalid robot index:" << index;
-        return;
+    BleRobotConnection *connection = findNusConnection(index);
+    if (!connection) {
+        return QString();
     }
+    return BleWorker::call<QString>(connection, [connection]() {
+        return connection->rpcClient()->latencyReport();
+    });
+}
 
-    Robot robot = m_robotListModel->robotAt(index);
-    QString address = robot.bluetoothAddress().toString();
+void BleConnectionManager::onRpcCallFinished(const QString &address, quint16 callId, int method, int status,
+                                             const QByteArray &payload, qint64 latencyUs)
+{
+    qDebug() << "RPC" << RpcClient::methodName(static_cast<uint8_t>(method)) << "to"
+             << address << "finished:"
+             << RpcClient::statusToString(static_cast<RpcClient::CallStatus>(status))
+             << "in" << latencyUs << "us";
 
-    for (FalconsRobotConnection *connection : m_falconsConnections) {
-        if (connection->robotAddress() == address) {
-            connection->writePlayState(state);
-            return;
-        }
+    emit rpcFinished(address, callId,
+                     RpcClient::statusToString(static_cast<RpcClient::CallStatus>(status)), payload);
+}
+
+// ── Bulk Transfer (NUS robots) ──
+
+bool BleConnectionManager::downloadFromRobot(int index, const QString &remoteName, const QString &localPath)
+{
+    BleRobotConnection *connection = findNusConnection(index, true);
+    if (!connection) {
+        qWarning() << "No ready NUS connection for download at index:" << index;
+        return false;
     }
-    qWarning() << "No Falcons connection found for robot at index:" << index;
+    return BleWorker::call<bool>(connection, [connection, remoteName, localPath]() {
+        return connection->bulkTransfer()->startDownload(remoteName, localPath);
+    });
 }
 
-void BleConnectionManager::writePlayStateAll(int state)
+bool BleConnectionManager::uploadToRobot(int index, const QString &localPath, const QString &remoteName)
 {
-    qDebug() << "Broadcasting play state to all Falcons robots:" << state;
-    for (FalconsRobotConnection *connection : m_falconsConnections) {
-        if (connection->connectionState() == Robot::Ready) {
-            connection->writePlayState(state);
-        }
+    BleRobotConnection *connection = findNusConnection(index, true);
+    if (!connection) {
+        qWarning() << "No ready NUS connection for upload at index:" << index;
+        return false;
     }
+    return BleWorker::call<bool>(connection, [connection, localPath, remoteName]() {
+        return connection->bulkTransfer()->startUpload(localPath, remoteName);
+    });
 }
 
-void BleConnectionManager::writeWifiSsid(int index, const QString &ssid)
+void BleConnectionManager::abortTransfer(int index)
 {
-    if (index < 0 || index >= m_robotListModel->count()) {
-        qWarning() << "Invalid robot index:" << index;
-        return;
+    BleRobotConnection *connection = findNusConnection(index);
+    if (connection) {
+        BleWorker::post(connection, [connection]() { connection->bulkTransfer()->abort(); });
     }
+}
 
-    Robot robot = m_robotListModel->robotAt(index);
-    QString address = robot.bluetoothAddress().toString();
+void BleConnectionManager::onTransferFinished(const QString &address, bool success, const QString &error,
+                                              qint64 bytes, double bytesPerSecond, int mtu)
+{
+    qDebug() << "Transfer with" << address << (success ? "completed" : "failed")
+             << "-" << bytes << "bytes at" << qRound(bytesPerSecond) << "B/s, MTU" << mtu;
 
-    for (FalconsRobotConnection *connection : m_falconsConnections) {
-        if (connection->robotAddress() == address) {
-            connection->writeWifiSsid(ssid);
-            return;
-        }
-    }
-    qWarning() << "No Falcons connection found for robot at index:" << index;
+    emit transferFinished(address, success, error, bytesPerSecond);
 }
 
-void BleConnectionManager::writeWifiSsidAll(const QString &ssid)
+// ── Simulated Fleet ──
+
+void BleConnectionManager::simulateFleet(int count)
 {
-    qDebug() << "Broadcasting WiFi SSID to all Falcons robots:" << ssid;
-    for (FalconsRobotConnection *connection : m_falconsConnections) {
-        if (connection->connectionState() == Robot::Ready) {
-            connection->writeWifiSsid(ssid);
+    QList<int> previous;
+    for (const QString &address : std::exchange(m_simulated, {})) {
+        const int index = findConnectionByAddress(address);
+        if (index >= 0) {
+            previous.append(index);
         }
     }
+    disconnectRobots(previous);
+
+    count = std::min(count, m_maxDevices - connectionCount());
+    if (count <= 0) {
+        return;
+    }
+    qDebug() << "Simulating" << count << "devices";
+
+    QList<Robot> robots;
+    robots.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        // Locally administered addresses, outside any vendor range
+        const QBluetoothAddress address(Q_UINT64_C(0x02F5C0000000) + quint64(i + 1));
+        const Robot::DeviceType type = i % 2 == 0 ? Robot::FalconsRobot : Robot::SmartBMS;
+        const QString name = (type == Robot::FalconsRobot ? QStringLiteral("Sim robot %1")
+                                                          : QStringLiteral("Sim BMS %1")).arg(i / 2 + 1);
+
+        Robot robot(m_nextRobotId++, name, address);
+        robot.setConnectionState(Robot::Connecting);
+        robot.setDeviceType(type);
+        robots.append(robot);
+    }
+    m_robotListModel->addRobots(robots);
+
+    for (const Robot &robot : std::as_const(robots)) {
+        const QString address = robot.bluetoothAddress().toString();
+        Link link;
+        link.id = m_nextLinkId++;
+        link.type = robot.deviceType();
+        link.name = robot.name();
+        link.simulated = new SimulatedLink(link.type, link.name, m_worker->timers());
+        LinkPublisher *publisher = LinkPublisher::attach(link.simulated, address, link.id, m_linkDeltas);
+        attachLink(address, link, link.simulated, publisher);
+        m_simulated.append(address);
+
+        SimulatedLink *simulated = link.simulated;
+        BleWorker::post(simulated, [simulated]() { simulated->start(); });
+    }
+    updateConnectedCount();
 }
@@ -5,33 +5,122 @@
 #include <QList>
 #include <QMap>
 #include <QBluetoothDeviceInfo>
+#include <QHash>
+#include <QSet>
+#include <QSharedPointer>
+#include <array>
+#include <functional>
 #include "BleRobotConnection.h"
 #include "JbdBmsConnection.h"
 #include "FalconsRobotConnection.h"
+#include "FleetCommandFanout.h"
+#include "CommandLatencyTracker.h"
+#include "KnownDeviceRegistry.h"
+#include "LinkDelta.h"
+#include "SimulatedLink.h"
 #include "src/models/RobotListModel.h"
 #include "src/models/Robot.h"
+#include "src/models/FleetSnapshot.h"
+#include "src/protocol/AdvertisementTelemetry.h"
+#include "src/protocol/LatencyHistogram.h"
 
 class BleDeviceScanner;
+class BleWorker;
+class LinkPublisher;
 
+/**
+ * BleConnectionManager - owns the robot list and every link to a device.
+ *
+ * Connections run on the BLE worker thread. The manager (GUI thread) starts
+ * and stops them and posts commands to them; their state comes back as
+ * LinkDelta batches that are folded into the robot model once per drain.
+ *
+ * Up to maxDevices() links (robots and BMS packs count separately) are
+ * kept. Lookups by address and link counts are hashed or maintained as
+ * links change, so handling an event does not scan the fleet.
+ */
 class BleConnectionManager : public QObject
 {
     Q_OBJECT
     Q_PROPERTY(RobotListModel* robotListModel READ robotListModel CONSTANT)
+    Q_PROPERTY(FleetAggregates* fleetAggregates READ fleetAggregates CONSTANT)
     Q_PROPERTY(int connectedCount READ connectedCount NOTIFY connectedCountChanged)
+    Q_PROPERTY(int maxDevices READ maxDevices NOTIFY maxDevicesChanged)
+    Q_PROPERTY(FleetCommandFanout* fleetCommand READ fleetCommand CONSTANT)
+    Q_PROPERTY(KnownDeviceRegistry* knownDevices READ knownDevices CONSTANT)
+    Q_PROPERTY(int fleetExpected READ fleetExpected NOTIFY fleetReadyChanged)
+    Q_PROPERTY(int fleetWaiting READ fleetWaiting NOTIFY fleetReadyChanged)
+    Q_PROPERTY(qint64 fleetReadyMs READ fleetReadyMs NOTIFY fleetReadyChanged)
 
 public:
-    static const int MAX_ROBOTS = 16;
+    static constexpr int DEFAULT_MAX_DEVICES = 48;      // a squad with its packs, plus spares
+    static constexpr int WIFI_SWITCH_DEADLINE_MS = 5000;
+    static constexpr int MAX_CONCURRENT_SETUPS = 4;
+    static constexpr int AUTO_CONNECT_RETRY_MS = 10000;
 
-    explicit BleConnectionManager(QObject *parent = nullptr);
+    explicit BleConnectionManager(BleWorker *worker, QObject *parent = nullptr);
     ~BleConnectionManager();
 
-    void setScanner(BleDeviceScanner *scanner) { m_scanner = scanner; }
+    void setScanner(BleDeviceScanner *scanner);
 
     RobotListModel* robotListModel() { return m_robotListModel; }
+    FleetAggregates* fleetAggregates() { return m_robotListModel->aggregates(); }
     int connectedCount() const { return m_connectedCount; }
 
+    /**
+     * Most links open or queued at once; the "connections/maxDevices"
+     * setting, capped by FleetSnapshot::MAX_SLOTS. setMaxDevices() changes
+     * it for this session only (--max-devices).
+     */
+    int maxDevices() const { return m_maxDevices; }
+    void setMaxDevices(int count);
+
+    /** Publish-to-model latency of every applied delta that carried data (µs) */
+    const LatencyHistogram &deltaLatency() const { return m_deltaLatency; }
+    void resetDeltaLatency() { m_deltaLatency.reset(); }
+    qint64 droppedDeltaCount() const { return m_linkDeltas->droppedCount(); }
+
+    /** Progress and per-robot results of the last fleet-wide command */
+    FleetCommandFanout* fleetCommand() { return m_fleetCommand; }
+
+    /** Robots and BMS packs that reached Ready before */
+    KnownDeviceRegistry* knownDevices() { return m_knownDevices; }
+
+    /** Known devices connected at launch, how many are not Ready yet, and launch-to-Ready time (-1 until all are) */
+    int fleetExpected() const { return m_fleetExpected; }
+    int fleetWaiting() const { return m_fleetWaiting.size(); }
+    qint64 fleetReadyMs() const { return m_fleetReadyMs; }
+
+    /**
+     * Latest high-rate values of every link, written on the BLE worker and
+     * readable lock-free from the render thread. A robot's slot is its
+     * snapshotSlot model role.
+     */
+    QSharedPointer<FleetSnapshot> fleetSnapshot() const { return m_fleetSnapshot; }
+
 public slots:
     Q_INVOKABLE void connectRobot(const QBluetoothDeviceInfo &device);
+
+    /**
+     * Connect every auto-connect entry of the known-device registry by
+     * address, without waiting for discovery. Called once at launch; the
+     * time until all of them are Ready is reported as fleetReadyMs.
+     */
+    Q_INVOKABLE void connectKnownDevices();
+
+    /**
+     * Add a device that broadcasts telemetry without connecting to it. The
+     * dashboard is fed from its advertisements; the first command sent to a
+     * watched robot opens a connection and is delivered once it is Ready.
+     */
+    Q_INVOKABLE void watchRobot(const QBluetoothDeviceInfo &device);
+
+    /**
+     * Replace the simulated devices with `count` new ones, alternating
+     * Falcons robots and BMS packs (0 removes them). They count against
+     * maxDevices and run through the same delta path as real links.
+     */
+    Q_INVOKABLE void simulateFleet(int count);
     Q_INVOKABLE void disconnectRobot(int index);
     Q_INVOKABLE void disconnectRobotByAddress(const QString &address);
     Q_INVOKABLE void disconnectAll();
@@ -43,48 +132,168 @@ public slots:
     /** Write play state to a specific robot (Falcons robots only) */
     Q_INVOKABLE void writePlayState(int index, int state);
 
-    /** Write play state to all connected Falcons robots */
+    /**
+     * Write play state to all connected Falcons robots. Broadcasts go out on
+     * the emergency lane; fleetCommand tracks each robot until it confirms.
+     */
     Q_INVOKABLE void writePlayStateAll(int state);
 
     /** Write WiFi SSID to a specific robot (Falcons robots only) */
     Q_INVOKABLE void writeWifiSsid(int index, const QString &ssid);
 
-    /** Write WiFi SSID to all connected Falcons robots */
+    /** Write WiFi SSID to all connected Falcons robots (tracked by fleetCommand) */
     Q_INVOKABLE void writeWifiSsidAll(const QString &ssid);
 
+    /**
+     * Issue an RPC request to a NUS robot. Several calls may be outstanding per
+     * robot; the result arrives via rpcFinished(). Returns the call id, or -1.
+     */
+    Q_INVOKABLE int callRobot(int index, int method, const QByteArray &payload = QByteArray(),
+                              int timeoutMs = 2000);
+
+    /** Cancel an outstanding RPC call on a robot */
+    Q_INVOKABLE bool cancelRobotCall(int index, int callId);
+
+    /** Per-method RPC round-trip latency summary for a robot */
+    Q_INVOKABLE QString rpcLatencyReport(int index) const;
+
+    /** Download a file (logs, calibration blobs) from a NUS robot; resumes partial downloads */
+    Q_INVOKABLE bool downloadFromRobot(int index, const QString &remoteName, const QString &localPath);
+
+    /** Upload a local file to a NUS robot */
+    Q_INVOKABLE bool uploadToRobot(int index, const QString &localPath, const QString &remoteName);
+
+    /** Abort the running bulk transfer on a robot */
+    Q_INVOKABLE void abortTransfer(int index);
+
+    /** Per-robot, per-stage play-state command latency (invoke -> model update) */
+    Q_INVOKABLE QString commandLatencyReport() const;
+
+    /**
+     * Export the command latency histograms as CSV. An empty path writes a
+     * timestamped file into the app data directory. Returns the path, or "" on failure.
+     */
+    Q_INVOKABLE QString exportCommandLatency(const QString &path = QString());
+
+    Q_INVOKABLE void resetCommandLatency();
+
+    /** Requested connection profile and granted parameters for every link */
+    Q_INVOKABLE QString connectionParametersReport() const;
+
+    /** Notification rate, jitter and loss for every robot link */
+    Q_INVOKABLE QString linkStatisticsReport() const;
+
 signals:
     void connectedCountChanged();
+    void maxDevicesChanged();
+    void fleetReadyChanged();
     void robotConnected(int index);
     void robotDisconnected(int index);
     void robotError(int index, const QString &error);
+    void rpcFinished(const QString &address, int callId, const QString &status,
+                     const QByteArray &payload);
+    void transferProgress(const QString &address, qint64 bytes, qint64 total, double bytesPerSecond);
+    void transferFinished(const QString &address, bool success, const QString &error,
+                          double bytesPerSecond);
 
 private slots:
-    void onConnectionStateChanged();
-    void onDataReceived(const QByteArray &data);
-    void onErrorOccurred(const QString &error);
-    void onJbdConnectionStateChanged();
-    void onJbdBmsDataUpdated();
-    void onJbdErrorOccurred(const QString &error);
-    void onFalconsConnectionStateChanged();
-    void onFalconsRobotDataUpdated();
-    void onFalconsErrorOccurred(const QString &error);
+    /** Fold everything the BLE worker published since the last drain into the model */
+    void drainLinkDeltas();
+    void onRpcCallFinished(const QString &address, quint16 callId, int method, int status,
+                           const QByteArray &payload, qint64 latencyUs);
+    void onTransferFinished(const QString &address, bool success, const QString &error,
+                            qint64 bytes, double bytesPerSecond, int mtu);
+    void onFleetWriteRequested(const QString &address);
+    void onFleetBoostRequested(const QString &address);
+    void onScannerTelemetry(const QBluetoothDeviceInfo &device,
+                            const AdvertisementTelemetry &telemetry);
+    void onScannerDeviceDiscovered(const QBluetoothDeviceInfo &device);
 
 private:
-    int findConnectionIndex(BleRobotConnection *connection);
+    // A link as seen from the GUI thread; the connection itself lives on the worker
+    struct Link {
+        quint64 id = 0;             // stamped on its deltas; a reconnect on the address gets a new one
+        Robot::DeviceType type = Robot::Unknown;
+        BleRobotConnection *nus = nullptr;
+        JbdBmsConnection *jbd = nullptr;
+        FalconsRobotConnection *falcons = nullptr;
+        SimulatedLink *simulated = nullptr;
+        Robot::ConnectionState state = Robot::Connecting;    // last published
+        QString name;
+        QBluetoothDeviceInfo device;                         // as opened, for an address type retry
+        QLowEnergyController::RemoteAddressType addressType = QLowEnergyController::RandomAddress;
+        bool addressTypeRetried = false;                     // already opened with the other type
+
+        QObject *connection() const;
+    };
+
+    void applyLinkDelta(const LinkDelta &delta);
     int findConnectionByAddress(const QString &address);
-    int findJbdConnectionIndex(JbdBmsConnection *connection);
-    int findFalconsConnectionIndex(FalconsRobotConnection *connection);
+    BleRobotConnection *findNusConnection(int index, bool requireReady = false) const;
+    FalconsRobotConnection *findFalconsConnection(const QString &address) const;
     void updateConnectedCount();
-    void updateRobotModel(int index);
-    void updateJbdRobotModel(int index);
+    qint64 sinceLaunchMs() const;
+    int connectionCount() const;
+    void countLinks(int &pending, int &active) const;
+    void updateScanSchedule();
+    QList<FleetTarget> readyFalconsTargets() const;
+    void postPlayState(FalconsRobotConnection *connection, int state);
+    void startConnection(const QBluetoothDeviceInfo &device, Robot::DeviceType type,
+                         QLowEnergyController::RemoteAddressType addressType);
+    void openConnection(const QBluetoothDeviceInfo &device, Robot::DeviceType type,
+                        QLowEnergyController::RemoteAddressType addressType);
+    void attachLink(const QString &address, const Link &link, QObject *connection, LinkPublisher *publisher);
+    void setLinkState(Link &link, Robot::ConnectionState state);
+    void drainConnectQueue();
+    void releaseConnection(const QString &address);
+    bool retryOtherAddressType(const QString &address, const LinkDelta &delta);
+    bool releaseLink(const QString &address);
+    void disconnectRobots(QList<int> indexes);
+    bool connectKnownDevice(const KnownDevice &known, const QBluetoothDeviceInfo &device);
+    bool admitKnownDevice(const KnownDevice &known, int batched) const;
+    Robot knownRobot(const KnownDevice &known, const QBluetoothDeviceInfo &device);
+    void onDeviceReady(int index);
+    void clearFleetWaiting(const QString &address);
+    void fleetWaitingReduced();
+    bool promoteWatchedRobot(int index, std::function<void(FalconsRobotConnection*)> command);
 
-    QList<BleRobotConnection*> m_connections;
-    QList<JbdBmsConnection*> m_jbdConnections;
-    QList<FalconsRobotConnection*> m_falconsConnections;
+    BleWorker *m_worker;
+    QSharedPointer<LinkDeltaQueue> m_linkDeltas;
+    QSharedPointer<FleetSnapshot> m_fleetSnapshot;
+    QHash<QString, Link> m_links;               // by address
     RobotListModel *m_robotListModel;
     BleDeviceScanner *m_scanner;
     int m_connectedCount;
+    int m_maxDevices;
+    std::array<int, Robot::Watching + 1> m_linkStateCounts;    // m_links by Link::state
     int m_nextRobotId;
+    quint64 m_nextLinkId;
+    FleetCommandFanout *m_fleetCommand;
+    CommandLatencyTracker *m_commandLatency;
+    KnownDeviceRegistry *m_knownDevices;
+
+    // Connections wait here so only MAX_CONCURRENT_SETUPS are set up at once
+    struct QueuedConnection {
+        QBluetoothDeviceInfo device;
+        Robot::DeviceType type;
+        QLowEnergyController::RemoteAddressType addressType;
+    };
+    QList<QueuedConnection> m_connectQueue;
+
+    // Launch-to-Ready timing and auto-connect
+    qint64 m_launchNs;      // MonotonicClock
+    QSet<QString> m_fleetWaiting;
+    int m_fleetExpected;
+    qint64 m_fleetReadyMs;
+    QHash<QString, qint64> m_autoConnectAttemptMs;
+    QSet<QString> m_autoConnectSuppressed;     // disconnected by the user this session
+
+    LatencyHistogram m_deltaLatency;
+    QStringList m_simulated;                    // addresses of SimulatedLinks
+
+    // Watched (connectionless) robots
+    QHash<QString, quint8> m_telemetrySequence;
+    QHash<QString, std::function<void(FalconsRobotConnection*)>> m_pendingCommands;
 };
 
 #endif // BLECONNECTIONMANAGER_H
@@ -1,6 +1,7 @@
 #include "BleDeviceScanner.h"
+#include "BleWorker.h"
+#include "DiscoveryWorker.h"
 #include <QDebug>
-#include <QVariantMap>
 
 // JBD BMS (Xiaoxiang/SmartBMS) uses the 0xFF00 BLE service with characteristics 0xFF01 (notify) and 0xFF02 (write)
 const QBluetoothUuid BleDeviceScanner::JBD_BMS_SERVICE_UUID = QBluetoothUuid(static_cast<quint16>(0xFF00));
@@ -8,30 +9,65 @@ const QBluetoothUuid BleDeviceScanner::JBD_BMS_SERVICE_UUID = QBluetoothUuid(sta
 // Falcons Robot Control service UUID
 const QBluetoothUuid BleDeviceScanner::FALCONS_SERVICE_UUID = QBluetoothUuid(QStringLiteral("FA1C0001-B5A3-F393-E0A9-E50E24DCCA9E"));
 
-BleDeviceScanner::BleDeviceScanner(QObject *parent)
+BleDeviceScanner::BleDeviceScanner(BleWorker *worker, QObject *parent)
     : QObject(parent)
+    , m_discovery(new DiscoveryWorker())
+    , m_devices(new DiscoveredDeviceModel(this))
+    , m_deviceView(new DiscoveredDeviceProxyModel(m_devices, this))
+    , m_agingTimer(new QTimer(this))
+    , m_scheduler(new ScanScheduler(this))
+    , m_publishIntervalMs(DEFAULT_PUBLISH_INTERVAL_MS)
+    , m_rssiThreshold(DEFAULT_RSSI_THRESHOLD)
+    , m_rawUpdates(0)
+    , m_publishedUpdates(0)
+    , m_staleAfterMs(DEFAULT_STALE_AFTER_MS)
+    , m_memoryEstimate(0)
     , m_scanning(false)
-    , m_filterEnabled(true)
 {
-    m_discoveryAgent = new QBluetoothDeviceDiscoveryAgent(this);
-    m_discoveryAgent->setLowEnergyDiscoveryTimeout(0);
+    m_discovery->setPublishIntervalMs(m_publishIntervalMs);
+    connect(m_discovery, &DiscoveryWorker::devicesReported, this, &BleDeviceScanner::publishReported);
+    connect(m_discovery, &DiscoveryWorker::finished, this, &BleDeviceScanner::onScanFinished);
+    connect(m_discovery, &DiscoveryWorker::errorOccurred, this, &BleDeviceScanner::onScanError);
+    worker->adopt(m_discovery);
 
-    connect(m_discoveryAgent, &QBluetoothDeviceDiscoveryAgent::deviceDiscovered,
-            this, &BleDeviceScanner::onDeviceDiscovered);
-    connect(m_discoveryAgent, &QBluetoothDeviceDiscoveryAgent::finished,
-            this, &BleDeviceScanner::onScanFinished);
-    connect(m_discoveryAgent, &QBluetoothDeviceDiscoveryAgent::errorOccurred,
-            this, &BleDeviceScanner::onScanError);
+    m_agingTimer->setInterval(AGING_INTERVAL_MS);
+    connect(m_agingTimer, &QTimer::timeout, this, &BleDeviceScanner::onAgingTimer);
+    m_agingTimer->start();
+
+    connect(m_scheduler, &ScanScheduler::scanRequested, this, [this](bool scan) {
+        if (scan) startDiscovery();
+        else stopDiscovery();
+    });
+    connect(m_scheduler, &ScanScheduler::profileChanged, this, &BleDeviceScanner::scanProfileChanged);
 }
 
 BleDeviceScanner::~BleDeviceScanner()
 {
-    if (m_discoveryAgent->isActive()) {
-        m_discoveryAgent->stop();
-    }
+    // Stops the agent on the worker; batches still in flight are dropped with this object
+    QObject::disconnect(m_discovery, nullptr, this, nullptr);
+    m_discovery->deleteLater();
 }
 
 void BleDeviceScanner::startScan()
+{
+    m_scheduler->setEnabled(true);
+}
+
+void BleDeviceScanner::stopScan()
+{
+    m_scheduler->setEnabled(false);
+}
+
+void BleDeviceScanner::setDiscoveryRequested(bool requested)
+{
+    if (m_scheduler->isDiscoveryRequested() == requested)
+        return;
+
+    m_scheduler->setDiscoveryRequested(requested);
+    emit discoveryRequestedChanged();
+}
+
+void BleDeviceScanner::startDiscovery()
 {
     if (m_scanning) {
         return;
@@ -42,28 +78,31 @@ void BleDeviceScanner::startScan()
     m_scanning = true;
     emit scanningChanged();
 
-    m_discoveryAgent->start(QBluetoothDeviceDiscoveryAgent::LowEnergyMethod);
+    DiscoveryWorker *discovery = m_discovery;
+    BleWorker::post(discovery, [discovery]() { discovery->start(); });
 }
 
-void BleDeviceScanner::stopScan()
+void BleDeviceScanner::stopDiscovery()
 {
     if (!m_scanning) {
         return;
     }
 
     qDebug() << "Stopping BLE scan...";
-    m_discoveryAgent->stop();
-    
+    DiscoveryWorker *discovery = m_discovery;
+    BleWorker::post(discovery, [discovery]() { discovery->stop(); });
+
     m_scanning = false;
     emit scanningChanged();
 }
 
 void BleDeviceScanner::setFilterEnabled(bool enabled)
 {
-    if (m_filterEnabled == enabled)
+    if (m_deviceView->knownTypesOnly() == enabled)
         return;
 
-    m_filterEnabled = enabled;
+    // Filtering happens in the view, so unfiltering shows what was already seen
+    m_deviceView->setKnownTypesOnly(enabled);
     emit filterEnabledChanged();
     qDebug() << "JBD BMS filter" << (enabled ? "enabled" : "disabled");
 }
@@ -94,28 +133,113 @@ bool BleDeviceScanner::isFalconsDevice(const QBluetoothDeviceInfo &device) const
     return device.name().startsWith("Falcons-");
 }
 
-void BleDeviceScanner::onDeviceDiscovered(const QBluetoothDeviceInfo &device)
+void BleDeviceScanner::publishReported(const QList<QBluetoothDeviceInfo> &devices, qint64 rawCount)
 {
-    // Only process Low Energy devices
-    if (!(device.coreConfigurations() & QBluetoothDeviceInfo::LowEnergyCoreConfiguration)) {
-        return;
+    m_rawUpdates += rawCount;
+
+    for (const QBluetoothDeviceInfo &device : devices) {
+        const AdvertisementTelemetry telemetry = AdvertisementTelemetry::decode(device);
+        if (telemetry.isValid()) {
+            emit telemetryReceived(device, telemetry);
+        }
+
+        const Robot::DeviceType type = classify(device, telemetry);
+        const bool isNew = m_devices->rowOf(device.address()) < 0;
+        if (!m_devices->upsert(device, type, telemetry.isValid(), m_rssiThreshold)) {
+            continue;
+        }
+        m_publishedUpdates++;
+
+        // Filter for JBD BMS devices if enabled (but always pass Falcons robots)
+        if (isFilterEnabled() && type == Robot::Unknown) {
+            continue;
+        }
+
+        if (isNew) {
+            qDebug() << "Device discovered:" << device.name() << device.address().toString()
+                     << "RSSI:" << device.rssi();
+        }
+        emit deviceDiscovered(device);
     }
 
-    // Filter for JBD BMS devices if enabled (but always pass Falcons robots)
-    if (m_filterEnabled && !isJbdBmsDevice(device) && !isFalconsDevice(device)) {
-        return;
+    emit updateCountsChanged();
+}
+
+void BleDeviceScanner::onAgingTimer()
+{
+    if (m_staleAfterMs > 0) {
+        const int removed = m_devices->evictOlderThan(m_staleAfterMs);
+        if (removed > 0) {
+            qDebug() << "Dropped" << removed << "stale devices," << m_devices->count() << "left";
+        }
+    }
+
+    // The agent keeps every device it has seen since start(); the worker restarts it when too big
+    if (m_scanning) {
+        DiscoveryWorker *discovery = m_discovery;
+        const int limit = 2 * m_devices->capacity();
+        BleWorker::post(discovery, [discovery, limit]() { discovery->resetIfLargerThan(limit); });
     }
 
-    qDebug() << "Device discovered:" << device.name() << device.address().toString()
-             << "RSSI:" << device.rssi();
+    m_memoryEstimate = m_devices->memoryEstimate();
+    emit tableStatsChanged();
+}
+
+void BleDeviceScanner::setStaleAfterMs(int ms)
+{
+    ms = qMax(ms, 0);
+    if (m_staleAfterMs == ms)
+        return;
+
+    m_staleAfterMs = ms;
+    emit staleAfterMsChanged();
+}
+
+void BleDeviceScanner::setMaxDevices(int count)
+{
+    if (m_devices->capacity() == count)
+        return;
+
+    m_devices->setCapacity(count);
+    emit maxDevicesChanged();
+    emit tableStatsChanged();
+}
+
+void BleDeviceScanner::setPublishIntervalMs(int ms)
+{
+    ms = qMax(ms, MIN_PUBLISH_INTERVAL_MS);
+    if (m_publishIntervalMs == ms)
+        return;
+
+    m_publishIntervalMs = ms;
+    DiscoveryWorker *discovery = m_discovery;
+    BleWorker::post(discovery, [discovery, ms]() { discovery->setPublishIntervalMs(ms); });
+    emit publishIntervalMsChanged();
+}
+
+void BleDeviceScanner::setRssiThreshold(int dB)
+{
+    dB = qMax(dB, 0);
+    if (m_rssiThreshold == dB)
+        return;
+
+    m_rssiThreshold = dB;
+    emit rssiThresholdChanged();
+}
 
-    updateDeviceList(device);
-    emit deviceDiscovered(device);
+Robot::DeviceType BleDeviceScanner::classify(const QBluetoothDeviceInfo &device,
+                                             const AdvertisementTelemetry &telemetry) const
+{
+    if (telemetry.kind == AdvertisementTelemetry::RobotRecord || isFalconsDevice(device))
+        return Robot::FalconsRobot;
+    if (telemetry.kind == AdvertisementTelemetry::BmsRecord || isJbdBmsDevice(device))
+        return Robot::SmartBMS;
+    return Robot::Unknown;
 }
 
 void BleDeviceScanner::onScanFinished()
 {
-    qDebug() << "BLE scan finished. Found" << m_discoveredDevices.count() << "devices";
+    qDebug() << "BLE scan finished. Found" << m_devices->count() << "devices";
     
     m_scanning = false;
     emit scanningChanged();
@@ -155,52 +279,10 @@ void BleDeviceScanner::onScanError(QBluetoothDeviceDiscoveryAgent::Error error)
 
 QBluetoothDeviceInfo BleDeviceScanner::getDeviceAt(int index) const
 {
-    if (index >= 0 && index < m_deviceInfoList.size()) {
-        return m_deviceInfoList.at(index);
-    }
-    return QBluetoothDeviceInfo();
+    return m_devices->deviceAt(m_deviceView->sourceRow(index));
 }
 
 QBluetoothDeviceInfo BleDeviceScanner::getDeviceByAddress(const QString &address) const
 {
-    for (const QBluetoothDeviceInfo &device : m_deviceInfoList) {
-        if (device.address().toString() == address) {
-            return device;
-        }
-    }
-    return QBluetoothDeviceInfo();
-}
-
-void BleDeviceScanner::updateDeviceList(const QBluetoothDeviceInfo &device)
-{
-    // Check if device already exists (by address)
-    bool found = false;
-    for (int i = 0; i < m_deviceInfoList.size(); ++i) {
-        if (m_deviceInfoList[i].address() == device.address()) {
-            // Update existing device (RSSI may have changed)
-            m_deviceInfoList[i] = device;
-            
-            QVariantMap deviceMap;
-            deviceMap["name"] = device.name().isEmpty() ? "Unknown Device" : device.name();
-            deviceMap["address"] = device.address().toString();
-            deviceMap["rssi"] = device.rssi();
-            m_discoveredDevices[i] = deviceMap;
-            
-            found = true;
-            break;
-        }
-    }
-
-    if (!found) {
-        // Add new device
-        m_deviceInfoList.append(device);
-        
-        QVariantMap deviceMap;
-        deviceMap["name"] = device.name().isEmpty() ? "Unknown Device" : device.name();
-        deviceMap["address"] = device.address().toString();
-        deviceMap["rssi"] = device.rssi();
-        m_discoveredDevices.append(deviceMap);
-    }
-
-    emit discoveredDevicesChanged();
+    return m_devices->deviceByAddress(QBluetoothAddress(address));
 }
@@ -5,14 +5,58 @@
 #include <QBluetoothDeviceDiscoveryAgent>
 #include <QBluetoothDeviceInfo>
 #include <QBluetoothUuid>
-#include <QVariantList>
+#include <QTimer>
+#include "src/models/Robot.h"
+#include "src/models/DiscoveredDeviceModel.h"
+#include "src/models/DiscoveredDeviceProxyModel.h"
+#include "src/protocol/AdvertisementTelemetry.h"
+#include "ScanScheduler.h"
 
+class BleWorker;
+class DiscoveryWorker;
+
+/**
+ * BleDeviceScanner - continuous LE discovery feeding DiscoveredDeviceModel.
+ *
+ * Advertisements arrive far faster than anyone can read a list, so they are
+ * coalesced: the latest report per device is kept and published every
+ * publishIntervalMs. RSSI moves below rssiThreshold dB are not published.
+ * rawUpdateCount and publishedUpdateCount show how much was absorbed.
+ *
+ * Advertisements carrying an AdvertisementTelemetry record are decoded at
+ * publish time and reported through telemetryReceived(), whether or not the
+ * row itself changed.
+ *
+ * The discovery agent and the coalescing run on the BLE worker
+ * (DiscoveryWorker); this side only sees the batches.
+ *
+ * Devices not heard for staleAfterMs are dropped and the table is capped at
+ * maxDevices (least recently seen replaced first), so a day of rotating
+ * random addresses leaves memory flat. The discovery agent's own device
+ * list is reset by restarting discovery when it outgrows the cap.
+ *
+ * startScan()/stopScan() only enable scanning; when the radio actually
+ * listens is up to ScanScheduler, which pauses discovery while links are
+ * being set up and thins it out once robots are connected.
+ */
 class BleDeviceScanner : public QObject
 {
     Q_OBJECT
     Q_PROPERTY(bool scanning READ isScanning NOTIFY scanningChanged)
-    Q_PROPERTY(QVariantList discoveredDevices READ discoveredDevices NOTIFY discoveredDevicesChanged)
+    Q_PROPERTY(DiscoveredDeviceProxyModel* devices READ devices CONSTANT)
     Q_PROPERTY(bool filterEnabled READ isFilterEnabled WRITE setFilterEnabled NOTIFY filterEnabledChanged)
+    Q_PROPERTY(int publishIntervalMs READ publishIntervalMs WRITE setPublishIntervalMs NOTIFY publishIntervalMsChanged)
+    Q_PROPERTY(int rssiThreshold READ rssiThreshold WRITE setRssiThreshold NOTIFY rssiThresholdChanged)
+    Q_PROPERTY(qint64 rawUpdateCount READ rawUpdateCount NOTIFY updateCountsChanged)
+    Q_PROPERTY(qint64 publishedUpdateCount READ publishedUpdateCount NOTIFY updateCountsChanged)
+    Q_PROPERTY(int staleAfterMs READ staleAfterMs WRITE setStaleAfterMs NOTIFY staleAfterMsChanged)
+    Q_PROPERTY(int maxDevices READ maxDevices WRITE setMaxDevices NOTIFY maxDevicesChanged)
+    Q_PROPERTY(int deviceCount READ deviceCount NOTIFY tableStatsChanged)
+    Q_PROPERTY(qint64 evictedCount READ evictedCount NOTIFY tableStatsChanged)
+    Q_PROPERTY(qint64 memoryEstimate READ memoryEstimate NOTIFY tableStatsChanged)
+    Q_PROPERTY(bool discoveryRequested READ isDiscoveryRequested WRITE setDiscoveryRequested NOTIFY discoveryRequestedChanged)
+    Q_PROPERTY(QString scanProfile READ scanProfile NOTIFY scanProfileChanged)
+    Q_PROPERTY(QString scanSummary READ scanSummary NOTIFY scanProfileChanged)
 
 public:
     // JBD (Xiaoxiang/SmartBMS) BLE service UUID (0xFF00)
@@ -21,44 +65,107 @@ public:
     // Falcons Robot Control service UUID
     static const QBluetoothUuid FALCONS_SERVICE_UUID;
 
-    explicit BleDeviceScanner(QObject *parent = nullptr);
+    static constexpr int DEFAULT_PUBLISH_INTERVAL_MS = 150;    // ~7 Hz
+    static constexpr int MIN_PUBLISH_INTERVAL_MS = 50;
+    static constexpr int DEFAULT_RSSI_THRESHOLD = 3;           // dB
+    static constexpr int DEFAULT_STALE_AFTER_MS = 120000;
+    static constexpr int AGING_INTERVAL_MS = 5000;
+
+    explicit BleDeviceScanner(BleWorker *worker, QObject *parent = nullptr);
     ~BleDeviceScanner();
 
     bool isScanning() const { return m_scanning; }
-    QVariantList discoveredDevices() const { return m_discoveredDevices; }
-    bool isFilterEnabled() const { return m_filterEnabled; }
+    bool isFilterEnabled() const { return m_deviceView->knownTypesOnly(); }
+
+    int publishIntervalMs() const { return m_publishIntervalMs; }
+    void setPublishIntervalMs(int ms);
+
+    int rssiThreshold() const { return m_rssiThreshold; }
+    void setRssiThreshold(int dB);
+
+    /** Advertisement reports received, and reports that changed the model */
+    qint64 rawUpdateCount() const { return m_rawUpdates; }
+    qint64 publishedUpdateCount() const { return m_publishedUpdates; }
+
+    /** Drop devices not heard for this long (0 keeps them until the cap replaces them) */
+    int staleAfterMs() const { return m_staleAfterMs; }
+    void setStaleAfterMs(int ms);
+
+    int maxDevices() const { return m_devices->capacity(); }
+    void setMaxDevices(int count);
+
+    int deviceCount() const { return m_devices->count(); }
+    qint64 evictedCount() const { return m_devices->evictedCount(); }
+
+    /** Estimated bytes held by the device table, refreshed every AGING_INTERVAL_MS */
+    qint64 memoryEstimate() const { return m_memoryEstimate; }
+
+    /** Someone is looking at the device list; scan continuously */
+    bool isDiscoveryRequested() const { return m_scheduler->isDiscoveryRequested(); }
+    void setDiscoveryRequested(bool requested);
+
+    QString scanProfile() const { return ScanScheduler::profileName(m_scheduler->profile()); }
+    QString scanSummary() const { return m_scheduler->summary(); }
+
+    ScanScheduler *scheduler() const { return m_scheduler; }
+
+    /** All LE devices seen, keyed by address */
+    DiscoveredDeviceModel *deviceModel() const { return m_devices; }
+
+    /** RSSI-sorted view, limited to robots and BMSes while the filter is enabled */
+    DiscoveredDeviceProxyModel *devices() const { return m_deviceView; }
 
 public slots:
     void startScan();
     void stopScan();
     void setFilterEnabled(bool enabled);
 
+    /** Device at a row of the devices view */
     Q_INVOKABLE QBluetoothDeviceInfo getDeviceAt(int index) const;
     Q_INVOKABLE QBluetoothDeviceInfo getDeviceByAddress(const QString &address) const;
 
 signals:
     void scanningChanged();
-    void discoveredDevicesChanged();
     void deviceDiscovered(const QBluetoothDeviceInfo &device);
+    void telemetryReceived(const QBluetoothDeviceInfo &device, const AdvertisementTelemetry &telemetry);
     void scanFinished();
     void scanError(const QString &error);
     void filterEnabledChanged();
+    void publishIntervalMsChanged();
+    void rssiThresholdChanged();
+    void updateCountsChanged();
+    void staleAfterMsChanged();
+    void maxDevicesChanged();
+    void tableStatsChanged();
+    void discoveryRequestedChanged();
+    void scanProfileChanged();
 
 private slots:
-    void onDeviceDiscovered(const QBluetoothDeviceInfo &device);
+    void publishReported(const QList<QBluetoothDeviceInfo> &devices, qint64 rawCount);
+    void onAgingTimer();
     void onScanFinished();
     void onScanError(QBluetoothDeviceDiscoveryAgent::Error error);
 
 private:
-    void updateDeviceList(const QBluetoothDeviceInfo &device);
+    void startDiscovery();
+    void stopDiscovery();
+    Robot::DeviceType classify(const QBluetoothDeviceInfo &device,
+                               const AdvertisementTelemetry &telemetry) const;
     bool isJbdBmsDevice(const QBluetoothDeviceInfo &device) const;
     bool isFalconsDevice(const QBluetoothDeviceInfo &device) const;
 
-    QBluetoothDeviceDiscoveryAgent *m_discoveryAgent;
-    QVariantList m_discoveredDevices;
-    QList<QBluetoothDeviceInfo> m_deviceInfoList;
+    DiscoveryWorker *m_discovery;       // on the BLE worker
+    DiscoveredDeviceModel *m_devices;
+    DiscoveredDeviceProxyModel *m_deviceView;
+    QTimer *m_agingTimer;
+    ScanScheduler *m_scheduler;
+    int m_publishIntervalMs;
+    int m_rssiThreshold;
+    qint64 m_rawUpdates;
+    qint64 m_publishedUpdates;
+    int m_staleAfterMs;
+    qint64 m_memoryEstimate;
     bool m_scanning;
-    bool m_filterEnabled;
 };
 
 #endif // BLEDEVICESCANNER_H
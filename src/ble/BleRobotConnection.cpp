@@ -1,4 +1,7 @@
 #include "BleRobotConnection.h"
+#include "src/protocol/PacketInterface.h"
+#include "src/protocol/RpcClient.h"
+#include "src/protocol/BulkTransfer.h"
 #include <QDebug>
 
 // Nordic UART Service UUID definitions
@@ -6,18 +9,77 @@ const QBluetoothUuid BleRobotConnection::NUS_SERVICE_UUID = QBluetoothUuid(QStri
 const QBluetoothUuid BleRobotConnection::NUS_RX_CHAR_UUID = QBluetoothUuid(QStringLiteral("6E400002-B5A3-F393-E0A9-E50E24DCCA9E"));
 const QBluetoothUuid BleRobotConnection::NUS_TX_CHAR_UUID = QBluetoothUuid(QStringLiteral("6E400003-B5A3-F393-E0A9-E50E24DCCA9E"));
 
-BleRobotConnection::BleRobotConnection(QObject *parent)
+BleRobotConnection::BleRobotConnection(TimerWheel *timers, QObject *parent)
     : QObject(parent)
     , m_controller(nullptr)
     , m_service(nullptr)
+    , m_gattQueue(new GattOperationQueue(timers, this))
+    , m_setup(new GattSetupSequence(m_gattQueue, timers, this))
+    , m_linkProfile(new ConnectionProfileController(Robot::Unknown, timers, this))
+    , m_rssiMonitor(new RssiMonitor(m_gattQueue, timers, this))
+    , m_linkMonitor(new LinkQualityMonitor(timers, this))
+    , m_staleness(new StalenessMonitor(timers, this))
+    , m_packetInterface(new PacketInterface(this))
+    , m_rpcClient(new RpcClient(m_packetInterface, this))
+    , m_bulkTransfer(new BulkTransfer(m_packetInterface, this))
+    , m_mtu(23)
     , m_connectionState(Robot::Disconnected)
     , m_rssi(-100)
     , m_serviceFound(false)
 {
+    // Framed packets (RPC requests etc.) go out through the regular NUS write path
+    connect(m_packetInterface, &PacketInterface::packetToSend,
+            this, &BleRobotConnection::sendData);
+
+    connect(m_setup, &GattSetupSequence::finished, this, &BleRobotConnection::onSetupFinished);
+    connect(m_setup, &GattSetupSequence::timedOut, this, &BleRobotConnection::onSetupTimedOut);
+    connect(m_rssiMonitor, &RssiMonitor::updated, this, [this]() {
+        m_rssi = m_rssiMonitor->rssi();
+        emit rssiChanged();
+    });
+    connect(m_linkMonitor, &LinkQualityMonitor::updated,
+            this, &BleRobotConnection::linkStatisticsChanged);
+    connect(m_staleness, &StalenessMonitor::staleChanged,
+            this, &BleRobotConnection::staleChanged);
+    connect(m_packetInterface, &PacketInterface::sequenceReceived, this, [this](quint16 sequence) {
+        m_linkMonitor->sequenceReceived(NUS_TX_CHAR_UUID, sequence);
+    });
+
+    // NUS chunks are paced one connection event's worth per granted interval
+    connect(m_linkProfile, &ConnectionProfileController::parametersGranted, this,
+            [this](const QLowEnergyConnectionParameters &parameters) {
+        m_gattQueue->setConnectionInterval(parameters.maximumInterval());
+    });
+
+    // Bulk transfers run on the short interval; relax again after they end
+    connect(m_bulkTransfer, &BulkTransfer::stateChanged, this, [this]() {
+        if (m_bulkTransfer->isActive()) {
+            m_linkProfile->setMode(ConnectionProfile::Active);
+        } else if (m_linkProfile->mode() == ConnectionProfile::Active) {
+            m_linkProfile->boost();
+        }
+    });
+
+    // How close a transfer came to what the link's MTU and granted interval allow
+    connect(m_bulkTransfer, &BulkTransfer::finished, this, [this](bool success) {
+        if (!success || !m_linkProfile->hasGrantedParameters()) {
+            return;
+        }
+        const double intervalMs = m_linkProfile->grantedParameters().maximumInterval();
+        const GattOperationQueue::Pacing pacing = m_gattQueue->pacing();
+        const double bound = BulkTransfer::theoreticalThroughput(m_mtu, pacing.intervalMs,
+                                                                 pacing.batch);
+        if (bound > 0.0) {
+            qDebug() << "BleRobotConnection: Transfer at" << qRound(m_bulkTransfer->throughput()) << "B/s,"
+                     << qRound(100.0 * m_bulkTransfer->throughput() / bound) << "% of the"
+                     << qRound(bound) << "B/s allowed by MTU" << m_mtu << "at" << intervalMs << "ms";
+        }
+    });
 }
 
 BleRobotConnection::~BleRobotConnection()
 {
+    m_gattQueue->setService(nullptr);
     if (m_service) {
         delete m_service;
         m_service = nullptr;
@@ -29,7 +91,8 @@ BleRobotConnection::~BleRobotConnection()
     }
 }
 
-void BleRobotConnection::connectToDevice(const QBluetoothDeviceInfo &device)
+void BleRobotConnection::connectToDevice(const QBluetoothDeviceInfo &device,
+                                         QLowEnergyController::RemoteAddressType addressType)
 {
     if (m_controller) {
         qWarning() << "Already connected or connecting";
@@ -49,9 +112,9 @@ void BleRobotConnection::connectToDevice(const QBluetoothDeviceInfo &device)
     // Create controller
     m_controller = QLowEnergyController::createCentral(device, this);
 
-    // On Linux without CAP_NET_ADMIN, BlueZ can't auto-detect address types.
-    // BLE peripherals typically use random addresses, so set it explicitly.
-    m_controller->setRemoteAddressType(QLowEnergyController::RandomAddress);
+    // On Linux without CAP_NET_ADMIN, BlueZ can't auto-detect address types;
+    // the caller passes the one remembered for this device (random if unknown)
+    m_controller->setRemoteAddressType(addressType);
 
     connect(m_controller, &QLowEnergyController::connected,
             this, &BleRobotConnection::onControllerConnected);
@@ -63,8 +126,13 @@ void BleRobotConnection::connectToDevice(const QBluetoothDeviceInfo &device)
             this, &BleRobotConnection::onServiceDiscovered);
     connect(m_controller, &QLowEnergyController::discoveryFinished,
             this, &BleRobotConnection::onDiscoveryFinished);
+    connect(m_controller, &QLowEnergyController::mtuChanged,
+            this, &BleRobotConnection::onMtuChanged);
 
     qDebug() << "Connecting to device:" << m_robotName << m_deviceAddress.toString();
+    m_linkProfile->setController(m_controller);
+    m_rssiMonitor->setController(m_controller);
+    m_setup->start(m_robotName);
     m_controller->connectToDevice();
 }
 
@@ -87,15 +155,17 @@ void BleRobotConnection::sendData(const QByteArray &data)
         return;
     }
 
-    // Check if we need to chunk the data (typical BLE MTU is 20-23 bytes)
-    const int maxChunkSize = 20;
+    // Chunk to the ATT payload of the negotiated MTU (MTU minus 3-byte ATT header)
+    const int maxChunkSize = m_mtu - 3;
     if (data.size() <= maxChunkSize) {
-        m_service->writeCharacteristic(m_rxCharacteristic, data, QLowEnergyService::WriteWithoutResponse);
+        m_gattQueue->writeCharacteristic(m_rxCharacteristic, data, GattOperationQueue::Bulk,
+                                         QLowEnergyService::WriteWithoutResponse);
     } else {
         // Send in chunks
         for (int i = 0; i < data.size(); i += maxChunkSize) {
             QByteArray chunk = data.mid(i, maxChunkSize);
-            m_service->writeCharacteristic(m_rxCharacteristic, chunk, QLowEnergyService::WriteWithoutResponse);
+            m_gattQueue->writeCharacteristic(m_rxCharacteristic, chunk, GattOperationQueue::Bulk,
+                                             QLowEnergyService::WriteWithoutResponse);
         }
     }
 }
@@ -105,14 +175,27 @@ void BleRobotConnection::onControllerConnected()
     qDebug() << "Controller connected, discovering services...";
     setConnectionState(Robot::Connected);
     m_serviceFound = false;
+    m_setup->beginPhase(GattSetupSequence::Discovery);
+    m_linkProfile->setMode(ConnectionProfile::Active);     // short interval for setup
+    m_linkMonitor->start();
     m_controller->discoverServices();
 }
 
 void BleRobotConnection::onControllerDisconnected()
 {
     qDebug() << "Controller disconnected";
+    m_setup->abort();
+    m_rssiMonitor->stop();
+    m_linkMonitor->stop();
+    m_staleness->stop();
     setConnectionState(Robot::Disconnected);
-    
+    m_gattQueue->setService(nullptr);
+    m_rpcClient->cancelAll(RpcClient::LinkDown);
+    m_bulkTransfer->abort(QStringLiteral("Link down"));
+    m_packetInterface->reset();
+    m_mtu = 23;
+    m_bulkTransfer->setChunkSize(BulkTransfer::DEFAULT_CHUNK_SIZE);
+
     if (m_service) {
         delete m_service;
         m_service = nullptr;
@@ -121,10 +204,22 @@ void BleRobotConnection::onControllerDisconnected()
 
 void BleRobotConnection::onControllerError(QLowEnergyController::Error error)
 {
+    if (error == QLowEnergyController::RssiReadError) {
+        // Only the periodic RSSI sample failed; the link itself is fine
+        m_rssiMonitor->handleReadError();
+        return;
+    }
+
     QString errorString = m_controller->errorString();
     qWarning() << "Controller error:" << error << errorString;
+    m_setup->abort();
+    m_rssiMonitor->stop();
+    m_linkMonitor->stop();
+    m_staleness->stop();
     setError(errorString);
     setConnectionState(Robot::Error);
+    m_rpcClient->cancelAll(RpcClient::LinkDown);
+    m_bulkTransfer->abort(QStringLiteral("Link error"));
 }
 
 void BleRobotConnection::onServiceDiscovered(const QBluetoothUuid &serviceUuid)
@@ -169,8 +264,10 @@ void BleRobotConnection::setupService()
             this, &BleRobotConnection::onCharacteristicChanged);
     connect(m_service, &QLowEnergyService::characteristicWritten,
             this, &BleRobotConnection::onCharacteristicWritten);
+    m_gattQueue->setService(m_service);
 
     qDebug() << "Discovering service details...";
+    m_setup->beginPhase(GattSetupSequence::ServiceDetails);
     m_service->discoverDetails();
 }
 
@@ -184,12 +281,14 @@ void BleRobotConnection::onServiceStateChanged(QLowEnergyService::ServiceState s
         m_txCharacteristic = m_service->characteristic(NUS_TX_CHAR_UUID);
 
         if (!m_rxCharacteristic.isValid()) {
+            m_setup->abort();
             setError("RX characteristic not found");
             setConnectionState(Robot::Error);
             return;
         }
 
         if (!m_txCharacteristic.isValid()) {
+            m_setup->abort();
             setError("TX characteristic not found");
             setConnectionState(Robot::Error);
             return;
@@ -197,23 +296,46 @@ void BleRobotConnection::onServiceStateChanged(QLowEnergyService::ServiceState s
 
         qDebug() << "Characteristics found, enabling notifications...";
 
-        // Enable notifications on TX characteristic
-        QLowEnergyDescriptor notification = m_txCharacteristic.descriptor(
-            QBluetoothUuid::DescriptorType::ClientCharacteristicConfiguration);
+        // Enable notifications on TX characteristic; NUS has no state to fetch,
+        // so Ready follows the CCCD write response
+        m_setup->beginPhase(GattSetupSequence::Subscribe);
+        m_setup->subscribe(m_txCharacteristic);
+        m_setup->commit();
+    }
+}
 
-        if (notification.isValid()) {
-            m_service->writeDescriptor(notification, QByteArray::fromHex("0100"));
-        }
+void BleRobotConnection::onSetupFinished(bool complete)
+{
+    Q_UNUSED(complete)
+    setConnectionState(Robot::Ready);
+    m_linkProfile->boost();                                 // relax once setup traffic is over
+    m_rssiMonitor->start(m_rssi);
+    m_staleness->start();
+    qDebug() << "Connection ready!" << m_setup->summary();
+}
 
-        setConnectionState(Robot::Ready);
-        qDebug() << "Connection ready!";
+void BleRobotConnection::onSetupTimedOut(GattSetupSequence::Phase phase)
+{
+    m_linkMonitor->stop();
+    setError(QStringLiteral("Connection setup timed out (%1)").arg(GattSetupSequence::phaseName(phase)));
+    setConnectionState(Robot::Error);
+    if (m_controller) {
+        m_controller->disconnectFromDevice();
     }
 }
 
 void BleRobotConnection::onCharacteristicChanged(const QLowEnergyCharacteristic &characteristic, const QByteArray &value)
 {
     if (characteristic.uuid() == NUS_TX_CHAR_UUID) {
-        emit dataReceived(value);
+        m_linkMonitor->notificationReceived(NUS_TX_CHAR_UUID);
+        m_staleness->dataReceived();
+
+        // Bulk chunks go to the transfer only; they are neither logged nor shown as packets
+        const bool bulk = m_bulkTransfer->isActive();
+        m_packetInterface->onDataReceived(value);
+        if (!bulk) {
+            emit dataReceived(value);
+        }
     }
 }
 
@@ -224,6 +346,16 @@ void BleRobotConnection::onCharacteristicWritten(const QLowEnergyCharacteristic
     // Data was successfully written
 }
 
+void BleRobotConnection::onMtuChanged(int mtu)
+{
+    qDebug() << "MTU changed:" << mtu;
+    m_mtu = mtu;
+    m_gattQueue->setMtu(mtu);
+
+    // Fill each write: ATT header (3) and packet frame header come off the MTU
+    m_bulkTransfer->setChunkSize(mtu - 3 - PacketInterface::HEADER_SIZE - BulkTransfer::DATA_HEADER_SIZE);
+}
+
 void BleRobotConnection::setConnectionState(Robot::ConnectionState state)
 {
     if (m_connectionState != state) {
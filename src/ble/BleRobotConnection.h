@@ -7,6 +7,16 @@
 #include <QLowEnergyService>
 #include <QBluetoothUuid>
 #include "src/models/Robot.h"
+#include "GattOperationQueue.h"
+#include "GattSetupSequence.h"
+#include "ConnectionProfile.h"
+#include "RssiMonitor.h"
+#include "LinkQualityMonitor.h"
+#include "StalenessMonitor.h"
+
+class PacketInterface;
+class RpcClient;
+class BulkTransfer;
 
 class BleRobotConnection : public QObject
 {
@@ -16,6 +26,7 @@ class BleRobotConnection : public QObject
     Q_PROPERTY(QString robotAddress READ robotAddress NOTIFY robotAddressChanged)
     Q_PROPERTY(int rssi READ rssi NOTIFY rssiChanged)
     Q_PROPERTY(QString lastError READ lastError NOTIFY errorOccurred)
+    Q_PROPERTY(bool stale READ isStale NOTIFY staleChanged)
 
 public:
     // Nordic UART Service UUIDs
@@ -23,7 +34,7 @@ public:
     static const QBluetoothUuid NUS_RX_CHAR_UUID;  // Write to robot
     static const QBluetoothUuid NUS_TX_CHAR_UUID;  // Receive from robot
 
-    explicit BleRobotConnection(QObject *parent = nullptr);
+    explicit BleRobotConnection(TimerWheel *timers, QObject *parent = nullptr);
     ~BleRobotConnection();
 
     Robot::ConnectionState connectionState() const { return m_connectionState; }
@@ -34,8 +45,34 @@ public:
 
     QBluetoothAddress deviceAddress() const { return m_deviceAddress; }
 
+    /** Framed packet channel and pipelined RPC layer running over this NUS link */
+    PacketInterface *packetInterface() const { return m_packetInterface; }
+    RpcClient *rpcClient() const { return m_rpcClient; }
+    BulkTransfer *bulkTransfer() const { return m_bulkTransfer; }
+
+    /** Negotiated ATT MTU (23 until the exchange completes) */
+    int mtu() const { return m_mtu; }
+
+    /** Per-phase timing of the last connection setup */
+    QString setupSummary() const { return m_setup->summary(); }
+
+    /** Requested connection profile and the parameters actually granted */
+    QString connectionParametersSummary() const { return m_linkProfile->summary(); }
+
+    /** Link quality 0..100 from the filtered RSSI, and recent filtered RSSI samples */
+    int linkQuality() const { return m_rssiMonitor->linkQuality(); }
+    QList<int> rssiHistory() const { return m_rssiMonitor->history(); }
+
+    /** Notification rate, jitter and (with sequence numbers) loss on this link */
+    LinkStatistics linkStatistics() const { return m_linkMonitor->statistics(); }
+    QString linkStatisticsSummary() const { return m_linkMonitor->summary(); }
+
+    /** Ready, but no notification for StalenessMonitor::DEFAULT_TIMEOUT_MS */
+    bool isStale() const { return m_staleness->isStale(); }
+
 public slots:
-    void connectToDevice(const QBluetoothDeviceInfo &device);
+    void connectToDevice(const QBluetoothDeviceInfo &device,
+                         QLowEnergyController::RemoteAddressType addressType = QLowEnergyController::RandomAddress);
     void disconnect();
     void sendData(const QByteArray &data);
 
@@ -45,6 +82,8 @@ signals:
     void robotNameChanged();
     void robotAddressChanged();
     void rssiChanged();
+    void linkStatisticsChanged();
+    void staleChanged();
     void errorOccurred(const QString &error);
 
 private slots:
@@ -56,6 +95,9 @@ private slots:
     void onServiceStateChanged(QLowEnergyService::ServiceState state);
     void onCharacteristicChanged(const QLowEnergyCharacteristic &characteristic, const QByteArray &value);
     void onCharacteristicWritten(const QLowEnergyCharacteristic &characteristic, const QByteArray &value);
+    void onMtuChanged(int mtu);
+    void onSetupFinished(bool complete);
+    void onSetupTimedOut(GattSetupSequence::Phase phase);
 
 private:
     void setConnectionState(Robot::ConnectionState state);
@@ -64,8 +106,18 @@ private:
 
     QLowEnergyController *m_controller;
     QLowEnergyService *m_service;
+    GattOperationQueue *m_gattQueue;
+    GattSetupSequence *m_setup;
+    ConnectionProfileController *m_linkProfile;
+    RssiMonitor *m_rssiMonitor;
+    LinkQualityMonitor *m_linkMonitor;
+    StalenessMonitor *m_staleness;
     QLowEnergyCharacteristic m_rxCharacteristic;
     QLowEnergyCharacteristic m_txCharacteristic;
+    PacketInterface *m_packetInterface;
+    RpcClient *m_rpcClient;
+    BulkTransfer *m_bulkTransfer;
+    int m_mtu;
 
     Robot::ConnectionState m_connectionState;
     QString m_robotName;
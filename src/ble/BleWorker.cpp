@@ -0,0 +1,38 @@
+#include "BleWorker.h"
+#include "TimerWheel.h"
+#include "src/protocol/MonotonicClock.h"
+#include <QDebug>
+
+BleWorker::BleWorker(QObject *parent)
+    : QObject(parent)
+    , m_thread(new QThread(this))
+    , m_context(new QObject())
+    , m_timers(new TimerWheel())
+{
+    m_thread->setObjectName(QStringLiteral("BLE"));
+    m_context->moveToThread(m_thread);
+    m_timers->moveToThread(m_thread);
+    m_thread->start();
+}
+
+BleWorker::~BleWorker()
+{
+    // Queued behind disconnects and deleteLater()s posted during teardown
+    const qint64 startNs = MonotonicClock::nowNs();
+    QThread *thread = m_thread;
+    post([thread]() { thread->quit(); });
+    if (!m_thread->wait(3000)) {
+        qWarning() << "BleWorker: BLE thread did not stop in time";
+        return;
+    }
+    qDebug() << "BleWorker: BLE thread stopped in" << (MonotonicClock::nowNs() - startNs) / 1000000.0 << "ms";
+    // Deferred deletes ran as the thread finished, so no WheelTimer is left armed
+    delete m_timers;
+    delete m_context;
+}
+
+void BleWorker::adopt(QObject *object)
+{
+    Q_ASSERT(!object->parent());
+    object->moveToThread(m_thread);
+}
@@ -0,0 +1,80 @@
+#ifndef BLEWORKER_H
+#define BLEWORKER_H
+
+#include <QObject>
+#include <QThread>
+#include <QMetaObject>
+#include <utility>
+
+class TimerWheel;
+
+/**
+ * BleWorker - the thread the BLE stack runs on.
+ *
+ * Connections (controllers, GATT queues, parsers, monitors) and the
+ * discovery agent are moved here so notification handling and command
+ * writes never wait for a QML binding pass or layout on the GUI thread.
+ * Objects on the worker are only touched through post() and call();
+ * their state reaches the GUI thread as LinkDelta batches. Their poll
+ * ticks, timeouts and staleness deadlines share the worker's TimerWheel.
+ */
+class BleWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit BleWorker(QObject *parent = nullptr);
+
+    /** Runs everything already posted, then stops the thread */
+    ~BleWorker();
+
+    QThread *thread() const { return m_thread; }
+
+    /** Deadlines for objects on the worker; only used from the worker thread */
+    TimerWheel *timers() const { return m_timers; }
+
+    /** Move a parentless object (and its children) onto the worker thread */
+    void adopt(QObject *object);
+
+    /** Run a functor in the object's thread without waiting */
+    template <typename Functor>
+    static void post(QObject *object, Functor &&function)
+    {
+        QMetaObject::invokeMethod(object, std::forward<Functor>(function), Qt::QueuedConnection);
+    }
+
+    /** Run a functor on the worker thread, after everything already posted */
+    template <typename Functor>
+    void post(Functor &&function)
+    {
+        post(m_context, std::forward<Functor>(function));
+    }
+
+    /**
+     * Run a functor in the object's thread and wait for its result. Only for
+     * rare requests from the GUI (reports, RPC call ids); never from the worker.
+     */
+    template <typename Result, typename Functor>
+    static Result call(QObject *object, Functor &&function)
+    {
+        Result result{};
+        const Qt::ConnectionType type = object->thread() == QThread::currentThread()
+            ? Qt::DirectConnection : Qt::BlockingQueuedConnection;
+        QMetaObject::invokeMethod(object, std::forward<Functor>(function), type, &result);
+        return result;
+    }
+
+    /** Run a functor on the worker thread and wait for its result (see above) */
+    template <typename Result, typename Functor>
+    Result call(Functor &&function)
+    {
+        return call<Result>(m_context, std::forward<Functor>(function));
+    }
+
+private:
+    QThread *m_thread;
+    QObject *m_context;     // lives on the worker; orders the final quit after posted work
+    TimerWheel *m_timers;   // lives on the worker
+};
+
+#endif // BLEWORKER_H
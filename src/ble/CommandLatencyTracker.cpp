@@ -0,0 +1,168 @@
+#include "CommandLatencyTracker.h"
+#include "src/protocol/MonotonicClock.h"
+#include <QDebug>
+#include <QFile>
+#include <QTextStream>
+#include <algorithm>
+
+CommandLatencyTracker::CommandLatencyTracker(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void CommandLatencyTracker::begin(const QString &robot)
+{
+    RobotStats &stats = m_robots[robot];
+    if (stats.active) {
+        stats.abandoned++;
+    }
+
+    stats.stampNs.fill(-1);
+    stats.stampNs[Invoke] = MonotonicClock::nowNs();
+    stats.active = true;
+}
+
+void CommandLatencyTracker::mark(const QString &robot, Stage stage)
+{
+    mark(robot, stage, MonotonicClock::nowNs());
+}
+
+void CommandLatencyTracker::mark(const QString &robot, Stage stage, qint64 stampNs)
+{
+    auto it = m_robots.find(robot);
+    if (it == m_robots.end() || !checkDeadline(*it, MonotonicClock::nowNs()) || it->stampNs[stage] >= 0) {
+        return;
+    }
+
+    it->stampNs[stage] = stampNs;
+    if (stage == ModelUpdate) {
+        complete(*it);
+    }
+}
+
+bool CommandLatencyTracker::isWaitingFor(const QString &robot, Stage stage) const
+{
+    auto it = m_robots.constFind(robot);
+    return it != m_robots.constEnd() && it->active && it->stampNs[stage] < 0
+        && MonotonicClock::nowNs() - it->stampNs[Invoke] <= qint64(COMMAND_TIMEOUT_MS) * 1000000;
+}
+
+bool CommandLatencyTracker::checkDeadline(RobotStats &stats, qint64 nowNs)
+{
+    if (!stats.active) {
+        return false;
+    }
+    if (nowNs - stats.stampNs[Invoke] > qint64(COMMAND_TIMEOUT_MS) * 1000000) {
+        // Never confirmed (lost write, state never notified); a late change is not its answer
+        stats.active = false;
+        stats.abandoned++;
+        return false;
+    }
+    return true;
+}
+
+void CommandLatencyTracker::complete(RobotStats &stats)
+{
+    // Stages can be skipped (e.g. a notification overtaking the write response);
+    // charge the gap to the next stage that was reached
+    qint64 previous = stats.stampNs[Invoke];
+    for (int stage = Dispatch; stage < StageCount; ++stage) {
+        const qint64 stamp = stats.stampNs[stage];
+        if (stamp < 0) {
+            continue;
+        }
+        stats.stages[stage].record(std::max<qint64>(0, stamp - previous) / 1000);
+        previous = stamp;
+    }
+    stats.total.record((stats.stampNs[ModelUpdate] - stats.stampNs[Invoke]) / 1000);
+    stats.completed++;
+    stats.active = false;
+}
+
+void CommandLatencyTracker::reset()
+{
+    m_robots.clear();
+}
+
+LatencyHistogram CommandLatencyTracker::stageLatency(const QString &robot, Stage stage) const
+{
+    auto it = m_robots.constFind(robot);
+    return it != m_robots.constEnd() ? it->stages[stage] : LatencyHistogram();
+}
+
+LatencyHistogram CommandLatencyTracker::totalLatency(const QString &robot) const
+{
+    auto it = m_robots.constFind(robot);
+    return it != m_robots.constEnd() ? it->total : LatencyHistogram();
+}
+
+QString CommandLatencyTracker::report() const
+{
+    QStringList names = m_robots.keys();
+    std::sort(names.begin(), names.end());
+
+    QStringList lines;
+    for (const QString &name : std::as_const(names)) {
+        const RobotStats &stats = m_robots[name];
+        lines.append(QStringLiteral("%1 (%2 completed, %3 abandoned)")
+                         .arg(name).arg(stats.completed).arg(stats.abandoned));
+        for (int stage = Dispatch; stage < StageCount; ++stage) {
+            lines.append(QStringLiteral("  %1: %2")
+                             .arg(stageName(Stage(stage)), -12)
+                             .arg(stats.stages[stage].summary()));
+        }
+        lines.append(QStringLiteral("  %1: %2").arg(QStringLiteral("Total"), -12)
+                         .arg(stats.total.summary()));
+    }
+
+    if (lines.isEmpty()) {
+        return QStringLiteral("No commands timed yet");
+    }
+    return lines.join('\n');
+}
+
+bool CommandLatencyTracker::exportCsv(const QString &path) const
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        qWarning() << "CommandLatencyTracker: Cannot write" << path << file.errorString();
+        return false;
+    }
+
+    QTextStream out(&file);
+    out << "robot,stage,count,min_us,p50_us,p90_us,p99_us,max_us,mean_us\n";
+
+    auto writeRow = [&out](const QString &robot, const QString &stage,
+                           const LatencyHistogram &histogram) {
+        out << robot << ',' << stage << ',' << histogram.count() << ','
+            << histogram.min() << ',' << histogram.percentile(50) << ','
+            << histogram.percentile(90) << ',' << histogram.percentile(99) << ','
+            << histogram.max() << ',' << qRound64(histogram.mean()) << '\n';
+    };
+
+    QStringList names = m_robots.keys();
+    std::sort(names.begin(), names.end());
+    for (const QString &name : std::as_const(names)) {
+        const RobotStats &stats = m_robots[name];
+        for (int stage = Dispatch; stage < StageCount; ++stage) {
+            writeRow(name, stageName(Stage(stage)), stats.stages[stage]);
+        }
+        writeRow(name, QStringLiteral("Total"), stats.total);
+    }
+
+    qDebug() << "CommandLatencyTracker: Exported to" << path;
+    return true;
+}
+
+QString CommandLatencyTracker::stageName(Stage stage)
+{
+    switch (stage) {
+    case Invoke:      return QStringLiteral("Invoke");
+    case Dispatch:    return QStringLiteral("Dispatch");
+    case Write:       return QStringLiteral("Write");
+    case Ack:         return QStringLiteral("Ack");
+    case Notify:      return QStringLiteral("Notify");
+    case ModelUpdate: return QStringLiteral("ModelUpdate");
+    default:          return QStringLiteral("Unknown");
+    }
+}
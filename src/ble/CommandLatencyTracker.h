@@ -0,0 +1,97 @@
+#ifndef COMMANDLATENCYTRACKER_H
+#define COMMANDLATENCYTRACKER_H
+
+#include <QObject>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <array>
+#include "src/protocol/LatencyHistogram.h"
+
+/**
+ * CommandLatencyTracker - where the time goes between a button press and the
+ * robot's confirmation, per robot.
+ *
+ * A command is timestamped at each stage it passes:
+ *   Invoke      - the QML call enters BleConnectionManager
+ *   Dispatch    - posted to the robot's connection on the BLE thread
+ *   Write       - writeCharacteristic() issued to the BLE stack
+ *   Ack         - characteristicWritten (write response from the robot)
+ *   Notify      - the robot's notification with the new value
+ *   ModelUpdate - RobotListModel updated (QML sees the change)
+ *
+ * The time spent reaching each stage from the previous one goes into that
+ * stage's histogram, so GUI thread (Invoke..Dispatch), BLE thread hand-off
+ * (Dispatch..Write), BlueZ/radio (Write..Ack) and robot (Ack..Notify) costs
+ * can be told apart.
+ *
+ * One command per robot is tracked at a time; a newer command replaces an
+ * unfinished one, and one still open after COMMAND_TIMEOUT_MS is abandoned
+ * rather than completed by whatever the robot reports next.
+ */
+class CommandLatencyTracker : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Stage {
+        Invoke,
+        Dispatch,
+        Write,
+        Ack,
+        Notify,
+        ModelUpdate,
+        StageCount
+    };
+
+    static constexpr int COMMAND_TIMEOUT_MS = 5000;
+
+    explicit CommandLatencyTracker(QObject *parent = nullptr);
+
+    /** Start timing a command for a robot (Invoke stage) */
+    void begin(const QString &robot);
+
+    /** Timestamp a stage; later repeats (retries) keep the first timestamp */
+    void mark(const QString &robot, Stage stage);
+
+    /** Same, with a MonotonicClock stamp taken earlier (possibly on the BLE thread) */
+    void mark(const QString &robot, Stage stage, qint64 stampNs);
+
+    /** Whether a command for this robot is waiting for the given stage */
+    bool isWaitingFor(const QString &robot, Stage stage) const;
+
+    void reset();
+
+    QStringList robots() const { return m_robots.keys(); }
+
+    /** Time from the previous stage to this one */
+    LatencyHistogram stageLatency(const QString &robot, Stage stage) const;
+
+    /** Invoke to ModelUpdate */
+    LatencyHistogram totalLatency(const QString &robot) const;
+
+    /** Multi-line per-robot, per-stage summary */
+    QString report() const;
+
+    /** Write per-robot, per-stage percentiles as CSV */
+    bool exportCsv(const QString &path) const;
+
+    static QString stageName(Stage stage);
+
+private:
+    struct RobotStats {
+        std::array<qint64, StageCount> stampNs;     // MonotonicClock, -1 while not reached
+        bool active = false;
+        std::array<LatencyHistogram, StageCount> stages;
+        LatencyHistogram total;
+        int completed = 0;
+        int abandoned = 0;
+    };
+
+    void complete(RobotStats &stats);
+    /** Abandon the open command if its deadline passed; true if it is still open */
+    bool checkDeadline(RobotStats &stats, qint64 nowNs);
+    QHash<QString, RobotStats> m_robots;
+};
+
+#endif // COMMANDLATENCYTRACKER_H
@@ -0,0 +1,193 @@
+#include "ConnectionProfile.h"
+#include <QDebug>
+
+// ── ConnectionProfile ──
+
+QLowEnergyConnectionParameters ConnectionProfile::toParameters() const
+{
+    QLowEnergyConnectionParameters parameters;
+    parameters.setIntervalRange(minIntervalMs, maxIntervalMs);
+    parameters.setLatency(latency);
+    parameters.setSupervisionTimeout(supervisionTimeoutMs);
+    return parameters;
+}
+
+ConnectionProfile ConnectionProfile::forDevice(Robot::DeviceType type, Mode mode)
+{
+    ConnectionProfile profile;
+    profile.name = modeName(mode);
+
+    switch (type) {
+    case Robot::SmartBMS:
+        if (mode == Active) {
+            profile.minIntervalMs = 50.0;
+            profile.maxIntervalMs = 100.0;
+            profile.latency = 0;
+            profile.supervisionTimeoutMs = 4000;
+        } else {
+            profile.minIntervalMs = 100.0;
+            profile.maxIntervalMs = 200.0;
+            profile.latency = 4;
+            profile.supervisionTimeoutMs = 6000;
+        }
+        break;
+    case Robot::FalconsRobot:
+    case Robot::Unknown:
+    default:
+        if (mode == Active) {
+            profile.minIntervalMs = 7.5;
+            profile.maxIntervalMs = 15.0;
+            profile.latency = 0;
+            profile.supervisionTimeoutMs = 2000;
+        } else {
+            profile.minIntervalMs = 30.0;
+            profile.maxIntervalMs = 50.0;
+            profile.latency = 0;
+            profile.supervisionTimeoutMs = 4000;
+        }
+        break;
+    }
+
+    return profile;
+}
+
+QString ConnectionProfile::modeName(Mode mode)
+{
+    return mode == Active ? QStringLiteral("Active") : QStringLiteral("Idle");
+}
+
+// ── ConnectionProfileController ──
+
+ConnectionProfileController::ConnectionProfileController(Robot::DeviceType deviceType, TimerWheel *timers,
+                                                         QObject *parent)
+    : QObject(parent)
+    , m_deviceType(deviceType)
+    , m_holdTimer(timers)
+    , m_updateTimer(timers)
+    , m_mode(ConnectionProfile::Idle)
+    , m_requestedMode(ConnectionProfile::Idle)
+    , m_hasRequested(false)
+    , m_updatePending(false)
+    , m_hasGranted(false)
+{
+    m_holdTimer.setSingleShot(true);
+    m_holdTimer.callOnTimeout([this]() { onHoldExpired(); });
+
+    m_updateTimer.setSingleShot(true);
+    m_updateTimer.setInterval(UPDATE_TIMEOUT_MS);
+    m_updateTimer.callOnTimeout([this]() { onUpdateTimeout(); });
+}
+
+void ConnectionProfileController::setController(QLowEnergyController *controller)
+{
+    if (m_controller == controller) {
+        return;
+    }
+
+    if (m_controller) {
+        QObject::disconnect(m_controller, nullptr, this, nullptr);
+    }
+
+    m_controller = controller;
+    m_hasRequested = false;
+    m_updatePending = false;
+    m_hasGranted = false;
+    m_granted = QLowEnergyConnectionParameters();
+    m_holdTimer.stop();
+    m_updateTimer.stop();
+
+    if (m_controller) {
+        connect(m_controller, &QLowEnergyController::connectionUpdated,
+                this, &ConnectionProfileController::onConnectionUpdated);
+    }
+}
+
+void ConnectionProfileController::setMode(ConnectionProfile::Mode mode)
+{
+    m_holdTimer.stop();
+    m_mode = mode;
+    requestIfNeeded();
+}
+
+void ConnectionProfileController::boost(int holdMs)
+{
+    m_mode = ConnectionProfile::Active;
+    m_holdTimer.start(holdMs);
+    requestIfNeeded();
+}
+
+void ConnectionProfileController::onHoldExpired()
+{
+    m_mode = ConnectionProfile::Idle;
+    requestIfNeeded();
+}
+
+ConnectionProfile ConnectionProfileController::requestedProfile() const
+{
+    return ConnectionProfile::forDevice(m_deviceType, m_mode);
+}
+
+void ConnectionProfileController::requestIfNeeded()
+{
+    if (!m_controller || m_controller->state() == QLowEnergyController::UnconnectedState
+        || m_controller->state() == QLowEnergyController::ConnectingState) {
+        return;
+    }
+    if (m_updatePending || (m_hasRequested && m_requestedMode == m_mode)) {
+        return;
+    }
+
+    const ConnectionProfile profile = requestedProfile();
+    qDebug() << "ConnectionProfileController: Requesting" << profile.name
+             << profile.minIntervalMs << "-" << profile.maxIntervalMs << "ms latency"
+             << profile.latency << "timeout" << profile.supervisionTimeoutMs << "ms";
+
+    m_requestedMode = m_mode;
+    m_hasRequested = true;
+    m_updatePending = true;
+    m_updateTimer.start();
+    m_controller->requestConnectionUpdate(profile.toParameters());
+}
+
+void ConnectionProfileController::onConnectionUpdated(const QLowEnergyConnectionParameters &parameters)
+{
+    m_updatePending = false;
+    m_updateTimer.stop();
+    m_hasGranted = true;
+    m_granted = parameters;
+
+    qDebug() << "ConnectionProfileController: Granted interval"
+             << parameters.minimumInterval() << "ms latency" << parameters.latency()
+             << "timeout" << parameters.supervisionTimeout() << "ms";
+    emit parametersGranted(parameters);
+
+    // The mode may have changed while this update was in progress
+    requestIfNeeded();
+}
+
+void ConnectionProfileController::onUpdateTimeout()
+{
+    // Peripheral or stack ignored the request; allow the next one
+    qWarning() << "ConnectionProfileController: No connection update for"
+               << ConnectionProfile::modeName(m_requestedMode) << "request";
+    m_updatePending = false;
+    requestIfNeeded();
+}
+
+QString ConnectionProfileController::summary() const
+{
+    const ConnectionProfile profile = requestedProfile();
+    QString text = QStringLiteral("%1 (%2-%3 ms)")
+                       .arg(profile.name)
+                       .arg(profile.minIntervalMs)
+                       .arg(profile.maxIntervalMs);
+    if (m_hasGranted) {
+        text += QStringLiteral(" granted %1 ms lat %2 to %3 ms")
+                    .arg(m_granted.minimumInterval())
+                    .arg(m_granted.latency())
+                    .arg(m_granted.supervisionTimeout());
+    } else {
+        text += QStringLiteral(" not granted yet");
+    }
+    return text;
+}
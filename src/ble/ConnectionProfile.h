@@ -0,0 +1,104 @@
+#ifndef CONNECTIONPROFILE_H
+#define CONNECTIONPROFILE_H
+
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QLowEnergyController>
+#include <QLowEnergyConnectionParameters>
+#include "TimerWheel.h"
+#include "src/models/Robot.h"
+
+/**
+ * ConnectionProfile - requested BLE connection parameters for one device type
+ * in one mode.
+ *
+ *                 Idle                         Active
+ *   Falcons       30-50 ms, lat 0, 4 s         7.5-15 ms, lat 0, 2 s
+ *   SmartBMS      100-200 ms, lat 4, 6 s       50-100 ms, lat 0, 4 s
+ *   NUS/other     30-50 ms, lat 0, 4 s         7.5-15 ms, lat 0, 2 s
+ *
+ * Idle keeps a robot answerable within a few tens of ms while leaving
+ * airtime for the other links; Active is for command fan-outs, setup and
+ * bulk transfers. The BMS is only polled every 2 s, so it may sleep through
+ * connection events (slave latency).
+ */
+struct ConnectionProfile
+{
+    enum Mode {
+        Idle,
+        Active
+    };
+
+    QString name;
+    double minIntervalMs = 30.0;
+    double maxIntervalMs = 50.0;
+    int latency = 0;
+    int supervisionTimeoutMs = 4000;
+
+    QLowEnergyConnectionParameters toParameters() const;
+
+    static ConnectionProfile forDevice(Robot::DeviceType type, Mode mode);
+    static QString modeName(Mode mode);
+};
+
+/**
+ * ConnectionProfileController - applies ConnectionProfiles to one link.
+ *
+ * setMode() switches explicitly; boost() switches to Active and falls back
+ * to Idle once no boost has been requested for the hold time. Only one
+ * update request is outstanding at a time; a mode change while one is
+ * pending is sent when it completes. The parameters the peripheral actually
+ * granted are recorded from QLowEnergyController::connectionUpdated.
+ */
+class ConnectionProfileController : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int DEFAULT_HOLD_MS = 5000;
+    static constexpr int UPDATE_TIMEOUT_MS = 3000;
+
+    ConnectionProfileController(Robot::DeviceType deviceType, TimerWheel *timers, QObject *parent = nullptr);
+
+    /** Link the controller of a new connection (nullptr when it goes away) */
+    void setController(QLowEnergyController *controller);
+
+    void setMode(ConnectionProfile::Mode mode);
+    ConnectionProfile::Mode mode() const { return m_mode; }
+
+    /** Active now, back to Idle after holdMs without another boost */
+    void boost(int holdMs = DEFAULT_HOLD_MS);
+
+    ConnectionProfile requestedProfile() const;
+    bool hasGrantedParameters() const { return m_hasGranted; }
+    QLowEnergyConnectionParameters grantedParameters() const { return m_granted; }
+
+    /** "Active (7.5-15 ms) granted 15 ms lat 0 to 2000 ms" */
+    QString summary() const;
+
+signals:
+    void parametersGranted(const QLowEnergyConnectionParameters &parameters);
+
+private slots:
+    void onConnectionUpdated(const QLowEnergyConnectionParameters &parameters);
+    void onHoldExpired();
+    void onUpdateTimeout();
+
+private:
+    void requestIfNeeded();
+
+    Robot::DeviceType m_deviceType;
+    QPointer<QLowEnergyController> m_controller;
+    WheelTimer m_holdTimer;
+    WheelTimer m_updateTimer;
+
+    ConnectionProfile::Mode m_mode;
+    ConnectionProfile::Mode m_requestedMode;
+    bool m_hasRequested;
+    bool m_updatePending;
+    bool m_hasGranted;
+    QLowEnergyConnectionParameters m_granted;
+};
+
+#endif // CONNECTIONPROFILE_H
@@ -0,0 +1,87 @@
+#include "DiscoveryWorker.h"
+#include <QDebug>
+
+DiscoveryWorker::DiscoveryWorker(QObject *parent)
+    : QObject(parent)
+    , m_agent(nullptr)
+    , m_publishTimer(new QTimer(this))
+    , m_rawCount(0)
+{
+    m_publishTimer->setSingleShot(true);
+    connect(m_publishTimer, &QTimer::timeout, this, &DiscoveryWorker::publish);
+}
+
+DiscoveryWorker::~DiscoveryWorker()
+{
+    if (m_agent && m_agent->isActive()) {
+        m_agent->stop();
+    }
+}
+
+void DiscoveryWorker::start()
+{
+    if (!m_agent) {
+        m_agent = new QBluetoothDeviceDiscoveryAgent(this);
+        m_agent->setLowEnergyDiscoveryTimeout(0);
+
+        connect(m_agent, &QBluetoothDeviceDiscoveryAgent::deviceDiscovered,
+                this, &DiscoveryWorker::onDeviceDiscovered);
+        connect(m_agent, &QBluetoothDeviceDiscoveryAgent::deviceUpdated,
+                this, [this](const QBluetoothDeviceInfo &device) { onDeviceDiscovered(device); });
+        connect(m_agent, &QBluetoothDeviceDiscoveryAgent::finished,
+                this, &DiscoveryWorker::finished);
+        connect(m_agent, &QBluetoothDeviceDiscoveryAgent::errorOccurred,
+                this, &DiscoveryWorker::errorOccurred);
+    }
+
+    if (!m_agent->isActive()) {
+        m_agent->start(QBluetoothDeviceDiscoveryAgent::LowEnergyMethod);
+    }
+}
+
+void DiscoveryWorker::stop()
+{
+    if (m_agent && m_agent->isActive()) {
+        m_agent->stop();
+    }
+}
+
+void DiscoveryWorker::setPublishIntervalMs(int ms)
+{
+    m_publishTimer->setInterval(ms);
+}
+
+void DiscoveryWorker::resetIfLargerThan(int count)
+{
+    // The agent keeps every device it has seen since start(); restarting clears it
+    if (!m_agent || !m_agent->isActive() || m_agent->discoveredDevices().size() <= count) {
+        return;
+    }
+
+    qDebug() << "DiscoveryWorker: restarting discovery to reset the agent's device list";
+    m_agent->stop();
+    m_agent->start(QBluetoothDeviceDiscoveryAgent::LowEnergyMethod);
+}
+
+void DiscoveryWorker::onDeviceDiscovered(const QBluetoothDeviceInfo &device)
+{
+    // Only process Low Energy devices
+    if (!(device.coreConfigurations() & QBluetoothDeviceInfo::LowEnergyCoreConfiguration)) {
+        return;
+    }
+
+    // Keep only the latest report per device until the next publish
+    m_rawCount++;
+    m_pending.insert(device.address().toUInt64(), device);
+    if (!m_publishTimer->isActive()) {
+        m_publishTimer->start();
+    }
+}
+
+void DiscoveryWorker::publish()
+{
+    const QList<QBluetoothDeviceInfo> devices = m_pending.values();
+    m_pending.clear();
+    emit devicesReported(devices, m_rawCount);
+    m_rawCount = 0;
+}
@@ -0,0 +1,51 @@
+#ifndef DISCOVERYWORKER_H
+#define DISCOVERYWORKER_H
+
+#include <QObject>
+#include <QBluetoothDeviceDiscoveryAgent>
+#include <QBluetoothDeviceInfo>
+#include <QHash>
+#include <QList>
+#include <QTimer>
+
+/**
+ * DiscoveryWorker - the discovery agent, on the BLE worker thread.
+ *
+ * Advertisement reports are coalesced here (latest report per address) and
+ * handed to BleDeviceScanner as one batch per publish interval, so a busy
+ * venue costs the GUI thread a few batches a second instead of one queued
+ * call per advertisement.
+ */
+class DiscoveryWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DiscoveryWorker(QObject *parent = nullptr);
+    ~DiscoveryWorker();
+
+    void start();
+    void stop();
+    void setPublishIntervalMs(int ms);
+
+    /** Restart a running discovery once the agent holds more than `count` devices */
+    void resetIfLargerThan(int count);
+
+signals:
+    /** Latest report of each device heard since the last batch, and how many reports that was */
+    void devicesReported(const QList<QBluetoothDeviceInfo> &devices, qint64 rawCount);
+    void finished();
+    void errorOccurred(QBluetoothDeviceDiscoveryAgent::Error error);
+
+private slots:
+    void onDeviceDiscovered(const QBluetoothDeviceInfo &device);
+    void publish();
+
+private:
+    QBluetoothDeviceDiscoveryAgent *m_agent;    // created on first start(), on the worker
+    QTimer *m_publishTimer;
+    QHash<quint64, QBluetoothDeviceInfo> m_pending;
+    qint64 m_rawCount;
+};
+
+#endif // DISCOVERYWORKER_H
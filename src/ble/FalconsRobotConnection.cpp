@@ -16,20 +16,43 @@ const QBluetoothUuid FalconsRobotConnection::CHAR_BATTERY_VOLTAGE_UUID =
 const QBluetoothUuid FalconsRobotConnection::CHAR_ROBOT_IDENTITY_UUID =
     QBluetoothUuid(QStringLiteral("FA1C0006-B5A3-F393-E0A9-E50E24DCCA9E"));
 
-FalconsRobotConnection::FalconsRobotConnection(QObject *parent)
+FalconsRobotConnection::FalconsRobotConnection(TimerWheel *timers, QObject *parent)
     : QObject(parent)
     , m_controller(nullptr)
     , m_service(nullptr)
+    , m_gattQueue(new GattOperationQueue(timers, this))
+    , m_setup(new GattSetupSequence(m_gattQueue, timers, this))
+    , m_linkProfile(new ConnectionProfileController(Robot::FalconsRobot, timers, this))
+    , m_rssiMonitor(new RssiMonitor(m_gattQueue, timers, this))
+    , m_linkMonitor(new LinkQualityMonitor(timers, this))
+    , m_staleness(new StalenessMonitor(timers, this))
     , m_connectionState(Robot::Disconnected)
     , m_rssi(-100)
     , m_serviceFound(false)
     , m_playState(0)
     , m_batteryVoltage(0.0f)
 {
+    connect(m_gattQueue, &GattOperationQueue::characteristicWriteIssued, this,
+            [this](const QLowEnergyCharacteristic &characteristic, const QByteArray &value) {
+        emit writeIssued(characteristic.uuid(), value);
+    });
+    connect(m_setup, &GattSetupSequence::finished,
+            this, &FalconsRobotConnection::onSetupFinished);
+    connect(m_setup, &GattSetupSequence::timedOut,
+            this, &FalconsRobotConnection::onSetupTimedOut);
+    connect(m_rssiMonitor, &RssiMonitor::updated, this, [this]() {
+        m_rssi = m_rssiMonitor->rssi();
+        emit rssiChanged();
+    });
+    connect(m_linkMonitor, &LinkQualityMonitor::updated,
+            this, &FalconsRobotConnection::linkStatisticsChanged);
+    connect(m_staleness, &StalenessMonitor::staleChanged,
+            this, &FalconsRobotConnection::staleChanged);
 }
 
 FalconsRobotConnection::~FalconsRobotConnection()
 {
+    m_gattQueue->setService(nullptr);
     if (m_service) {
         delete m_service;
         m_service = nullptr;
@@ -53,7 +76,8 @@ bool FalconsRobotConnection::isFalconsDevice(const QBluetoothDeviceInfo &device)
     return device.name().startsWith("Falcons-");
 }
 
-void FalconsRobotConnection::connectToDevice(const QBluetoothDeviceInfo &device)
+void FalconsRobotConnection::connectToDevice(const QBluetoothDeviceInfo &device,
+                                             QLowEnergyController::RemoteAddressType addressType)
 {
     if (m_controller) {
         qWarning() << "FalconsRobotConnection: Already connected or connecting";
@@ -71,7 +95,10 @@ void FalconsRobotConnection::connectToDevice(const QBluetoothDeviceInfo &device)
     setConnectionState(Robot::Connecting);
 
     m_controller = QLowEnergyController::createCentral(device, this);
-    m_controller->setRemoteAddressType(QLowEnergyController::RandomAddress);
+
+    // On Linux without CAP_NET_ADMIN, BlueZ can't auto-detect address types;
+    // the caller passes the one remembered for this device (random if unknown)
+    m_controller->setRemoteAddressType(addressType);
 
     connect(m_controller, &QLowEnergyController::connected,
             this, &FalconsRobotConnection::onControllerConnected);
@@ -85,6 +112,9 @@ void FalconsRobotConnection::connectToDevice(const QBluetoothDeviceInfo &device)
             this, &FalconsRobotConnection::onDiscoveryFinished);
 
     qDebug() << "FalconsRobotConnection: Connecting to" << m_robotName << m_deviceAddress.toString();
+    m_linkProfile->setController(m_controller);
+    m_rssiMonitor->setController(m_controller);
+    m_setup->start(m_robotName);
     m_controller->connectToDevice();
 }
 
@@ -95,7 +125,7 @@ void FalconsRobotConnection::disconnect()
     }
 }
 
-void FalconsRobotConnection::writePlayState(int state)
+void FalconsRobotConnection::writePlayState(int state, GattOperationQueue::Priority priority)
 {
     if (!m_service || m_connectionState != Robot::Ready) {
         qWarning() << "FalconsRobotConnection: Cannot write play state, not ready";
@@ -108,8 +138,9 @@ void FalconsRobotConnection::writePlayState(int state)
     }
 
     QByteArray data(1, static_cast<char>(state));
-    m_service->writeCharacteristic(m_playStateChar, data);
-    qDebug() << "FalconsRobotConnection: Writing play state:" << state;
+    m_gattQueue->writeCharacteristic(m_playStateChar, data, priority);
+    qDebug() << "FalconsRobotConnection: Writing play state:" << state
+             << (priority == GattOperationQueue::Emergency ? "(emergency)" : "");
 }
 
 void FalconsRobotConnection::writeWifiSsid(const QString &ssid)
@@ -125,23 +156,36 @@ void FalconsRobotConnection::writeWifiSsid(const QString &ssid)
     }
 
     QByteArray data = ssid.toUtf8();
-    m_service->writeCharacteristic(m_wifiSsidChar, data);
+    m_gattQueue->writeCharacteristic(m_wifiSsidChar, data, GattOperationQueue::Control);
     qDebug() << "FalconsRobotConnection: Writing WiFi SSID:" << ssid;
 }
 
+void FalconsRobotConnection::boostConnection(int holdMs)
+{
+    m_linkProfile->boost(holdMs);
+}
+
 void FalconsRobotConnection::onControllerConnected()
 {
     qDebug() << "FalconsRobotConnection: Controller connected, discovering services...";
     setConnectionState(Robot::Connected);
     m_serviceFound = false;
+    m_setup->beginPhase(GattSetupSequence::Discovery);
+    m_linkProfile->setMode(ConnectionProfile::Active);     // short interval for setup
+    m_linkMonitor->start();
     m_controller->discoverServices();
 }
 
 void FalconsRobotConnection::onControllerDisconnected()
 {
     qDebug() << "FalconsRobotConnection: Controller disconnected";
+    m_setup->abort();
+    m_rssiMonitor->stop();
+    m_linkMonitor->stop();
+    m_staleness->stop();
     setConnectionState(Robot::Disconnected);
 
+    m_gattQueue->setService(nullptr);
     if (m_service) {
         delete m_service;
         m_service = nullptr;
@@ -150,8 +194,18 @@ void FalconsRobotConnection::onControllerDisconnected()
 
 void FalconsRobotConnection::onControllerError(QLowEnergyController::Error error)
 {
+    if (error == QLowEnergyController::RssiReadError) {
+        // Only the periodic RSSI sample failed; the link itself is fine
+        m_rssiMonitor->handleReadError();
+        return;
+    }
+
     QString errorString = m_controller->errorString();
     qWarning() << "FalconsRobotConnection: Controller error:" << error << errorString;
+    m_setup->abort();
+    m_rssiMonitor->stop();
+    m_linkMonitor->stop();
+    m_staleness->stop();
     setError(errorString);
     setConnectionState(Robot::Error);
 }
@@ -196,23 +250,15 @@ void FalconsRobotConnection::setupService()
             this, &FalconsRobotConnection::onCharacteristicChanged);
     connect(m_service, &QLowEnergyService::characteristicRead,
             this, &FalconsRobotConnection::onCharacteristicRead);
+    connect(m_service, &QLowEnergyService::characteristicWritten,
+            this, &FalconsRobotConnection::onCharacteristicWritten);
+    m_gattQueue->setService(m_service);
 
     qDebug() << "FalconsRobotConnection: Discovering service details...";
+    m_setup->beginPhase(GattSetupSequence::ServiceDetails);
     m_service->discoverDetails();
 }
 
-void FalconsRobotConnection::enableNotifications(const QLowEnergyCharacteristic &characteristic)
-{
-    if (!characteristic.isValid()) return;
-
-    QLowEnergyDescriptor cccd = characteristic.descriptor(
-        QBluetoothUuid::DescriptorType::ClientCharacteristicConfiguration);
-
-    if (cccd.isValid()) {
-        m_service->writeDescriptor(cccd, QByteArray::fromHex("0100"));
-    }
-}
-
 void FalconsRobotConnection::onServiceStateChanged(QLowEnergyService::ServiceState state)
 {
     qDebug() << "FalconsRobotConnection: Service state changed:" << state;
@@ -225,35 +271,42 @@ void FalconsRobotConnection::onServiceStateChanged(QLowEnergyService::ServiceSta
         m_batteryVoltageChar = m_service->characteristic(CHAR_BATTERY_VOLTAGE_UUID);
         m_robotIdentityChar  = m_service->characteristic(CHAR_ROBOT_IDENTITY_UUID);
 
-        // Enable notifications on all characteristics
-        enableNotifications(m_playStateChar);
-        enableNotifications(m_wifiSsidChar);
-        enableNotifications(m_wifiListChar);
-        enableNotifications(m_batteryVoltageChar);
-        enableNotifications(m_robotIdentityChar);
+        // Subscribe to everything, and hold Ready until every value is in once.
+        // Reads for values a notification delivers first are skipped.
+        const QList<QLowEnergyCharacteristic> characteristics = {
+            m_playStateChar, m_wifiSsidChar, m_wifiListChar,
+            m_batteryVoltageChar, m_robotIdentityChar
+        };
 
-        // Read initial values
-        readAllCharacteristics();
-
-        setConnectionState(Robot::Ready);
-        qDebug() << "FalconsRobotConnection: Connection ready!";
+        m_setup->beginPhase(GattSetupSequence::Subscribe);
+        for (const QLowEnergyCharacteristic &characteristic : characteristics) {
+            m_setup->subscribe(characteristic);
+        }
+        for (const QLowEnergyCharacteristic &characteristic : characteristics) {
+            m_setup->requireValue(characteristic);
+        }
+        m_setup->commit();
     }
 }
 
-void FalconsRobotConnection::readAllCharacteristics()
+void FalconsRobotConnection::onSetupFinished(bool complete)
+{
+    Q_UNUSED(complete)
+    setConnectionState(Robot::Ready);
+    m_linkProfile->boost();                                 // relax once setup traffic is over
+    m_rssiMonitor->start(m_rssi);
+    m_staleness->start();
+    qDebug() << "FalconsRobotConnection: Connection ready!" << m_setup->summary();
+}
+
+void FalconsRobotConnection::onSetupTimedOut(GattSetupSequence::Phase phase)
 {
-    if (!m_service) return;
-
-    if (m_playStateChar.isValid())
-        m_service->readCharacteristic(m_playStateChar);
-    if (m_wifiSsidChar.isValid())
-        m_service->readCharacteristic(m_wifiSsidChar);
-    if (m_wifiListChar.isValid())
-        m_service->readCharacteristic(m_wifiListChar);
-    if (m_batteryVoltageChar.isValid())
-        m_service->readCharacteristic(m_batteryVoltageChar);
-    if (m_robotIdentityChar.isValid())
-        m_service->readCharacteristic(m_robotIdentityChar);
+    m_linkMonitor->stop();
+    setError(QStringLiteral("Connection setup timed out (%1)").arg(GattSetupSequence::phaseName(phase)));
+    setConnectionState(Robot::Error);
+    if (m_controller) {
+        m_controller->disconnectFromDevice();
+    }
 }
 
 void FalconsRobotConnection::onCharacteristicChanged(
@@ -261,20 +314,50 @@ void FalconsRobotConnection::onCharacteristicChanged(
     const QByteArray &value)
 {
     QBluetoothUuid uuid = characteristic.uuid();
+    m_linkMonitor->notificationReceived(uuid);
+    m_staleness->dataReceived();
+    recordSequence(uuid, value);
+    handleValue(uuid, value);
+}
 
+void FalconsRobotConnection::onCharacteristicRead(
+    const QLowEnergyCharacteristic &characteristic,
+    const QByteArray &value)
+{
+    // Same handling as notification, but not part of the notification statistics
+    handleValue(characteristic.uuid(), value);
+}
+
+void FalconsRobotConnection::handleValue(const QBluetoothUuid &uuid, const QByteArray &value)
+{
     if (uuid == CHAR_PLAY_STATE_UUID)           parsePlayState(value);
     else if (uuid == CHAR_WIFI_SSID_UUID)       parseWifiSsid(value);
     else if (uuid == CHAR_WIFI_LIST_UUID)        parseWifiList(value);
     else if (uuid == CHAR_BATTERY_VOLTAGE_UUID)  parseBatteryVoltage(value);
     else if (uuid == CHAR_ROBOT_IDENTITY_UUID)   parseRobotIdentity(value);
+
+    m_setup->valueReceived(uuid);
 }
 
-void FalconsRobotConnection::onCharacteristicRead(
+void FalconsRobotConnection::recordSequence(const QBluetoothUuid &uuid, const QByteArray &value)
+{
+    // Fixed-size values with two extra bytes carry a sequence number
+    int payloadSize = -1;
+    if (uuid == CHAR_PLAY_STATE_UUID)           payloadSize = 1;
+    else if (uuid == CHAR_BATTERY_VOLTAGE_UUID) payloadSize = 4;
+
+    if (payloadSize < 0 || value.size() != payloadSize + 2) return;
+
+    quint16 sequence = static_cast<uint8_t>(value[payloadSize]) |
+                       (static_cast<uint8_t>(value[payloadSize + 1]) << 8);
+    m_linkMonitor->sequenceReceived(uuid, sequence);
+}
+
+void FalconsRobotConnection::onCharacteristicWritten(
     const QLowEnergyCharacteristic &characteristic,
     const QByteArray &value)
 {
-    // Same handling as notification
-    onCharacteristicChanged(characteristic, value);
+    emit writeAcknowledged(characteristic.uuid(), value);
 }
 
 void FalconsRobotConnection::parsePlayState(const QByteArray &value)
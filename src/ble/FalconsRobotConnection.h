@@ -8,6 +8,12 @@
 #include <QBluetoothUuid>
 #include <QTimer>
 #include "src/models/Robot.h"
+#include "GattOperationQueue.h"
+#include "GattSetupSequence.h"
+#include "ConnectionProfile.h"
+#include "RssiMonitor.h"
+#include "LinkQualityMonitor.h"
+#include "StalenessMonitor.h"
 
 /**
  * FalconsRobotConnection - BLE central connection to a Falcons football robot.
@@ -19,6 +25,10 @@
  *   - WiFi list (read/notify)
  *   - Battery voltage (read/notify)
  *   - Robot identity (read/notify)
+ *
+ * Play state and battery voltage notifications may carry a trailing 16-bit
+ * little-endian sequence number (per characteristic); it is fed to the link
+ * monitor for loss and reordering statistics and ignored by the parsers.
  */
 class FalconsRobotConnection : public QObject
 {
@@ -28,6 +38,7 @@ class FalconsRobotConnection : public QObject
     Q_PROPERTY(QString robotAddress READ robotAddress NOTIFY robotAddressChanged)
     Q_PROPERTY(int rssi READ rssi NOTIFY rssiChanged)
     Q_PROPERTY(QString lastError READ lastError NOTIFY errorOccurred)
+    Q_PROPERTY(bool stale READ isStale NOTIFY staleChanged)
     Q_PROPERTY(int playState READ playState NOTIFY playStateChanged)
     Q_PROPERTY(QString wifiSsid READ wifiSsid NOTIFY wifiSsidChanged)
     Q_PROPERTY(QStringList wifiList READ wifiList NOTIFY wifiListChanged)
@@ -43,7 +54,7 @@ public:
     static const QBluetoothUuid CHAR_BATTERY_VOLTAGE_UUID;
     static const QBluetoothUuid CHAR_ROBOT_IDENTITY_UUID;
 
-    explicit FalconsRobotConnection(QObject *parent = nullptr);
+    explicit FalconsRobotConnection(TimerWheel *timers, QObject *parent = nullptr);
     ~FalconsRobotConnection();
 
     Robot::ConnectionState connectionState() const { return m_connectionState; }
@@ -59,23 +70,50 @@ public:
 
     QBluetoothAddress deviceAddress() const { return m_deviceAddress; }
 
+    /** Per-phase timing of the last connection setup */
+    QString setupSummary() const { return m_setup->summary(); }
+
+    /** Requested connection profile and the parameters actually granted */
+    QString connectionParametersSummary() const { return m_linkProfile->summary(); }
+
+    /** Link quality 0..100 from the filtered RSSI, and recent filtered RSSI samples */
+    int linkQuality() const { return m_rssiMonitor->linkQuality(); }
+    QList<int> rssiHistory() const { return m_rssiMonitor->history(); }
+
+    /** Notification rate, jitter and (with sequence numbers) loss on this link */
+    LinkStatistics linkStatistics() const { return m_linkMonitor->statistics(); }
+    QString linkStatisticsSummary() const { return m_linkMonitor->summary(); }
+
+    /** Ready, but no notification for StalenessMonitor::DEFAULT_TIMEOUT_MS */
+    bool isStale() const { return m_staleness->isStale(); }
+
     static bool isFalconsDevice(const QBluetoothDeviceInfo &device);
 
 public slots:
-    void connectToDevice(const QBluetoothDeviceInfo &device);
+    void connectToDevice(const QBluetoothDeviceInfo &device,
+                         QLowEnergyController::RemoteAddressType addressType = QLowEnergyController::RandomAddress);
     void disconnect();
 
-    /** Write a new play state to the robot (0=INVALID, 1=SW_ON, 2=MOT_ON, 3=KICK_ON, 4=INPLAY) */
-    void writePlayState(int state);
+    /**
+     * Write a new play state to the robot (0=INVALID, 1=SW_ON, 2=MOT_ON, 3=KICK_ON, 4=INPLAY).
+     * Emergency priority jumps ahead of queued reads and setup traffic.
+     */
+    void writePlayState(int state,
+                        GattOperationQueue::Priority priority = GattOperationQueue::Control);
 
     /** Write a new WiFi SSID to the robot (triggers wifi switch) */
     void writeWifiSsid(const QString &ssid);
 
+    /** Short connection interval for a while (command bursts); relaxes when idle */
+    void boostConnection(int holdMs = ConnectionProfileController::DEFAULT_HOLD_MS);
+
 signals:
     void connectionStateChanged();
     void robotNameChanged();
     void robotAddressChanged();
     void rssiChanged();
+    void linkStatisticsChanged();
+    void staleChanged();
     void errorOccurred(const QString &error);
     void playStateChanged();
     void wifiSsidChanged();
@@ -86,6 +124,12 @@ signals:
     /** Emitted whenever any robot data is updated (for model refresh) */
     void robotDataUpdated();
 
+    /** A write was handed to the BLE stack (after queueing) */
+    void writeIssued(const QBluetoothUuid &uuid, const QByteArray &value);
+
+    /** The robot acknowledged a write (GATT write response) */
+    void writeAcknowledged(const QBluetoothUuid &uuid, const QByteArray &value);
+
 private slots:
     void onControllerConnected();
     void onControllerDisconnected();
@@ -97,13 +141,17 @@ private slots:
                                  const QByteArray &value);
     void onCharacteristicRead(const QLowEnergyCharacteristic &characteristic,
                               const QByteArray &value);
+    void onCharacteristicWritten(const QLowEnergyCharacteristic &characteristic,
+                                 const QByteArray &value);
+    void onSetupFinished(bool complete);
+    void onSetupTimedOut(GattSetupSequence::Phase phase);
 
 private:
     void setConnectionState(Robot::ConnectionState state);
     void setError(const QString &error);
     void setupService();
-    void enableNotifications(const QLowEnergyCharacteristic &characteristic);
-    void readAllCharacteristics();
+    void handleValue(const QBluetoothUuid &uuid, const QByteArray &value);
+    void recordSequence(const QBluetoothUuid &uuid, const QByteArray &value);
     void parsePlayState(const QByteArray &value);
     void parseWifiSsid(const QByteArray &value);
     void parseWifiList(const QByteArray &value);
@@ -112,6 +160,12 @@ private:
 
     QLowEnergyController *m_controller;
     QLowEnergyService *m_service;
+    GattOperationQueue *m_gattQueue;
+    GattSetupSequence *m_setup;
+    ConnectionProfileController *m_linkProfile;
+    RssiMonitor *m_rssiMonitor;
+    LinkQualityMonitor *m_linkMonitor;
+    StalenessMonitor *m_staleness;
 
     QLowEnergyCharacteristic m_playStateChar;
     QLowEnergyCharacteristic m_wifiSsidChar;
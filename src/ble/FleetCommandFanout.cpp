@@ -0,0 +1,353 @@
+#include "FleetCommandFanout.h"
+#include <QDebug>
+#include <QVariantMap>
+#include <algorithm>
+
+FleetCommandFanout::FleetCommandFanout(QObject *parent)
+    : QObject(parent)
+    , m_command(NoCommand)
+    , m_playState(0)
+    , m_active(false)
+    , m_deadlineUs(0)
+    , m_finishedUs(-1)
+    , m_tickTimer(new QTimer(this))
+{
+    m_tickTimer->setInterval(TICK_MS);
+    connect(m_tickTimer, &QTimer::timeout, this, &FleetCommandFanout::onTick);
+}
+
+void FleetCommandFanout::startPlayState(const QList<FleetTarget> &targets, int state,
+                                        int deadlineMs)
+{
+    m_playState = state;
+    m_characteristicUuid = FalconsRobotConnection::CHAR_PLAY_STATE_UUID;
+    m_value = QByteArray(1, static_cast<char>(state));
+    begin(PlayState, targets, deadlineMs);
+}
+
+void FleetCommandFanout::startWifiSsid(const QList<FleetTarget> &targets,
+                                       const QString &ssid, int deadlineMs)
+{
+    m_ssid = ssid;
+    m_characteristicUuid = FalconsRobotConnection::CHAR_WIFI_SSID_UUID;
+    m_value = ssid.toUtf8();
+    begin(WifiSsid, targets, deadlineMs);
+}
+
+void FleetCommandFanout::begin(Command command, const QList<FleetTarget> &targets,
+                               int deadlineMs)
+{
+    // A new command supersedes whatever is still being tracked
+    if (m_active) {
+        cancel();
+    }
+    m_targets.clear();
+    m_indexByAddress.clear();
+
+    m_command = command;
+    m_clock.start();
+    m_deadlineUs = qint64(deadlineMs) * 1000;
+    m_finishedUs = -1;
+    m_active = true;
+
+    for (const FleetTarget &robot : targets) {
+        Target target;
+        target.name = robot.name;
+        target.address = robot.address;
+        target.playState = robot.playState;
+        target.wifiSsid = robot.wifiSsid;
+        m_indexByAddress.insert(target.address, m_targets.size());
+        m_targets.append(target);
+    }
+
+    qDebug() << "FleetCommandFanout:" << commandName() << "to" << m_targets.size() << "robot(s)";
+
+    // Short connection interval for the command and its retries/confirmations
+    for (const Target &target : std::as_const(m_targets)) {
+        emit boostRequested(target.address);
+    }
+    for (Target &target : m_targets) {
+        issue(target);
+    }
+
+    m_tickTimer->start();
+    emit progressChanged();
+    finishIfDone();
+}
+
+void FleetCommandFanout::issue(Target &target)
+{
+    if (target.linkState != Robot::Ready) {
+        fail(target, QStringLiteral("not connected"));
+        return;
+    }
+
+    target.attempts++;
+    target.lastIssuedUs = nowUs();
+    emit writeRequested(target.address);
+}
+
+void FleetCommandFanout::cancel()
+{
+    if (!m_active) {
+        return;
+    }
+
+    for (Target &target : m_targets) {
+        if (target.status != Confirmed && target.status != Failed) {
+            fail(target, QStringLiteral("cancelled"));
+        }
+    }
+    finish();
+}
+
+bool FleetCommandFanout::isConfirmedBy(const Target &target) const
+{
+    if (m_command == PlayState) {
+        return target.playState == m_playState;
+    }
+    return target.wifiSsid == m_ssid;
+}
+
+void FleetCommandFanout::checkConfirmed(Target &target)
+{
+    // The robot's notified value is the confirmation; before the write response it may
+    // still be the old value, so only trust it once the robot has seen our write
+    if (target.status != Acknowledged) {
+        return;
+    }
+    if (isConfirmedBy(target)) {
+        target.status = Confirmed;
+        target.confirmUs = nowUs();
+    }
+}
+
+void FleetCommandFanout::fail(Target &target, const QString &error)
+{
+    target.status = Failed;
+    target.error = error;
+}
+
+void FleetCommandFanout::writeAcknowledged(const QString &address, const QBluetoothUuid &uuid,
+                                           const QByteArray &value)
+{
+    if (!m_active || uuid != m_characteristicUuid || value != m_value) {
+        return;
+    }
+
+    const int index = indexOf(address);
+    if (index < 0) {
+        return;
+    }
+
+    Target &target = m_targets[index];
+    if (target.status == Pending) {
+        target.status = Acknowledged;
+        target.ackUs = nowUs();
+        checkConfirmed(target);
+        emit progressChanged();
+        finishIfDone();
+    }
+}
+
+void FleetCommandFanout::playStateNotified(const QString &address, int state)
+{
+    const int index = indexOf(address);
+    if (index < 0) {
+        return;
+    }
+
+    m_targets[index].playState = state;
+    if (m_active && m_command == PlayState) {
+        valueNotified(m_targets[index]);
+    }
+}
+
+void FleetCommandFanout::wifiSsidNotified(const QString &address, const QString &ssid)
+{
+    const int index = indexOf(address);
+    if (index < 0) {
+        return;
+    }
+
+    m_targets[index].wifiSsid = ssid;
+    if (m_active && m_command == WifiSsid) {
+        valueNotified(m_targets[index]);
+    }
+}
+
+void FleetCommandFanout::valueNotified(Target &target)
+{
+    if (target.status == Pending && isConfirmedBy(target)) {
+        // Notification overtook the write response
+        target.status = Acknowledged;
+        target.ackUs = nowUs();
+    }
+    checkConfirmed(target);
+    emit progressChanged();
+    finishIfDone();
+}
+
+void FleetCommandFanout::linkStateChanged(const QString &address, Robot::ConnectionState state)
+{
+    const int index = indexOf(address);
+    if (index < 0) {
+        return;
+    }
+
+    Target &target = m_targets[index];
+    target.linkState = state;
+    if (m_active && state != Robot::Ready
+        && target.status != Confirmed && target.status != Failed) {
+        fail(target, QStringLiteral("link lost"));
+        emit progressChanged();
+        finishIfDone();
+    }
+}
+
+void FleetCommandFanout::onTick()
+{
+    if (!m_active) {
+        m_tickTimer->stop();
+        return;
+    }
+
+    const qint64 now = nowUs();
+    const bool pastDeadline = now >= m_deadlineUs;
+
+    for (Target &target : m_targets) {
+        if (target.status == Confirmed || target.status == Failed) {
+            continue;
+        }
+        if (target.linkState != Robot::Ready) {
+            fail(target, QStringLiteral("link lost"));
+        } else if (pastDeadline) {
+            fail(target, target.status == Acknowledged ? QStringLiteral("not confirmed")
+                                                       : QStringLiteral("no response"));
+        } else if (now - target.lastIssuedUs >= qint64(RETRY_INTERVAL_MS) * 1000) {
+            if (target.attempts < MAX_ATTEMPTS) {
+                qDebug() << "FleetCommandFanout: Retrying" << target.name
+                         << "attempt" << target.attempts + 1;
+                target.status = Pending;
+                issue(target);
+            } else {
+                fail(target, QStringLiteral("retries exhausted"));
+            }
+        }
+    }
+
+    emit progressChanged();
+    finishIfDone();
+}
+
+void FleetCommandFanout::finishIfDone()
+{
+    if (!m_active) {
+        return;
+    }
+    for (const Target &target : std::as_const(m_targets)) {
+        if (target.status != Confirmed && target.status != Failed) {
+            return;
+        }
+    }
+    finish();
+}
+
+void FleetCommandFanout::finish()
+{
+    m_active = false;
+    m_tickTimer->stop();
+
+    // Report the time to the last confirmation, not to when we noticed the failures
+    qint64 lastConfirmUs = 0;
+    for (const Target &target : std::as_const(m_targets)) {
+        lastConfirmUs = std::max(lastConfirmUs, target.confirmUs);
+    }
+    const int confirmed = confirmedCount();
+    const int total = m_targets.size();
+    m_finishedUs = confirmed == total ? lastConfirmUs : nowUs();
+
+    if (confirmed == total) {
+        qDebug() << "FleetCommandFanout:" << commandName() << "confirmed by" << total
+                 << "robot(s) in" << elapsedMs() << "ms";
+    } else {
+        qWarning() << "FleetCommandFanout:" << commandName() << "confirmed by"
+                   << confirmed << "/" << total << "robot(s)";
+        for (const Target &target : std::as_const(m_targets)) {
+            if (target.status == Failed) {
+                qWarning() << "  " << target.name << target.error;
+            }
+        }
+    }
+
+    emit progressChanged();
+    emit finished(confirmed == total, confirmed, total, elapsedMs());
+}
+
+int FleetCommandFanout::indexOf(const QString &address) const
+{
+    // Called for every link event while a command is tracked
+    return m_indexByAddress.value(address, -1);
+}
+
+int FleetCommandFanout::countStatus(RobotStatus status) const
+{
+    int count = 0;
+    for (const Target &target : m_targets) {
+        if (target.status == status) {
+            count++;
+        }
+    }
+    return count;
+}
+
+int FleetCommandFanout::acknowledgedCount() const
+{
+    return countStatus(Acknowledged) + countStatus(Confirmed);
+}
+
+double FleetCommandFanout::elapsedMs() const
+{
+    if (m_command == NoCommand) {
+        return 0.0;
+    }
+    const qint64 us = m_active ? nowUs() : m_finishedUs;
+    return us / 1000.0;
+}
+
+QString FleetCommandFanout::commandName() const
+{
+    switch (m_command) {
+    case PlayState: return QStringLiteral("Play state %1").arg(m_playState);
+    case WifiSsid:  return QStringLiteral("WiFi \"%1\"").arg(m_ssid);
+    default:        return QString();
+    }
+}
+
+QVariantList FleetCommandFanout::results() const
+{
+    QVariantList list;
+    for (const Target &target : m_targets) {
+        QVariantMap entry;
+        entry["name"] = target.name;
+        entry["address"] = target.address;
+        entry["status"] = statusToString(target.status);
+        entry["attempts"] = target.attempts;
+        entry["ackMs"] = target.ackUs >= 0 ? target.ackUs / 1000.0 : -1.0;
+        entry["confirmMs"] = target.confirmUs >= 0 ? target.confirmUs / 1000.0 : -1.0;
+        entry["error"] = target.error;
+        list.append(entry);
+    }
+    return list;
+}
+
+QString FleetCommandFanout::statusToString(RobotStatus status)
+{
+    switch (status) {
+    case Pending:      return QStringLiteral("Pending");
+    case Acknowledged: return QStringLiteral("Acknowledged");
+    case Confirmed:    return QStringLiteral("Confirmed");
+    case Failed:       return QStringLiteral("Failed");
+    default:           return QStringLiteral("Unknown");
+    }
+}
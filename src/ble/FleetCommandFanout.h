@@ -0,0 +1,163 @@
+#ifndef FLEETCOMMANDFANOUT_H
+#define FLEETCOMMANDFANOUT_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QVariantList>
+#include "FalconsRobotConnection.h"
+
+/** A robot a fleet command goes to, with its values when the command starts */
+struct FleetTarget {
+    QString address;
+    QString name;
+    int playState = 0;
+    QString wifiSsid;
+};
+
+/**
+ * FleetCommandFanout - issue one command to a set of Falcons robots at once
+ * and track each robot until it is confirmed.
+ *
+ * Every target goes through:
+ *   Pending      - write issued, no response yet
+ *   Acknowledged - GATT write response received
+ *   Confirmed    - the robot reports the new value (notification)
+ *   Failed       - deadline passed, retries exhausted or link lost
+ *
+ * Robots that have not confirmed after RETRY_INTERVAL_MS get the write again,
+ * up to MAX_ATTEMPTS, as long as the deadline allows. Latencies are measured
+ * from the start of the command.
+ *
+ * The fan-out never touches connections (they live on the BLE thread): it
+ * asks for writes through writeRequested() and is told about responses,
+ * notifications and link changes by the connection manager.
+ */
+class FleetCommandFanout : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool active READ isActive NOTIFY progressChanged)
+    Q_PROPERTY(QString commandName READ commandName NOTIFY progressChanged)
+    Q_PROPERTY(int totalCount READ totalCount NOTIFY progressChanged)
+    Q_PROPERTY(int acknowledgedCount READ acknowledgedCount NOTIFY progressChanged)
+    Q_PROPERTY(int confirmedCount READ confirmedCount NOTIFY progressChanged)
+    Q_PROPERTY(int failedCount READ failedCount NOTIFY progressChanged)
+    Q_PROPERTY(double elapsedMs READ elapsedMs NOTIFY progressChanged)
+    Q_PROPERTY(QVariantList results READ results NOTIFY progressChanged)
+
+public:
+    enum Command {
+        NoCommand,
+        PlayState,
+        WifiSsid
+    };
+    Q_ENUM(Command)
+
+    enum RobotStatus {
+        Pending,
+        Acknowledged,
+        Confirmed,
+        Failed
+    };
+    Q_ENUM(RobotStatus)
+
+    static constexpr int DEFAULT_DEADLINE_MS = 2000;
+    static constexpr int RETRY_INTERVAL_MS = 400;
+    static constexpr int MAX_ATTEMPTS = 3;
+    static constexpr int TICK_MS = 50;
+
+    explicit FleetCommandFanout(QObject *parent = nullptr);
+
+    /** Set the play state on every target (emergency lane) */
+    void startPlayState(const QList<FleetTarget> &targets, int state,
+                        int deadlineMs = DEFAULT_DEADLINE_MS);
+
+    /** Switch every target to a WiFi network */
+    void startWifiSsid(const QList<FleetTarget> &targets, const QString &ssid,
+                       int deadlineMs = DEFAULT_DEADLINE_MS);
+
+    // Robot events, fed by the connection manager
+    void writeAcknowledged(const QString &address, const QBluetoothUuid &uuid, const QByteArray &value);
+    void playStateNotified(const QString &address, int state);
+    void wifiSsidNotified(const QString &address, const QString &ssid);
+    void linkStateChanged(const QString &address, Robot::ConnectionState state);
+
+    /** Stop tracking; unconfirmed robots are reported as failed */
+    Q_INVOKABLE void cancel();
+
+    bool isActive() const { return m_active; }
+    Command command() const { return m_command; }
+    int playState() const { return m_playState; }
+    QString ssid() const { return m_ssid; }
+    QString commandName() const;
+    int totalCount() const { return m_targets.size(); }
+    int acknowledgedCount() const;
+    int confirmedCount() const { return countStatus(Confirmed); }
+    int failedCount() const { return countStatus(Failed); }
+
+    /** Time since start, or start to last confirmation once finished */
+    double elapsedMs() const;
+
+    /** One map per robot: name, address, status, attempts, ackMs, confirmMs, error */
+    QVariantList results() const;
+
+    static QString statusToString(RobotStatus status);
+
+signals:
+    void progressChanged();
+    void finished(bool success, int confirmed, int total, double elapsedMs);
+
+    /** Write the current command to a robot (play state on the emergency lane) */
+    void writeRequested(const QString &address);
+
+    /** Shorten a robot's connection interval for the command and its retries */
+    void boostRequested(const QString &address);
+
+private slots:
+    void onTick();
+
+private:
+    struct Target {
+        QString name;
+        QString address;
+        Robot::ConnectionState linkState = Robot::Ready;
+        int playState = 0;
+        QString wifiSsid;
+        RobotStatus status = Pending;
+        int attempts = 0;
+        qint64 lastIssuedUs = 0;
+        qint64 ackUs = -1;
+        qint64 confirmUs = -1;
+        QString error;
+    };
+
+    void begin(Command command, const QList<FleetTarget> &targets, int deadlineMs);
+    void issue(Target &target);
+    bool isConfirmedBy(const Target &target) const;
+    void valueNotified(Target &target);
+    void checkConfirmed(Target &target);
+    void fail(Target &target, const QString &error);
+    void finishIfDone();
+    void finish();
+    int indexOf(const QString &address) const;
+    int countStatus(RobotStatus status) const;
+    qint64 nowUs() const { return m_clock.nsecsElapsed() / 1000; }
+
+    QList<Target> m_targets;
+    QHash<QString, int> m_indexByAddress;
+    Command m_command;
+    QBluetoothUuid m_characteristicUuid;
+    QByteArray m_value;
+    int m_playState;
+    QString m_ssid;
+
+    bool m_active;
+    QElapsedTimer m_clock;
+    qint64 m_deadlineUs;
+    qint64 m_finishedUs;
+    QTimer *m_tickTimer;
+};
+
+#endif // FLEETCOMMANDFANOUT_H
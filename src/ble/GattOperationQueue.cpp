@@ -0,0 +1,323 @@
+#include "GattOperationQueue.h"
+#include <QDebug>
+#include <algorithm>
+
+// The batch and tick follow the link: one event's worth per interval
+static_assert(GattOperationQueue::pacingFor(15.0, 23).batch == 4
+              && GattOperationQueue::pacingFor(15.0, 23).intervalMs == 15);
+static_assert(GattOperationQueue::pacingFor(50.0, 247).batch == 4
+              && GattOperationQueue::pacingFor(50.0, 247).intervalMs == 50);
+static_assert(GattOperationQueue::pacingFor(7.5, 247).batch == 8
+              && GattOperationQueue::pacingFor(7.5, 247).intervalMs == 15);
+static_assert(GattOperationQueue::pacingFor(11.25, 23).intervalMs == 12);
+static_assert(GattOperationQueue::pacingFor(30.0, 512).batch == 1);
+static_assert(GattOperationQueue::pacingFor(0.0, 0).batch == 4
+              && GattOperationQueue::pacingFor(0.0, 0).intervalMs == 15);
+
+GattOperationQueue::GattOperationQueue(TimerWheel *timers, QObject *parent)
+    : QObject(parent)
+    , m_service(nullptr)
+    , m_inFlight(false)
+    , m_timeoutTimer(timers)
+    , m_pacingTimer(new QTimer(this))
+    , m_unackedThisTick(0)
+    , m_connectionIntervalMs(DEFAULT_INTERVAL_MS)
+    , m_mtu(DEFAULT_MTU)
+    , m_pacing(pacingFor(DEFAULT_INTERVAL_MS, DEFAULT_MTU))
+{
+    m_timeoutTimer.setSingleShot(true);
+    m_timeoutTimer.setInterval(OPERATION_TIMEOUT_MS);
+    m_timeoutTimer.callOnTimeout([this]() { onOperationTimeout(); });
+
+    m_pacingTimer->setSingleShot(true);
+    m_pacingTimer->setInterval(m_pacing.intervalMs);
+    connect(m_pacingTimer, &QTimer::timeout, this, [this]() {
+        m_unackedThisTick = 0;
+        dispatchNext();
+    });
+}
+
+void GattOperationQueue::setService(QLowEnergyService *service)
+{
+    if (m_service == service) {
+        return;
+    }
+
+    if (m_service) {
+        QObject::disconnect(m_service, nullptr, this, nullptr);
+    }
+    clear();
+    m_service = service;
+
+    if (!m_service) {
+        // The next link negotiates its own interval and MTU
+        m_connectionIntervalMs = DEFAULT_INTERVAL_MS;
+        m_mtu = DEFAULT_MTU;
+        updatePacing();
+        return;
+    }
+
+    connect(m_service, &QLowEnergyService::characteristicWritten,
+            this, &GattOperationQueue::onCharacteristicWritten);
+    connect(m_service, &QLowEnergyService::characteristicRead,
+            this, &GattOperationQueue::onCharacteristicRead);
+    connect(m_service, &QLowEnergyService::descriptorWritten,
+            this, &GattOperationQueue::onDescriptorWritten);
+    connect(m_service, &QLowEnergyService::errorOccurred,
+            this, &GattOperationQueue::onServiceError);
+}
+
+void GattOperationQueue::writeCharacteristic(const QLowEnergyCharacteristic &characteristic,
+                                             const QByteArray &value, Priority priority,
+                                             QLowEnergyService::WriteMode mode)
+{
+    Operation operation;
+    operation.type = mode == QLowEnergyService::WriteWithoutResponse
+                         ? CharacteristicWriteNoResponse : CharacteristicWrite;
+    operation.characteristic = characteristic;
+    operation.value = value;
+    enqueue(priority, std::move(operation));
+}
+
+void GattOperationQueue::readCharacteristic(const QLowEnergyCharacteristic &characteristic,
+                                            Priority priority)
+{
+    Operation operation;
+    operation.type = CharacteristicRead;
+    operation.characteristic = characteristic;
+    enqueue(priority, std::move(operation));
+}
+
+void GattOperationQueue::writeDescriptor(const QLowEnergyDescriptor &descriptor,
+                                         const QByteArray &value, Priority priority)
+{
+    Operation operation;
+    operation.type = DescriptorWrite;
+    operation.descriptor = descriptor;
+    operation.value = value;
+    enqueue(priority, std::move(operation));
+}
+
+bool GattOperationQueue::cancelQueuedRead(const QLowEnergyCharacteristic &characteristic)
+{
+    for (QQueue<Operation> &lane : m_lanes) {
+        for (int i = 0; i < lane.size(); ++i) {
+            if (lane.at(i).type == CharacteristicRead && lane.at(i).characteristic == characteristic) {
+                lane.removeAt(i);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void GattOperationQueue::clearLane(Priority priority)
+{
+    m_lanes[priority].clear();
+}
+
+void GattOperationQueue::clear()
+{
+    for (QQueue<Operation> &lane : m_lanes) {
+        lane.clear();
+    }
+    m_emergencyInFlight.clear();
+    m_inFlight = false;
+    m_current = Operation();
+    m_unackedThisTick = 0;
+    m_timeoutTimer.stop();
+    m_pacingTimer->stop();
+}
+
+void GattOperationQueue::setConnectionInterval(double ms)
+{
+    m_connectionIntervalMs = ms;
+    updatePacing();
+}
+
+void GattOperationQueue::setMtu(int mtu)
+{
+    m_mtu = mtu;
+    updatePacing();
+}
+
+void GattOperationQueue::updatePacing()
+{
+    m_pacing = pacingFor(m_connectionIntervalMs, m_mtu);
+    m_pacingTimer->setInterval(m_pacing.intervalMs);
+}
+
+int GattOperationQueue::pendingCount() const
+{
+    int count = 0;
+    for (const QQueue<Operation> &lane : m_lanes) {
+        count += lane.size();
+    }
+    return count;
+}
+
+void GattOperationQueue::enqueue(Priority priority, Operation &&operation)
+{
+    if (!m_service) {
+        qWarning() << "GattOperationQueue: No service, dropping operation";
+        return;
+    }
+
+    if (priority == Emergency) {
+        // Straight to the stack: at most the one operation already in flight is ahead of it
+        issue(operation);
+        if (operation.type != CharacteristicWriteNoResponse) {
+            m_emergencyInFlight.append(std::move(operation));
+        }
+        return;
+    }
+
+    m_lanes[priority].enqueue(std::move(operation));
+    dispatchNext();
+}
+
+void GattOperationQueue::issue(const Operation &operation)
+{
+    switch (operation.type) {
+    case CharacteristicWrite:
+        m_service->writeCharacteristic(operation.characteristic, operation.value,
+                                       QLowEnergyService::WriteWithResponse);
+        break;
+    case CharacteristicWriteNoResponse:
+        m_service->writeCharacteristic(operation.characteristic, operation.value,
+                                       QLowEnergyService::WriteWithoutResponse);
+        break;
+    case CharacteristicRead:
+        m_service->readCharacteristic(operation.characteristic);
+        break;
+    case DescriptorWrite:
+        m_service->writeDescriptor(operation.descriptor, operation.value);
+        break;
+    }
+
+    if (operation.type == CharacteristicWrite || operation.type == CharacteristicWriteNoResponse) {
+        emit characteristicWriteIssued(operation.characteristic, operation.value);
+    }
+}
+
+void GattOperationQueue::dispatchNext()
+{
+    if (!m_service) {
+        return;
+    }
+
+    while (!m_inFlight) {
+        QQueue<Operation> *lane = nullptr;
+        for (int p = Control; p < LANE_COUNT; ++p) {
+            if (!m_lanes[p].isEmpty()) {
+                lane = &m_lanes[p];
+                break;
+            }
+        }
+        if (!lane) {
+            return;
+        }
+
+        if (lane->head().type == CharacteristicWriteNoResponse) {
+            // No completion signal for these; pace them so higher lanes can cut in
+            if (m_unackedThisTick >= m_pacing.batch) {
+                if (!m_pacingTimer->isActive()) {
+                    m_pacingTimer->start();
+                }
+                return;
+            }
+            issue(lane->dequeue());
+            if (m_unackedThisTick++ == 0 && !m_pacingTimer->isActive()) {
+                m_pacingTimer->start();
+            }
+            continue;
+        }
+
+        m_current = lane->dequeue();
+        m_inFlight = true;
+        m_timeoutTimer.start();
+        issue(m_current);
+    }
+}
+
+void GattOperationQueue::completeCurrent()
+{
+    m_inFlight = false;
+    m_current = Operation();
+    m_timeoutTimer.stop();
+    dispatchNext();
+}
+
+bool GattOperationQueue::takeEmergency(const QBluetoothUuid &uuid, bool isDescriptor)
+{
+    for (int i = 0; i < m_emergencyInFlight.size(); ++i) {
+        const Operation &op = m_emergencyInFlight.at(i);
+        const bool match = isDescriptor
+            ? (op.type == DescriptorWrite && op.descriptor.uuid() == uuid)
+            : (op.type != DescriptorWrite && op.characteristic.uuid() == uuid);
+        if (match) {
+            m_emergencyInFlight.removeAt(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+void GattOperationQueue::onCharacteristicWritten(const QLowEnergyCharacteristic &characteristic,
+                                                 const QByteArray &value)
+{
+    Q_UNUSED(value)
+
+    // Qt completes requests in issue order, so the in-flight operation goes first
+    if (m_inFlight && m_current.type == CharacteristicWrite && m_current.characteristic == characteristic) {
+        completeCurrent();
+        return;
+    }
+    takeEmergency(characteristic.uuid(), false);
+}
+
+void GattOperationQueue::onCharacteristicRead(const QLowEnergyCharacteristic &characteristic,
+                                              const QByteArray &value)
+{
+    Q_UNUSED(value)
+
+    // Qt completes requests in issue order, so the in-flight operation goes first
+    if (m_inFlight && m_current.type == CharacteristicRead && m_current.characteristic == characteristic) {
+        completeCurrent();
+        return;
+    }
+    takeEmergency(characteristic.uuid(), false);
+}
+
+void GattOperationQueue::onDescriptorWritten(const QLowEnergyDescriptor &descriptor,
+                                             const QByteArray &value)
+{
+    Q_UNUSED(value)
+
+    if (m_inFlight && m_current.type == DescriptorWrite && m_current.descriptor == descriptor) {
+        completeCurrent();
+        return;
+    }
+    takeEmergency(descriptor.uuid(), true);
+}
+
+void GattOperationQueue::onServiceError(QLowEnergyService::ServiceError error)
+{
+    qWarning() << "GattOperationQueue: Operation failed:" << error;
+
+    // The stack does not say which request failed; in-flight work is the only candidate
+    if (m_inFlight) {
+        completeCurrent();
+    } else if (!m_emergencyInFlight.isEmpty()) {
+        m_emergencyInFlight.removeFirst();
+    }
+}
+
+void GattOperationQueue::onOperationTimeout()
+{
+    if (!m_inFlight) {
+        return;
+    }
+    qWarning() << "GattOperationQueue: No completion for operation, moving on";
+    completeCurrent();
+}
@@ -0,0 +1,154 @@
+#ifndef GATTOPERATIONQUEUE_H
+#define GATTOPERATIONQUEUE_H
+
+#include <QObject>
+#include <QLowEnergyService>
+#include <QLowEnergyCharacteristic>
+#include <QLowEnergyDescriptor>
+#include <QQueue>
+#include <QList>
+#include <QPointer>
+#include <QTimer>
+#include <algorithm>
+#include <array>
+#include "TimerWheel.h"
+
+/**
+ * GattOperationQueue - prioritised outbound GATT operations for one service.
+ *
+ * QLowEnergyService queues every request FIFO, so a stop command issued after
+ * a burst of polls or NUS chunks waits behind all of them. This queue keeps
+ * at most one acknowledged operation (and one paced batch of unacknowledged
+ * writes) inside Qt at a time and picks the next one by lane:
+ *
+ *   Emergency - safety commands; bypass the in-flight slot and go out at once
+ *   Control   - state changes, configuration, setup
+ *   Bulk      - polls, reads, NUS data
+ *
+ * Unacknowledged writes go out in batches sized to what one connection event
+ * carries, one batch per connection interval; the owner feeds in the granted
+ * interval and the ATT MTU so the pacing follows the link.
+ */
+class GattOperationQueue : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Priority {
+        Emergency,
+        Control,
+        Bulk
+    };
+
+    static constexpr int LANE_COUNT = 3;
+    static constexpr int WRITES_PER_EVENT = 4;          // write-without-response per connection event
+    static constexpr int EVENT_PAYLOAD_BYTES = WRITES_PER_EVENT * 251;  // four full-length LE PDUs
+    static constexpr int MIN_PACING_MS = 10;            // shorter intervals are paced two events a tick
+    static constexpr int DEFAULT_MTU = 23;
+    static constexpr double DEFAULT_INTERVAL_MS = 15.0;
+    static constexpr int OPERATION_TIMEOUT_MS = 3000;
+
+    /** Unacknowledged writes per pacing tick, and the tick */
+    struct Pacing {
+        int batch;
+        int intervalMs;
+    };
+
+    /** Pacing for a connection interval and ATT MTU (defaults if either is unknown) */
+    static constexpr Pacing pacingFor(double connectionIntervalMs, int attMtu)
+    {
+        if (connectionIntervalMs <= 0.0 || attMtu <= 0) {
+            return pacingFor(DEFAULT_INTERVAL_MS, DEFAULT_MTU);
+        }
+        int events = 1;
+        while (events * connectionIntervalMs < MIN_PACING_MS) {
+            ++events;
+        }
+        const double tickMs = events * connectionIntervalMs;
+        const int intervalMs = int(tickMs) + (tickMs > int(tickMs) ? 1 : 0);
+        const int perEvent = std::clamp(EVENT_PAYLOAD_BYTES / attMtu, 1, WRITES_PER_EVENT);
+        return { perEvent * events, intervalMs };
+    }
+
+    explicit GattOperationQueue(TimerWheel *timers, QObject *parent = nullptr);
+
+    /** Attach to a service (nullptr detaches and drops everything queued) */
+    void setService(QLowEnergyService *service);
+    QLowEnergyService *service() const { return m_service; }
+
+    void writeCharacteristic(const QLowEnergyCharacteristic &characteristic, const QByteArray &value,
+                             Priority priority,
+                             QLowEnergyService::WriteMode mode = QLowEnergyService::WriteWithResponse);
+    void readCharacteristic(const QLowEnergyCharacteristic &characteristic, Priority priority);
+    void writeDescriptor(const QLowEnergyDescriptor &descriptor, const QByteArray &value,
+                         Priority priority);
+
+    /** Drop a read that has not been issued yet; returns false if none was queued */
+    bool cancelQueuedRead(const QLowEnergyCharacteristic &characteristic);
+
+    /** Drop queued operations of one lane (e.g. stale polls after a reconnect) */
+    void clearLane(Priority priority);
+    void clear();
+
+    /** Granted connection interval in ms; re-paces unacknowledged writes */
+    void setConnectionInterval(double ms);
+
+    /** Negotiated ATT MTU; larger writes mean fewer per connection event */
+    void setMtu(int mtu);
+
+    Pacing pacing() const { return m_pacing; }
+
+    int pendingCount(Priority priority) const { return m_lanes[priority].size(); }
+    int pendingCount() const;
+    bool isIdle() const { return !m_inFlight && pendingCount() == 0; }
+
+signals:
+    /** A characteristic write left the queue and was handed to the BLE stack */
+    void characteristicWriteIssued(const QLowEnergyCharacteristic &characteristic,
+                                   const QByteArray &value);
+
+private slots:
+    void onCharacteristicWritten(const QLowEnergyCharacteristic &characteristic, const QByteArray &value);
+    void onCharacteristicRead(const QLowEnergyCharacteristic &characteristic, const QByteArray &value);
+    void onDescriptorWritten(const QLowEnergyDescriptor &descriptor, const QByteArray &value);
+    void onServiceError(QLowEnergyService::ServiceError error);
+    void onOperationTimeout();
+    void dispatchNext();
+
+private:
+    enum OperationType {
+        CharacteristicWrite,
+        CharacteristicWriteNoResponse,
+        CharacteristicRead,
+        DescriptorWrite
+    };
+
+    struct Operation {
+        OperationType type = CharacteristicWrite;
+        QLowEnergyCharacteristic characteristic;
+        QLowEnergyDescriptor descriptor;
+        QByteArray value;
+    };
+
+    void enqueue(Priority priority, Operation &&operation);
+    void updatePacing();
+    void issue(const Operation &operation);
+    void completeCurrent();
+    bool takeEmergency(const QBluetoothUuid &uuid, bool isDescriptor);
+
+    QPointer<QLowEnergyService> m_service;
+    std::array<QQueue<Operation>, LANE_COUNT> m_lanes;
+
+    bool m_inFlight;
+    Operation m_current;
+    QList<Operation> m_emergencyInFlight;
+
+    WheelTimer m_timeoutTimer;
+    QTimer *m_pacingTimer;          // finer than the wheel's tick
+    int m_unackedThisTick;
+    double m_connectionIntervalMs;
+    int m_mtu;
+    Pacing m_pacing;
+};
+
+#endif // GATTOPERATIONQUEUE_H
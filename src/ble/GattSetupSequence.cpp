@@ -0,0 +1,265 @@
+#include "GattSetupSequence.h"
+#include "GattOperationQueue.h"
+#include <QDebug>
+#include <QStringList>
+
+GattSetupSequence::GattSetupSequence(GattOperationQueue *queue, TimerWheel *timers, QObject *parent)
+    : QObject(parent)
+    , m_queue(queue)
+    , m_snapshotTimer(timers)
+    , m_phaseTimer(timers)
+    , m_running(false)
+    , m_committed(false)
+    , m_phase(Connect)
+    , m_phaseStartUs(0)
+    , m_readsQueued(0)
+    , m_readsSkipped(0)
+{
+    m_phaseUs.fill(0);
+
+    m_snapshotTimer.setSingleShot(true);
+    m_snapshotTimer.setInterval(SNAPSHOT_TIMEOUT_MS);
+    m_snapshotTimer.callOnTimeout([this]() { onSnapshotTimeout(); });
+
+    m_phaseTimer.setSingleShot(true);
+    m_phaseTimer.setInterval(PHASE_TIMEOUT_MS);
+    m_phaseTimer.callOnTimeout([this]() { onPhaseTimeout(); });
+}
+
+void GattSetupSequence::start(const QString &deviceName)
+{
+    abort();
+
+    m_deviceName = deviceName;
+    m_phaseUs.fill(0);
+    m_readsQueued = 0;
+    m_readsSkipped = 0;
+    m_committed = false;
+    m_running = true;
+
+    m_clock.start();
+    m_phase = Connect;
+    m_phaseStartUs = 0;
+    m_phaseTimer.start();
+}
+
+void GattSetupSequence::beginPhase(Phase phase)
+{
+    if (!m_running || phase <= m_phase) {
+        return;
+    }
+
+    const qint64 now = nowUs();
+    m_phaseUs[m_phase] = now - m_phaseStartUs;
+    m_phase = phase;
+    m_phaseStartUs = now;
+
+    // After commit() the snapshot timeout covers the rest
+    if (!m_committed) {
+        m_phaseTimer.start();
+    }
+}
+
+void GattSetupSequence::subscribe(const QLowEnergyCharacteristic &characteristic)
+{
+    if (!m_running || !characteristic.isValid()) {
+        return;
+    }
+
+    const QLowEnergyDescriptor cccd = characteristic.descriptor(
+        QBluetoothUuid::DescriptorType::ClientCharacteristicConfiguration);
+    if (!cccd.isValid()) {
+        qWarning() << "GattSetupSequence:" << m_deviceName << "no CCCD on"
+                   << characteristic.uuid().toString();
+        return;
+    }
+
+    if (QLowEnergyService *service = m_queue->service()) {
+        connect(service, &QLowEnergyService::descriptorWritten,
+                this, &GattSetupSequence::onDescriptorWritten, Qt::UniqueConnection);
+    }
+
+    const bool indicate = !(characteristic.properties() & QLowEnergyCharacteristic::Notify)
+                          && (characteristic.properties() & QLowEnergyCharacteristic::Indicate);
+    m_pendingSubscriptions.append(cccd);
+    m_queue->writeDescriptor(cccd, QByteArray::fromHex(indicate ? "0200" : "0100"),
+                             GattOperationQueue::Control);
+}
+
+void GattSetupSequence::requireValue(const QLowEnergyCharacteristic &characteristic)
+{
+    if (!m_running || !characteristic.isValid()) {
+        return;
+    }
+
+    m_missingValues.insert(characteristic.uuid(), characteristic);
+
+    // Queued behind the subscriptions (Bulk lane); dropped if a notification gets there first
+    if (characteristic.properties() & QLowEnergyCharacteristic::Read) {
+        m_queue->readCharacteristic(characteristic, GattOperationQueue::Bulk);
+        m_readsQueued++;
+    }
+}
+
+void GattSetupSequence::requireItem(const QString &item)
+{
+    if (m_running) {
+        m_missingItems.insert(item);
+    }
+}
+
+void GattSetupSequence::commit()
+{
+    if (!m_running) {
+        return;
+    }
+
+    m_committed = true;
+    m_phaseTimer.stop();
+    m_snapshotTimer.start();
+    checkProgress();
+}
+
+void GattSetupSequence::valueReceived(const QBluetoothUuid &uuid)
+{
+    if (!m_running) {
+        return;
+    }
+
+    auto it = m_missingValues.find(uuid);
+    if (it == m_missingValues.end()) {
+        return;
+    }
+
+    if (m_queue->cancelQueuedRead(it.value())) {
+        m_readsSkipped++;
+    }
+    m_missingValues.erase(it);
+    checkProgress();
+}
+
+void GattSetupSequence::itemReceived(const QString &item)
+{
+    if (m_running && m_missingItems.remove(item)) {
+        checkProgress();
+    }
+}
+
+void GattSetupSequence::onDescriptorWritten(const QLowEnergyDescriptor &descriptor,
+                                            const QByteArray &value)
+{
+    Q_UNUSED(value)
+
+    if (m_running && m_pendingSubscriptions.removeOne(descriptor)) {
+        checkProgress();
+    }
+}
+
+void GattSetupSequence::checkProgress()
+{
+    if (!m_committed) {
+        return;
+    }
+
+    if (m_phase == Subscribe && m_pendingSubscriptions.isEmpty()) {
+        beginPhase(Snapshot);
+    }
+
+    if (m_pendingSubscriptions.isEmpty() && m_missingValues.isEmpty() && m_missingItems.isEmpty()) {
+        finish(true);
+    }
+}
+
+void GattSetupSequence::onSnapshotTimeout()
+{
+    if (!m_running) {
+        return;
+    }
+
+    QStringList missing = m_missingItems.values();
+    for (const QBluetoothUuid &uuid : m_missingValues.keys()) {
+        missing.append(uuid.toString());
+    }
+    qWarning() << "GattSetupSequence:" << m_deviceName << "snapshot incomplete after"
+               << SNAPSHOT_TIMEOUT_MS << "ms;" << m_pendingSubscriptions.size()
+               << "subscription(s) pending, missing:" << missing;
+
+    beginPhase(Snapshot);
+    finish(false);
+}
+
+void GattSetupSequence::onPhaseTimeout()
+{
+    if (!m_running || m_committed) {
+        return;
+    }
+
+    const Phase phase = m_phase;
+    qWarning() << "GattSetupSequence:" << m_deviceName << phaseName(phase) << "phase still open after"
+               << PHASE_TIMEOUT_MS << "ms, giving up";
+    abort();
+    emit timedOut(phase);
+}
+
+void GattSetupSequence::finish(bool complete)
+{
+    // Close the last phase
+    m_phaseUs[m_phase] = nowUs() - m_phaseStartUs;
+    m_phaseStartUs = nowUs();
+
+    m_running = false;
+    m_committed = false;
+    m_snapshotTimer.stop();
+    m_phaseTimer.stop();
+    m_pendingSubscriptions.clear();
+    m_missingValues.clear();
+    m_missingItems.clear();
+
+    qDebug() << "GattSetupSequence:" << m_deviceName << "ready -" << summary();
+    emit finished(complete);
+}
+
+void GattSetupSequence::abort()
+{
+    m_running = false;
+    m_committed = false;
+    m_snapshotTimer.stop();
+    m_phaseTimer.stop();
+    m_pendingSubscriptions.clear();
+    m_missingValues.clear();
+    m_missingItems.clear();
+}
+
+qint64 GattSetupSequence::totalMs() const
+{
+    qint64 total = 0;
+    for (qint64 us : m_phaseUs) {
+        total += us;
+    }
+    return total / 1000;
+}
+
+QString GattSetupSequence::summary() const
+{
+    QStringList parts;
+    for (int phase = Connect; phase < PhaseCount; ++phase) {
+        parts.append(QStringLiteral("%1 %2 ms").arg(phaseName(Phase(phase))).arg(phaseMs(Phase(phase))));
+    }
+    return QStringLiteral("%1, total %2 ms (%3 read(s), %4 skipped)")
+        .arg(parts.join(QStringLiteral(", ")))
+        .arg(totalMs())
+        .arg(readsIssued())
+        .arg(m_readsSkipped);
+}
+
+QString GattSetupSequence::phaseName(Phase phase)
+{
+    switch (phase) {
+    case Connect:        return QStringLiteral("connect");
+    case Discovery:      return QStringLiteral("discovery");
+    case ServiceDetails: return QStringLiteral("details");
+    case Subscribe:      return QStringLiteral("subscribe");
+    case Snapshot:       return QStringLiteral("snapshot");
+    default:             return QStringLiteral("unknown");
+    }
+}
@@ -0,0 +1,125 @@
+#ifndef GATTSETUPSEQUENCE_H
+#define GATTSETUPSEQUENCE_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QSet>
+#include <QLowEnergyCharacteristic>
+#include <QLowEnergyDescriptor>
+#include <QList>
+#include <array>
+#include "TimerWheel.h"
+
+class GattOperationQueue;
+
+/**
+ * GattSetupSequence - ordered connection setup with a "first snapshot" gate.
+ *
+ * A connection declares what its setup needs once service details are known:
+ * the notifications to subscribe to and the values (or named items, e.g. a
+ * BMS frame) that make up a full state snapshot. The sequence pushes all
+ * subscriptions through the Control lane and the initial reads through the
+ * Bulk lane of the connection's GattOperationQueue, so they are pipelined
+ * without waiting on each other. A read still queued when a notification
+ * delivers its value is dropped.
+ *
+ * finished() fires once every subscription is acknowledged and every
+ * required value has arrived (or after SNAPSHOT_TIMEOUT_MS with whatever
+ * is in), so the connection only reports Ready with real data. A phase
+ * before that which takes longer than PHASE_TIMEOUT_MS (a connect or
+ * discovery that never completes) ends the attempt with timedOut(). Time
+ * spent in each phase is recorded for the setup summary.
+ */
+class GattSetupSequence : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Phase {
+        Connect,            // connectToDevice() -> link up
+        Discovery,          // service discovery
+        ServiceDetails,     // characteristic/descriptor discovery
+        Subscribe,          // CCCD writes acknowledged
+        Snapshot,           // remaining first values arrived
+        PhaseCount
+    };
+
+    static constexpr int SNAPSHOT_TIMEOUT_MS = 3000;
+    static constexpr int PHASE_TIMEOUT_MS = 15000;
+
+    GattSetupSequence(GattOperationQueue *queue, TimerWheel *timers, QObject *parent = nullptr);
+
+    /** Start timing a new connection attempt (Connect phase) */
+    void start(const QString &deviceName);
+
+    /** Close the current phase and open the next one */
+    void beginPhase(Phase phase);
+
+    /** Enable notifications (or indications) on a characteristic */
+    void subscribe(const QLowEnergyCharacteristic &characteristic);
+
+    /** The snapshot needs this characteristic's value; read it unless a notification brings it */
+    void requireValue(const QLowEnergyCharacteristic &characteristic);
+
+    /** The snapshot needs an item the connection reports itself via itemReceived() */
+    void requireItem(const QString &item);
+
+    /** Everything is declared; run until the snapshot is complete */
+    void commit();
+
+    /** Feed every value the connection receives (notification or read) */
+    void valueReceived(const QBluetoothUuid &uuid);
+    void itemReceived(const QString &item);
+
+    /** Stop without finishing (link lost, error) */
+    void abort();
+
+    bool isRunning() const { return m_running; }
+    qint64 phaseMs(Phase phase) const { return m_phaseUs[phase] / 1000; }
+    qint64 totalMs() const;
+    int readsIssued() const { return m_readsQueued - m_readsSkipped; }
+    int readsSkipped() const { return m_readsSkipped; }
+
+    /** One line: per-phase and total setup time, reads issued/skipped */
+    QString summary() const;
+
+    static QString phaseName(Phase phase);
+
+signals:
+    /** Setup done; complete is false when the snapshot timed out with values missing */
+    void finished(bool complete);
+
+    /** A phase before commit() did not complete in time; the sequence has stopped */
+    void timedOut(GattSetupSequence::Phase phase);
+
+private slots:
+    void onDescriptorWritten(const QLowEnergyDescriptor &descriptor, const QByteArray &value);
+    void onSnapshotTimeout();
+    void onPhaseTimeout();
+
+private:
+    void checkProgress();
+    void finish(bool complete);
+    qint64 nowUs() const { return m_clock.nsecsElapsed() / 1000; }
+
+    GattOperationQueue *m_queue;
+    WheelTimer m_snapshotTimer;
+    WheelTimer m_phaseTimer;
+    QElapsedTimer m_clock;
+    QString m_deviceName;
+
+    bool m_running;
+    bool m_committed;
+    Phase m_phase;
+    qint64 m_phaseStartUs;
+    std::array<qint64, PhaseCount> m_phaseUs;
+
+    QList<QLowEnergyDescriptor> m_pendingSubscriptions;
+    QHash<QBluetoothUuid, QLowEnergyCharacteristic> m_missingValues;
+    QSet<QString> m_missingItems;
+    int m_readsQueued;
+    int m_readsSkipped;
+};
+
+#endif // GATTSETUPSEQUENCE_H
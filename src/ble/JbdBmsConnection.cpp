@@ -6,11 +6,17 @@ const QBluetoothUuid JbdBmsConnection::JBD_SERVICE_UUID     = QBluetoothUuid(sta
 const QBluetoothUuid JbdBmsConnection::JBD_NOTIFY_CHAR_UUID = QBluetoothUuid(static_cast<quint16>(0xFF01));
 const QBluetoothUuid JbdBmsConnection::JBD_WRITE_CHAR_UUID  = QBluetoothUuid(static_cast<quint16>(0xFF02));
 
-JbdBmsConnection::JbdBmsConnection(QObject *parent)
+JbdBmsConnection::JbdBmsConnection(TimerWheel *timers, QObject *parent)
     : QObject(parent)
     , m_controller(nullptr)
     , m_service(nullptr)
-    , m_pollTimer(new QTimer(this))
+    , m_gattQueue(new GattOperationQueue(timers, this))
+    , m_setup(new GattSetupSequence(m_gattQueue, timers, this))
+    , m_linkProfile(new ConnectionProfileController(Robot::SmartBMS, timers, this))
+    , m_rssiMonitor(new RssiMonitor(m_gattQueue, timers, this))
+    , m_staleness(new StalenessMonitor(timers, this))
+    , m_pollTimer(timers)
+    , m_cellInfoTimer(timers)
     , m_connectionState(Robot::Disconnected)
     , m_rssi(-100)
     , m_serviceFound(false)
@@ -19,13 +25,37 @@ JbdBmsConnection::JbdBmsConnection(QObject *parent)
     , m_soc(0)
 {
     // Poll BMS data every 2 seconds
-    m_pollTimer->setInterval(2000);
-    connect(m_pollTimer, &QTimer::timeout, this, &JbdBmsConnection::requestBmsData);
+    m_pollTimer.setInterval(POLL_INTERVAL_MS);
+    m_pollTimer.callOnTimeout([this]() { requestBmsData(); });
+
+    m_cellInfoTimer.setSingleShot(true);
+    m_cellInfoTimer.setInterval(CELL_INFO_DELAY_MS);
+    m_cellInfoTimer.callOnTimeout([this]() {
+        if (m_connectionState == Robot::Ready) {
+            sendCommand(JBD_CMD_CELLINFO);
+        }
+    });
+
+    // Unacknowledged command writes are paced to the granted interval
+    connect(m_linkProfile, &ConnectionProfileController::parametersGranted, this,
+            [this](const QLowEnergyConnectionParameters &parameters) {
+        m_gattQueue->setConnectionInterval(parameters.maximumInterval());
+    });
+
+    connect(m_setup, &GattSetupSequence::finished, this, &JbdBmsConnection::onSetupFinished);
+    connect(m_setup, &GattSetupSequence::timedOut, this, &JbdBmsConnection::onSetupTimedOut);
+    connect(m_staleness, &StalenessMonitor::staleChanged, this, &JbdBmsConnection::staleChanged);
+    connect(m_rssiMonitor, &RssiMonitor::updated, this, [this]() {
+        m_rssi = m_rssiMonitor->rssi();
+        emit rssiChanged();
+    });
 }
 
 JbdBmsConnection::~JbdBmsConnection()
 {
-    m_pollTimer->stop();
+    m_pollTimer.stop();
+    m_cellInfoTimer.stop();
+    m_gattQueue->setService(nullptr);
     if (m_service) {
         delete m_service;
         m_service = nullptr;
@@ -37,7 +67,8 @@ JbdBmsConnection::~JbdBmsConnection()
     }
 }
 
-void JbdBmsConnection::connectToDevice(const QBluetoothDeviceInfo &device)
+void JbdBmsConnection::connectToDevice(const QBluetoothDeviceInfo &device,
+                                       QLowEnergyController::RemoteAddressType addressType)
 {
     if (m_controller) {
         qWarning() << "JbdBmsConnection: Already connected or connecting";
@@ -56,9 +87,9 @@ void JbdBmsConnection::connectToDevice(const QBluetoothDeviceInfo &device)
 
     m_controller = QLowEnergyController::createCentral(device, this);
 
-    // On Linux without CAP_NET_ADMIN, BlueZ can't auto-detect address types.
-    // BLE peripherals typically use random addresses, so set it explicitly.
-    m_controller->setRemoteAddressType(QLowEnergyController::RandomAddress);
+    // On Linux without CAP_NET_ADMIN, BlueZ can't auto-detect address types;
+    // the caller passes the one remembered for this device (random if unknown)
+    m_controller->setRemoteAddressType(addressType);
 
     connect(m_controller, &QLowEnergyController::connected,
             this, &JbdBmsConnection::onControllerConnected);
@@ -72,12 +103,16 @@ void JbdBmsConnection::connectToDevice(const QBluetoothDeviceInfo &device)
             this, &JbdBmsConnection::onDiscoveryFinished);
 
     qDebug() << "JbdBmsConnection: Connecting to" << m_deviceName << m_deviceAddress.toString();
+    m_linkProfile->setController(m_controller);
+    m_rssiMonitor->setController(m_controller);
+    m_setup->start(m_deviceName);
     m_controller->connectToDevice();
 }
 
 void JbdBmsConnection::disconnect()
 {
-    m_pollTimer->stop();
+    m_pollTimer.stop();
+    m_cellInfoTimer.stop();
     if (m_controller) {
         m_controller->disconnectFromDevice();
     }
@@ -88,15 +123,22 @@ void JbdBmsConnection::onControllerConnected()
     qDebug() << "JbdBmsConnection: Controller connected, discovering services...";
     setConnectionState(Robot::Connected);
     m_serviceFound = false;
+    m_setup->beginPhase(GattSetupSequence::Discovery);
+    m_linkProfile->setMode(ConnectionProfile::Active);     // short interval for setup
     m_controller->discoverServices();
 }
 
 void JbdBmsConnection::onControllerDisconnected()
 {
     qDebug() << "JbdBmsConnection: Controller disconnected";
-    m_pollTimer->stop();
+    m_pollTimer.stop();
+    m_cellInfoTimer.stop();
+    m_setup->abort();
+    m_rssiMonitor->stop();
+    m_staleness->stop();
     setConnectionState(Robot::Disconnected);
 
+    m_gattQueue->setService(nullptr);
     if (m_service) {
         delete m_service;
         m_service = nullptr;
@@ -105,9 +147,19 @@ void JbdBmsConnection::onControllerDisconnected()
 
 void JbdBmsConnection::onControllerError(QLowEnergyController::Error error)
 {
+    if (error == QLowEnergyController::RssiReadError) {
+        // Only the periodic RSSI sample failed; the link itself is fine
+        m_rssiMonitor->handleReadError();
+        return;
+    }
+
     QString errorString = m_controller->errorString();
     qWarning() << "JbdBmsConnection: Controller error:" << error << errorString;
-    m_pollTimer->stop();
+    m_pollTimer.stop();
+    m_cellInfoTimer.stop();
+    m_setup->abort();
+    m_rssiMonitor->stop();
+    m_staleness->stop();
     setError(errorString);
     setConnectionState(Robot::Error);
 }
@@ -152,8 +204,10 @@ void JbdBmsConnection::setupService()
             this, &JbdBmsConnection::onServiceStateChanged);
     connect(m_service, &QLowEnergyService::characteristicChanged,
             this, &JbdBmsConnection::onCharacteristicChanged);
+    m_gattQueue->setService(m_service);
 
     qDebug() << "JbdBmsConnection: Discovering service details...";
+    m_setup->beginPhase(GattSetupSequence::ServiceDetails);
     m_service->discoverDetails();
 }
 
@@ -167,12 +221,14 @@ void JbdBmsConnection::onServiceStateChanged(QLowEnergyService::ServiceState sta
         m_writeCharacteristic  = m_service->characteristic(JBD_WRITE_CHAR_UUID);
 
         if (!m_notifyCharacteristic.isValid()) {
+            m_setup->abort();
             setError("JBD notify characteristic (0xFF01) not found");
             setConnectionState(Robot::Error);
             return;
         }
 
         if (!m_writeCharacteristic.isValid()) {
+            m_setup->abort();
             setError("JBD write characteristic (0xFF02) not found");
             setConnectionState(Robot::Error);
             return;
@@ -180,22 +236,35 @@ void JbdBmsConnection::onServiceStateChanged(QLowEnergyService::ServiceState sta
 
         qDebug() << "JbdBmsConnection: Characteristics found, enabling notifications...";
 
-        // Enable notifications on the notify characteristic
-        QLowEnergyDescriptor notification = m_notifyCharacteristic.descriptor(
-            QBluetoothUuid::DescriptorType::ClientCharacteristicConfiguration);
+        // Ready once both frames are in. The hardware info request queues behind the
+        // CCCD write; cell info follows as soon as the first answer arrives.
+        m_setup->beginPhase(GattSetupSequence::Subscribe);
+        m_setup->subscribe(m_notifyCharacteristic);
+        m_setup->requireItem(QStringLiteral("hwinfo"));
+        m_setup->requireItem(QStringLiteral("cellinfo"));
+        m_setup->commit();
 
-        if (notification.isValid()) {
-            m_service->writeDescriptor(notification, QByteArray::fromHex("0100"));
-        } else {
-            qWarning() << "JbdBmsConnection: CCCD descriptor not found, notifications may not work";
-        }
+        sendCommand(JBD_CMD_HWINFO);
+    }
+}
 
-        setConnectionState(Robot::Ready);
-        qDebug() << "JbdBmsConnection: Connection ready, starting data polling";
+void JbdBmsConnection::onSetupFinished(bool complete)
+{
+    Q_UNUSED(complete)
+    setConnectionState(Robot::Ready);
+    m_linkProfile->boost();                                 // relax once setup traffic is over
+    m_rssiMonitor->start(m_rssi);
+    m_staleness->start(STALE_AFTER_MS);
+    qDebug() << "JbdBmsConnection: Connection ready, starting data polling -" << m_setup->summary();
+    m_pollTimer.startStaggered(POLL_INTERVAL_MS);
+}
 
-        // Request initial data immediately, then start polling
-        requestBmsData();
-        m_pollTimer->start();
+void JbdBmsConnection::onSetupTimedOut(GattSetupSequence::Phase phase)
+{
+    setError(QStringLiteral("Connection setup timed out (%1)").arg(GattSetupSequence::phaseName(phase)));
+    setConnectionState(Robot::Error);
+    if (m_controller) {
+        m_controller->disconnectFromDevice();
     }
 }
 
@@ -259,6 +328,7 @@ void JbdBmsConnection::onCharacteristicChanged(const QLowEnergyCharacteristic &c
             qWarning() << "JbdBmsConnection: BMS returned error status:" << Qt::hex << status;
             continue;
         }
+        m_staleness->dataReceived();
 
         // Extract data portion (bytes 4 .. 4+dataLen-1)
         QByteArray payload = frame.mid(4, dataLen);
@@ -266,9 +336,14 @@ void JbdBmsConnection::onCharacteristicChanged(const QLowEnergyCharacteristic &c
         switch (command) {
         case JBD_CMD_HWINFO:
             parseHardwareInfo(payload);
+            if (m_setup->isRunning()) {
+                sendCommand(JBD_CMD_CELLINFO);
+                m_setup->itemReceived(QStringLiteral("hwinfo"));
+            }
             break;
         case JBD_CMD_CELLINFO:
             parseCellInfo(payload);
+            m_setup->itemReceived(QStringLiteral("cellinfo"));
             break;
         default:
             qDebug() << "JbdBmsConnection: Unhandled command:" << Qt::hex << command;
@@ -350,11 +425,7 @@ void JbdBmsConnection::requestBmsData()
     sendCommand(JBD_CMD_HWINFO);
 
     // Request cell voltage info
-    QTimer::singleShot(200, this, [this]() {
-        if (m_connectionState == Robot::Ready) {
-            sendCommand(JBD_CMD_CELLINFO);
-        }
-    });
+    m_cellInfoTimer.start();
 }
 
 void JbdBmsConnection::parseCellInfo(const QByteArray &data)
@@ -415,7 +486,8 @@ bool JbdBmsConnection::sendCommand(uint8_t command)
     QByteArray data(reinterpret_cast<const char*>(frame), sizeof(frame));
     qDebug() << "JbdBmsConnection: Sending command" << Qt::hex << command << "frame:" << data.toHex(':');
 
-    m_service->writeCharacteristic(m_writeCharacteristic, data, QLowEnergyService::WriteWithoutResponse);
+    m_gattQueue->writeCharacteristic(m_writeCharacteristic, data, GattOperationQueue::Bulk,
+                                     QLowEnergyService::WriteWithoutResponse);
     return true;
 }
 
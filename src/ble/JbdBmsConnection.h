@@ -6,8 +6,12 @@
 #include <QLowEnergyController>
 #include <QLowEnergyService>
 #include <QBluetoothUuid>
-#include <QTimer>
 #include "src/models/Robot.h"
+#include "GattOperationQueue.h"
+#include "GattSetupSequence.h"
+#include "ConnectionProfile.h"
+#include "RssiMonitor.h"
+#include "StalenessMonitor.h"
 
 class JbdBmsConnection : public QObject
 {
@@ -17,6 +21,7 @@ class JbdBmsConnection : public QObject
     Q_PROPERTY(QString deviceAddress READ deviceAddress NOTIFY deviceAddressChanged)
     Q_PROPERTY(int rssi READ rssi NOTIFY rssiChanged)
     Q_PROPERTY(QString lastError READ lastError NOTIFY errorOccurred)
+    Q_PROPERTY(bool stale READ isStale NOTIFY staleChanged)
     Q_PROPERTY(float totalVoltage READ totalVoltage NOTIFY totalVoltageChanged)
     Q_PROPERTY(float current READ current NOTIFY currentChanged)
     Q_PROPERTY(int soc READ soc NOTIFY socChanged)
@@ -35,7 +40,11 @@ public:
     static const uint8_t JBD_CMD_HWINFO   = 0x03;
     static const uint8_t JBD_CMD_CELLINFO = 0x04;
 
-    explicit JbdBmsConnection(QObject *parent = nullptr);
+    static constexpr int POLL_INTERVAL_MS = 2000;
+    static constexpr int CELL_INFO_DELAY_MS = 200;        // after the hardware info request
+    static constexpr int STALE_AFTER_MS = 3 * POLL_INTERVAL_MS;
+
+    explicit JbdBmsConnection(TimerWheel *timers, QObject *parent = nullptr);
     ~JbdBmsConnection();
 
     Robot::ConnectionState connectionState() const { return m_connectionState; }
@@ -50,8 +59,22 @@ public:
 
     QBluetoothAddress bleAddress() const { return m_deviceAddress; }
 
+    /** Per-phase timing of the last connection setup */
+    QString setupSummary() const { return m_setup->summary(); }
+
+    /** Requested connection profile and the parameters actually granted */
+    QString connectionParametersSummary() const { return m_linkProfile->summary(); }
+
+    /** Link quality 0..100 from the filtered RSSI, and recent filtered RSSI samples */
+    int linkQuality() const { return m_rssiMonitor->linkQuality(); }
+    QList<int> rssiHistory() const { return m_rssiMonitor->history(); }
+
+    /** Ready, but no BMS frame for STALE_AFTER_MS (three missed polls) */
+    bool isStale() const { return m_staleness->isStale(); }
+
 public slots:
-    void connectToDevice(const QBluetoothDeviceInfo &device);
+    void connectToDevice(const QBluetoothDeviceInfo &device,
+                         QLowEnergyController::RemoteAddressType addressType = QLowEnergyController::RandomAddress);
     void disconnect();
 
 signals:
@@ -59,6 +82,7 @@ signals:
     void deviceNameChanged();
     void deviceAddressChanged();
     void rssiChanged();
+    void staleChanged();
     void errorOccurred(const QString &error);
     void totalVoltageChanged();
     void currentChanged();
@@ -75,6 +99,8 @@ private slots:
     void onServiceStateChanged(QLowEnergyService::ServiceState state);
     void onCharacteristicChanged(const QLowEnergyCharacteristic &characteristic, const QByteArray &value);
     void requestBmsData();
+    void onSetupFinished(bool complete);
+    void onSetupTimedOut(GattSetupSequence::Phase phase);
 
 private:
     void setConnectionState(Robot::ConnectionState state);
@@ -87,9 +113,15 @@ private:
 
     QLowEnergyController *m_controller;
     QLowEnergyService *m_service;
+    GattOperationQueue *m_gattQueue;
+    GattSetupSequence *m_setup;
+    ConnectionProfileController *m_linkProfile;
+    RssiMonitor *m_rssiMonitor;
+    StalenessMonitor *m_staleness;
     QLowEnergyCharacteristic m_notifyCharacteristic;
     QLowEnergyCharacteristic m_writeCharacteristic;
-    QTimer *m_pollTimer;
+    WheelTimer m_pollTimer;
+    WheelTimer m_cellInfoTimer;
     QByteArray m_frameBuffer;
 
     Robot::ConnectionState m_connectionState;
@@ -0,0 +1,171 @@
+#include "KnownDeviceRegistry.h"
+#include "BleDeviceScanner.h"
+#include <QDebug>
+#include <QSettings>
+#include <iterator>
+
+// ── KnownDevice ──
+
+QBluetoothDeviceInfo KnownDevice::toDeviceInfo() const
+{
+    QBluetoothDeviceInfo info(address, name, 0);
+    info.setCoreConfigurations(QBluetoothDeviceInfo::LowEnergyCoreConfiguration);
+    if (deviceType == Robot::FalconsRobot) {
+        info.setServiceUuids({ BleDeviceScanner::FALCONS_SERVICE_UUID });
+    } else if (deviceType == Robot::SmartBMS) {
+        info.setServiceUuids({ BleDeviceScanner::JBD_BMS_SERVICE_UUID });
+    }
+    return info;
+}
+
+// ── KnownDeviceRegistry ──
+
+KnownDeviceRegistry::KnownDeviceRegistry(QObject *parent)
+    : QObject(parent)
+{
+    load();
+}
+
+int KnownDeviceRegistry::autoConnectCount() const
+{
+    int count = 0;
+    for (const KnownDevice &device : m_devices) {
+        if (device.autoConnect) count++;
+    }
+    return count;
+}
+
+KnownDevice KnownDeviceRegistry::device(const QBluetoothAddress &address) const
+{
+    return m_devices.value(address.toUInt64());
+}
+
+bool KnownDeviceRegistry::contains(const QBluetoothAddress &address) const
+{
+    return m_devices.contains(address.toUInt64());
+}
+
+bool KnownDeviceRegistry::isAutoConnect(const QBluetoothAddress &address) const
+{
+    const auto it = m_devices.constFind(address.toUInt64());
+    return it != m_devices.constEnd() && it->autoConnect;
+}
+
+bool KnownDeviceRegistry::isKnown(const QString &address) const
+{
+    return contains(QBluetoothAddress(address));
+}
+
+void KnownDeviceRegistry::remember(const KnownDevice &device)
+{
+    if (!device.isValid()) return;
+
+    KnownDevice entry = device;
+    const auto it = m_devices.find(device.address.toUInt64());
+    if (it == m_devices.end()) {
+        qDebug() << "KnownDeviceRegistry: Remembering" << entry.name << entry.address.toString();
+        m_devices.insert(entry.address.toUInt64(), entry);
+        save();
+        emit devicesChanged();
+        return;
+    }
+
+    entry.autoConnect = it->autoConnect;
+    if (entry.name.isEmpty()) entry.name = it->name;
+    if (entry.identity.isEmpty()) entry.identity = it->identity;
+    if (entry.addressType == it->addressType && entry.deviceType == it->deviceType
+        && entry.name == it->name && entry.identity == it->identity
+        && entry.lastReady == it->lastReady) {
+        return;
+    }
+
+    *it = entry;
+    saveRow(it);
+    emit devicesChanged();
+}
+
+void KnownDeviceRegistry::forget(const QString &address)
+{
+    if (m_devices.remove(QBluetoothAddress(address).toUInt64()) == 0) return;
+
+    qDebug() << "KnownDeviceRegistry: Forgot" << address;
+    save();
+    emit devicesChanged();
+}
+
+void KnownDeviceRegistry::setAutoConnect(const QString &address, bool enabled)
+{
+    auto it = m_devices.find(QBluetoothAddress(address).toUInt64());
+    if (it == m_devices.end() || it->autoConnect == enabled) return;
+
+    it->autoConnect = enabled;
+    saveRow(it);
+    emit devicesChanged();
+}
+
+void KnownDeviceRegistry::load()
+{
+    QSettings settings;
+    const int size = settings.beginReadArray(QStringLiteral("knownDevices"));
+    for (int i = 0; i < size; ++i) {
+        settings.setArrayIndex(i);
+
+        KnownDevice device;
+        device.address = QBluetoothAddress(settings.value(QStringLiteral("address")).toString());
+        device.addressType = settings.value(QStringLiteral("publicAddress")).toBool()
+            ? QLowEnergyController::PublicAddress : QLowEnergyController::RandomAddress;
+        device.deviceType = static_cast<Robot::DeviceType>(
+            settings.value(QStringLiteral("deviceType"), Robot::Unknown).toInt());
+        device.name = settings.value(QStringLiteral("name")).toString();
+        device.identity = settings.value(QStringLiteral("identity")).toString();
+        device.autoConnect = settings.value(QStringLiteral("autoConnect"), true).toBool();
+        device.lastReady = settings.value(QStringLiteral("lastReady")).toDateTime();
+
+        if (device.isValid()) {
+            m_devices.insert(device.address.toUInt64(), device);
+        }
+    }
+    settings.endArray();
+
+    // saveRow() addresses entries by their place in the map; drop anything that shifts it
+    if (m_devices.size() != size) {
+        save();
+    }
+
+    qDebug() << "KnownDeviceRegistry: Loaded" << m_devices.size() << "known devices";
+}
+
+void KnownDeviceRegistry::save() const
+{
+    QSettings settings;
+    settings.remove(QStringLiteral("knownDevices"));
+    settings.beginWriteArray(QStringLiteral("knownDevices"), m_devices.size());
+    int i = 0;
+    for (const KnownDevice &device : m_devices) {
+        settings.setArrayIndex(i++);
+        write(settings, device);
+    }
+    settings.endArray();
+}
+
+void KnownDeviceRegistry::saveRow(QMap<quint64, KnownDevice>::const_iterator row) const
+{
+    // Entries keep their place in the array until one is added or removed
+    QSettings settings;
+    settings.beginWriteArray(QStringLiteral("knownDevices"), m_devices.size());
+    settings.setArrayIndex(int(std::distance(m_devices.cbegin(), row)));
+    write(settings, *row);
+    settings.endArray();
+}
+
+void KnownDeviceRegistry::write(QSettings &settings, const KnownDevice &device)
+{
+    settings.setValue(QStringLiteral("address"), device.address.toString());
+    settings.setValue(QStringLiteral("publicAddress"),
+                      device.addressType == QLowEnergyController::PublicAddress);
+    settings.setValue(QStringLiteral("deviceType"), static_cast<int>(device.deviceType));
+    settings.setValue(QStringLiteral("name"), device.name);
+    settings.setValue(QStringLiteral("identity"), device.identity);
+    settings.setValue(QStringLiteral("autoConnect"), device.autoConnect);
+    settings.setValue(QStringLiteral("lastReady"), device.lastReady);
+}
@@ -0,0 +1,77 @@
+#ifndef KNOWNDEVICEREGISTRY_H
+#define KNOWNDEVICEREGISTRY_H
+
+#include <QObject>
+#include <QBluetoothAddress>
+#include <QBluetoothDeviceInfo>
+#include <QDateTime>
+#include <QList>
+#include <QMap>
+#include <QLowEnergyController>
+#include "src/models/Robot.h"
+
+class QSettings;
+
+/** One remembered robot or BMS pack */
+struct KnownDevice {
+    QBluetoothAddress address;
+    QLowEnergyController::RemoteAddressType addressType = QLowEnergyController::RandomAddress;
+    Robot::DeviceType deviceType = Robot::Unknown;
+    QString name;
+    QString identity;           // robot identity as reported over GATT (Falcons)
+    bool autoConnect = true;    // connect at launch and whenever it advertises
+    QDateTime lastReady;
+
+    bool isValid() const { return !address.isNull(); }
+
+    /** Device info good enough to connect by address without a scan */
+    QBluetoothDeviceInfo toDeviceInfo() const;
+};
+
+/**
+ * KnownDeviceRegistry - devices that reached Ready before, kept in QSettings.
+ *
+ * Connecting to a known address does not need discovery: the manager opens
+ * these links directly at launch. Devices with autoConnect set are also
+ * reconnected as soon as the scanner hears them.
+ */
+class KnownDeviceRegistry : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY devicesChanged)
+    Q_PROPERTY(int autoConnectCount READ autoConnectCount NOTIFY devicesChanged)
+
+public:
+    explicit KnownDeviceRegistry(QObject *parent = nullptr);
+
+    int count() const { return m_devices.size(); }
+    int autoConnectCount() const;
+
+    QList<KnownDevice> devices() const { return m_devices.values(); }
+    KnownDevice device(const QBluetoothAddress &address) const;
+    bool contains(const QBluetoothAddress &address) const;
+    bool isAutoConnect(const QBluetoothAddress &address) const;
+
+    /**
+     * Add or refresh an entry; autoConnect of an existing entry is kept. An
+     * unchanged entry is not written, a changed one rewrites only its row.
+     */
+    void remember(const KnownDevice &device);
+
+    Q_INVOKABLE void forget(const QString &address);
+    Q_INVOKABLE void setAutoConnect(const QString &address, bool enabled);
+    Q_INVOKABLE bool isKnown(const QString &address) const;
+
+signals:
+    void devicesChanged();
+
+private:
+    void load();
+    void save() const;
+    void saveRow(QMap<quint64, KnownDevice>::const_iterator row) const;
+    static void write(QSettings &settings, const KnownDevice &device);
+
+    QMap<quint64, KnownDevice> m_devices;
+};
+
+#endif // KNOWNDEVICEREGISTRY_H
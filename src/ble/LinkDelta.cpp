@@ -0,0 +1,125 @@
+#include "LinkDelta.h"
+#include <QMetaObject>
+#include <QMutexLocker>
+#include <utility>
+
+// ── LinkDelta ──
+
+void LinkDelta::merge(const LinkDelta &newer)
+{
+    if (newer.has(State)) {
+        state = newer.state;
+        name = newer.name;
+    }
+    if (newer.has(Rssi)) {
+        rssi = newer.rssi;
+        linkQuality = newer.linkQuality;
+        rssiHistory = newer.rssiHistory;
+    }
+    if (newer.has(Statistics)) {
+        statistics = newer.statistics;
+    }
+    if (newer.has(RobotData)) {
+        playState = newer.playState;
+        wifiSsid = newer.wifiSsid;
+        wifiList = newer.wifiList;
+        batteryVoltage = newer.batteryVoltage;
+        robotIdentity = newer.robotIdentity;
+        name = newer.name;
+    }
+    if (newer.has(BmsData)) {
+        totalVoltage = newer.totalVoltage;
+        current = newer.current;
+        soc = newer.soc;
+        cellVoltages = newer.cellVoltages;
+    }
+    if (newer.has(Packet)) {
+        packet = newer.packet;
+        if (!has(Packet)) packetNs = newer.packetNs;
+    }
+    if (newer.has(Error)) {
+        error = newer.error;
+    }
+    if (newer.has(Stale)) {
+        stale = newer.stale;
+    }
+    if (newer.has(PlayStateWritten) && !has(PlayStateWritten)) {
+        writtenNs = newer.writtenNs;
+    }
+    if (newer.has(PlayStateAcked)) {
+        playStateAckValue = newer.playStateAckValue;
+        if (!has(PlayStateAcked)) playStateAckNs = newer.playStateAckNs;
+    }
+    if (newer.has(WifiSsidAcked)) {
+        wifiSsidAckValue = newer.wifiSsidAckValue;
+    }
+    if (newer.has(PlayStateNotified)) {
+        playState = newer.playState;
+        if (!has(PlayStateNotified)) notifiedNs = newer.notifiedNs;
+    }
+    if (newer.has(WifiSsidNotified)) {
+        wifiSsid = newer.wifiSsid;
+    }
+
+    fields |= newer.fields;
+    receivedNs = newer.receivedNs;
+}
+
+// ── LinkDeltaQueue ──
+
+void LinkDeltaQueue::setReceiver(QObject *receiver)
+{
+    QMutexLocker locker(&m_mutex);
+    m_receiver = receiver;
+    if (!m_receiver) {
+        m_pending.clear();
+        m_indexByLink.clear();
+        m_wakePosted = false;
+    }
+}
+
+void LinkDeltaQueue::push(const LinkDelta &delta)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_receiver) {
+        return;
+    }
+
+    const auto it = m_indexByLink.find(delta.linkId);
+    if (it != m_indexByLink.end()) {
+        LinkDelta &pending = m_pending[it.value()];
+        if (delta.has(LinkDelta::State) && pending.has(LinkDelta::State)
+            && delta.state != pending.state) {
+            // Folding would lose the earlier transition; it is applied first instead
+            it.value() = m_pending.size();
+            m_pending.append(delta);
+        } else {
+            pending.merge(delta);
+        }
+    } else if (m_pending.size() < MAX_PENDING_LINKS) {
+        m_indexByLink.insert(delta.linkId, m_pending.size());
+        m_pending.append(delta);
+    } else {
+        m_dropped++;
+        return;
+    }
+
+    if (!m_wakePosted) {
+        m_wakePosted = true;
+        QMetaObject::invokeMethod(m_receiver, "drainLinkDeltas", Qt::QueuedConnection);
+    }
+}
+
+QList<LinkDelta> LinkDeltaQueue::takeAll()
+{
+    QMutexLocker locker(&m_mutex);
+    m_indexByLink.clear();
+    m_wakePosted = false;
+    return std::exchange(m_pending, {});
+}
+
+qint64 LinkDeltaQueue::droppedCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_dropped;
+}
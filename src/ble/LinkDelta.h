@@ -0,0 +1,117 @@
+#ifndef LINKDELTA_H
+#define LINKDELTA_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include "src/models/Robot.h"
+
+/**
+ * LinkDelta - what changed on one link since the GUI last looked.
+ *
+ * Built on the BLE worker from a connection's own getters and handed to
+ * the GUI thread through LinkDeltaQueue. Only the groups named in
+ * `fields` are meaningful. Stamps come from MonotonicClock on the worker,
+ * so latency stages are timed where they happened, not where they were seen.
+ */
+struct LinkDelta
+{
+    enum Field : quint32 {
+        State             = 1u << 0,    // state, name
+        Rssi              = 1u << 1,    // rssi, linkQuality, rssiHistory
+        Statistics        = 1u << 2,
+        RobotData         = 1u << 3,    // playState .. robotIdentity, name
+        BmsData           = 1u << 4,    // totalVoltage .. cellVoltages
+        Packet            = 1u << 5,    // last NUS packet
+        Error             = 1u << 6,
+        PlayStateWritten  = 1u << 7,    // play-state write handed to the stack
+        PlayStateAcked    = 1u << 8,    // with playStateAckValue
+        WifiSsidAcked     = 1u << 9,    // with wifiSsidAckValue
+        PlayStateNotified = 1u << 10,   // with playState
+        WifiSsidNotified  = 1u << 11,   // with wifiSsid
+        Stale             = 1u << 12    // with stale
+    };
+
+    QString address;
+    quint64 linkId = 0;         // which link on the address published it
+    quint32 fields = 0;
+
+    Robot::ConnectionState state = Robot::Disconnected;
+    QString name;
+
+    int rssi = 0;
+    int linkQuality = 0;
+    QList<int> rssiHistory;
+    LinkStatistics statistics;
+
+    int playState = 0;
+    QString wifiSsid;
+    QStringList wifiList;
+    float batteryVoltage = 0.0f;
+    QString robotIdentity;
+
+    float totalVoltage = 0.0f;
+    float current = 0.0f;
+    int soc = 0;
+    QList<float> cellVoltages;
+
+    QByteArray packet;
+    QString error;
+    bool stale = false;
+    QByteArray playStateAckValue;
+    QByteArray wifiSsidAckValue;
+
+    // Event stamps (MonotonicClock, ns); the first of a batch is kept
+    qint64 packetNs = -1;
+    qint64 writtenNs = -1;
+    qint64 playStateAckNs = -1;
+    qint64 notifiedNs = -1;
+
+    // When the newest folded-in delta was published (MonotonicClock, ns)
+    qint64 receivedNs = 0;
+
+    bool has(Field field) const { return (fields & field) != 0; }
+
+    /** Fold a newer delta for the same link into this one */
+    void merge(const LinkDelta &newer);
+};
+
+/**
+ * LinkDeltaQueue - hands LinkDeltas from the BLE worker to the GUI thread.
+ *
+ * Deltas are coalesced per link id, so a burst of notifications costs the
+ * GUI thread one model update per link, and a link being torn down never
+ * folds into its successor on the same address. A state change is never
+ * folded over a different pending state: it starts a new entry for the
+ * link, so every transition (Ready, then Disconnected) is applied in order.
+ * The first push after a drain wakes the receiver with a single queued
+ * call to drainLinkDeltas().
+ */
+class LinkDeltaQueue
+{
+public:
+    static constexpr int MAX_PENDING_LINKS = 256;      // state transitions are never dropped
+
+    /** Receiver of the wake-up; nullptr detaches (pushes are then dropped) */
+    void setReceiver(QObject *receiver);
+
+    void push(const LinkDelta &delta);
+
+    /** All pending deltas, oldest first; a link's transitions keep their order */
+    QList<LinkDelta> takeAll();
+
+    qint64 droppedCount() const;
+
+private:
+    mutable QMutex m_mutex;
+    QObject *m_receiver = nullptr;
+    QHash<quint64, int> m_indexByLink;      // the newest entry of each link
+    QList<LinkDelta> m_pending;
+    bool m_wakePosted = false;
+    qint64 m_dropped = 0;
+};
+
+#endif // LINKDELTA_H
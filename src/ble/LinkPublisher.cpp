@@ -0,0 +1,322 @@
+#include "LinkPublisher.h"
+#include "BleRobotConnection.h"
+#include "JbdBmsConnection.h"
+#include "FalconsRobotConnection.h"
+#include "SimulatedLink.h"
+#include "src/protocol/MonotonicClock.h"
+#include "src/protocol/RpcClient.h"
+#include "src/protocol/BulkTransfer.h"
+#include <QBluetoothAddress>
+#include <QDebug>
+#include <algorithm>
+
+LinkPublisher::LinkPublisher(const QString &address, quint64 linkId, QSharedPointer<LinkDeltaQueue> queue,
+                             QObject *parent)
+    : QObject(parent)
+    , m_address(address)
+    , m_linkId(linkId)
+    , m_queue(std::move(queue))
+    , m_slot(-1)
+{
+}
+
+LinkPublisher::~LinkPublisher()
+{
+    if (m_snapshot) {
+        m_snapshot->release(m_slot);
+    }
+}
+
+void LinkPublisher::setSnapshot(QSharedPointer<FleetSnapshot> snapshot, int slot, Robot::DeviceType type)
+{
+    m_snapshot = std::move(snapshot);
+    m_slot = slot;
+    m_sample = RobotSample();
+    m_sample.address = QBluetoothAddress(m_address).toUInt64();
+    m_sample.deviceType = static_cast<qint8>(type);
+    m_sample.connectionState = static_cast<qint8>(Robot::Connecting);
+}
+
+void LinkPublisher::publish(LinkDelta delta)
+{
+    delta.address = m_address;
+    delta.linkId = m_linkId;
+    delta.receivedNs = MonotonicClock::nowNs();
+    if (m_snapshot) {
+        updateSample(delta);
+    }
+    m_queue->push(delta);
+}
+
+void LinkPublisher::updateSample(const LinkDelta &delta)
+{
+    if (delta.has(LinkDelta::State)) {
+        m_sample.connectionState = static_cast<qint8>(delta.state);
+    }
+    if (delta.has(LinkDelta::Rssi)) {
+        m_sample.rssi = static_cast<qint16>(delta.rssi);
+        m_sample.linkQuality = static_cast<qint16>(delta.linkQuality);
+        const int count = std::min<int>(delta.rssiHistory.size(), RobotSample::RSSI_HISTORY);
+        const int first = delta.rssiHistory.size() - count;     // keep the newest
+        for (int i = 0; i < count; ++i) {
+            m_sample.rssiHistory[i] = static_cast<qint16>(delta.rssiHistory.at(first + i));
+        }
+        m_sample.rssiHistoryCount = static_cast<qint16>(count);
+    }
+    if (delta.has(LinkDelta::Statistics)) {
+        m_sample.updateRate = static_cast<float>(delta.statistics.updateRate);
+        m_sample.lossPercent = static_cast<float>(delta.statistics.lossPercent);
+    }
+    if (delta.has(LinkDelta::RobotData)) {
+        m_sample.playState = static_cast<qint16>(delta.playState);
+        m_sample.batteryVoltage = delta.batteryVoltage;
+    }
+    if (delta.has(LinkDelta::PlayStateNotified)) {
+        m_sample.playState = static_cast<qint16>(delta.playState);
+    }
+    if (delta.has(LinkDelta::BmsData)) {
+        m_sample.totalVoltage = delta.totalVoltage;
+        m_sample.current = delta.current;
+        m_sample.soc = static_cast<qint16>(delta.soc);
+        const int count = std::min<int>(delta.cellVoltages.size(), RobotSample::MAX_CELLS);
+        for (int i = 0; i < count; ++i) {
+            m_sample.cellVoltages[i] = delta.cellVoltages.at(i);
+        }
+        m_sample.cellCount = static_cast<qint16>(count);
+    }
+
+    m_sample.updatedNs = delta.receivedNs;
+    m_sample.updates++;
+    m_snapshot->write(m_slot, m_sample);
+}
+
+// ── Falcons ──
+
+LinkPublisher *LinkPublisher::attach(FalconsRobotConnection *connection, const QString &address,
+                                     quint64 linkId, QSharedPointer<LinkDeltaQueue> queue)
+{
+    auto *publisher = new LinkPublisher(address, linkId, std::move(queue), connection);
+
+    connect(connection, &FalconsRobotConnection::connectionStateChanged, publisher, [publisher, connection]() {
+        LinkDelta delta;
+        delta.fields = LinkDelta::State | LinkDelta::Rssi;
+        delta.state = connection->connectionState();
+        delta.name = connection->robotName();
+        delta.rssi = connection->rssi();
+        delta.linkQuality = connection->linkQuality();
+        delta.rssiHistory = connection->rssiHistory();
+        publisher->publish(delta);
+    });
+    connect(connection, &FalconsRobotConnection::rssiChanged, publisher, [publisher, connection]() {
+        LinkDelta delta;
+        delta.fields = LinkDelta::Rssi;
+        delta.rssi = connection->rssi();
+        delta.linkQuality = connection->linkQuality();
+        delta.rssiHistory = connection->rssiHistory();
+        publisher->publish(delta);
+    });
+    connect(connection, &FalconsRobotConnection::linkStatisticsChanged, publisher, [publisher, connection]() {
+        LinkDelta delta;
+        delta.fields = LinkDelta::Statistics;
+        delta.statistics = connection->linkStatistics();
+        publisher->publish(delta);
+    });
+    connect(connection, &FalconsRobotConnection::robotDataUpdated, publisher, [publisher, connection]() {
+        LinkDelta delta;
+        delta.fields = LinkDelta::RobotData;
+        delta.playState = connection->playState();
+        delta.wifiSsid = connection->wifiSsid();
+        delta.wifiList = connection->wifiList();
+        delta.batteryVoltage = connection->batteryVoltage();
+        delta.robotIdentity = connection->robotIdentity();
+        delta.name = connection->robotName();
+        publisher->publish(delta);
+    });
+    connect(connection, &FalconsRobotConnection::playStateChanged, publisher, [publisher, connection]() {
+        LinkDelta delta;
+        delta.fields = LinkDelta::PlayStateNotified;
+        delta.playState = connection->playState();
+        delta.notifiedNs = MonotonicClock::nowNs();
+        publisher->publish(delta);
+    });
+    connect(connection, &FalconsRobotConnection::wifiSsidChanged, publisher, [publisher, connection]() {
+        LinkDelta delta;
+        delta.fields = LinkDelta::WifiSsidNotified;
+        delta.wifiSsid = connection->wifiSsid();
+        publisher->publish(delta);
+    });
+    connect(connection, &FalconsRobotConnection::writeIssued, publisher,
+            [publisher](const QBluetoothUuid &uuid, const QByteArray &) {
+        if (uuid != FalconsRobotConnection::CHAR_PLAY_STATE_UUID) return;
+        LinkDelta delta;
+        delta.fields = LinkDelta::PlayStateWritten;
+        delta.writtenNs = MonotonicClock::nowNs();
+        publisher->publish(delta);
+    });
+    connect(connection, &FalconsRobotConnection::writeAcknowledged, publisher,
+            [publisher](const QBluetoothUuid &uuid, const QByteArray &value) {
+        LinkDelta delta;
+        if (uuid == FalconsRobotConnection::CHAR_PLAY_STATE_UUID) {
+            delta.fields = LinkDelta::PlayStateAcked;
+            delta.playStateAckValue = value;
+            delta.playStateAckNs = MonotonicClock::nowNs();
+        } else if (uuid == FalconsRobotConnection::CHAR_WIFI_SSID_UUID) {
+            delta.fields = LinkDelta::WifiSsidAcked;
+            delta.wifiSsidAckValue = value;
+        } else {
+            return;
+        }
+        publisher->publish(delta);
+    });
+    connect(connection, &FalconsRobotConnection::staleChanged, publisher, [publisher, connection]() {
+        LinkDelta delta;
+        delta.fields = LinkDelta::Stale;
+        delta.stale = connection->isStale();
+        publisher->publish(delta);
+    });
+    connect(connection, &FalconsRobotConnection::errorOccurred, publisher, [publisher](const QString &error) {
+        LinkDelta delta;
+        delta.fields = LinkDelta::Error;
+        delta.error = error;
+        publisher->publish(delta);
+    });
+
+    return publisher;
+}
+
+// ── JBD BMS ──
+
+LinkPublisher *LinkPublisher::attach(JbdBmsConnection *connection, const QString &address,
+                                     quint64 linkId, QSharedPointer<LinkDeltaQueue> queue)
+{
+    auto *publisher = new LinkPublisher(address, linkId, std::move(queue), connection);
+
+    connect(connection, &JbdBmsConnection::connectionStateChanged, publisher, [publisher, connection]() {
+        LinkDelta delta;
+        delta.fields = LinkDelta::State | LinkDelta::Rssi;
+        delta.state = connection->connectionState();
+        delta.name = connection->deviceName();
+        delta.rssi = connection->rssi();
+        delta.linkQuality = connection->linkQuality();
+        delta.rssiHistory = connection->rssiHistory();
+        publisher->publish(delta);
+    });
+    connect(connection, &JbdBmsConnection::rssiChanged, publisher, [publisher, connection]() {
+        LinkDelta delta;
+        delta.fields = LinkDelta::Rssi;
+        delta.rssi = connection->rssi();
+        delta.linkQuality = connection->linkQuality();
+        delta.rssiHistory = connection->rssiHistory();
+        publisher->publish(delta);
+    });
+    connect(connection, &JbdBmsConnection::bmsDataUpdated, publisher, [publisher, connection]() {
+        LinkDelta delta;
+        delta.fields = LinkDelta::BmsData;
+        delta.totalVoltage = connection->totalVoltage();
+        delta.current = connection->current();
+        delta.soc = connection->soc();
+        delta.cellVoltages = connection->cellVoltages();
+        publisher->publish(delta);
+    });
+    connect(connection, &JbdBmsConnection::staleChanged, publisher, [publisher, connection]() {
+        LinkDelta delta;
+        delta.fields = LinkDelta::Stale;
+        delta.stale = connection->isStale();
+        publisher->publish(delta);
+    });
+    connect(connection, &JbdBmsConnection::errorOccurred, publisher, [publisher](const QString &error) {
+        LinkDelta delta;
+        delta.fields = LinkDelta::Error;
+        delta.error = error;
+        publisher->publish(delta);
+    });
+
+    return publisher;
+}
+
+// ── NUS ──
+
+LinkPublisher *LinkPublisher::attach(BleRobotConnection *connection, const QString &address,
+                                     quint64 linkId, QSharedPointer<LinkDeltaQueue> queue)
+{
+    auto *publisher = new LinkPublisher(address, linkId, std::move(queue), connection);
+
+    connect(connection, &BleRobotConnection::connectionStateChanged, publisher, [publisher, connection]() {
+        LinkDelta delta;
+        delta.fields = LinkDelta::State | LinkDelta::Rssi;
+        delta.state = connection->connectionState();
+        delta.name = connection->robotName();
+        delta.rssi = connection->rssi();
+        delta.linkQuality = connection->linkQuality();
+        delta.rssiHistory = connection->rssiHistory();
+        publisher->publish(delta);
+    });
+    connect(connection, &BleRobotConnection::rssiChanged, publisher, [publisher, connection]() {
+        LinkDelta delta;
+        delta.fields = LinkDelta::Rssi;
+        delta.rssi = connection->rssi();
+        delta.linkQuality = connection->linkQuality();
+        delta.rssiHistory = connection->rssiHistory();
+        publisher->publish(delta);
+    });
+    connect(connection, &BleRobotConnection::linkStatisticsChanged, publisher, [publisher, connection]() {
+        LinkDelta delta;
+        delta.fields = LinkDelta::Statistics;
+        delta.statistics = connection->linkStatistics();
+        publisher->publish(delta);
+    });
+    connect(connection, &BleRobotConnection::dataReceived, publisher, [publisher](const QByteArray &data) {
+        qDebug() << "Data received from" << publisher->address() << ":" << data.toHex();
+        LinkDelta delta;
+        delta.fields = LinkDelta::Packet;
+        delta.packet = data;
+        delta.packetNs = MonotonicClock::nowNs();
+        publisher->publish(delta);
+    });
+    connect(connection, &BleRobotConnection::staleChanged, publisher, [publisher, connection]() {
+        LinkDelta delta;
+        delta.fields = LinkDelta::Stale;
+        delta.stale = connection->isStale();
+        publisher->publish(delta);
+    });
+    connect(connection, &BleRobotConnection::errorOccurred, publisher, [publisher](const QString &error) {
+        LinkDelta delta;
+        delta.fields = LinkDelta::Error;
+        delta.error = error;
+        publisher->publish(delta);
+    });
+
+    connect(connection->rpcClient(), &RpcClient::callFinished, publisher,
+            [publisher](quint16 callId, int method, int status, const QByteArray &payload, qint64 latencyUs) {
+        emit publisher->rpcFinished(publisher->address(), callId, method, status, payload, latencyUs);
+    });
+
+    BulkTransfer *transfer = connection->bulkTransfer();
+    connect(transfer, &BulkTransfer::progressChanged, publisher, [publisher, transfer]() {
+        emit publisher->transferProgress(publisher->address(), transfer->bytesTransferred(),
+                                         transfer->totalBytes(), transfer->throughput());
+    });
+    connect(transfer, &BulkTransfer::finished, publisher,
+            [publisher, connection, transfer](bool success, const QString &error) {
+        emit publisher->transferFinished(publisher->address(), success, error,
+                                         transfer->bytesTransferred(), transfer->throughput(),
+                                         connection->mtu());
+    });
+
+    return publisher;
+}
+
+// ── Simulated ──
+
+LinkPublisher *LinkPublisher::attach(SimulatedLink *link, const QString &address,
+                                     quint64 linkId, QSharedPointer<LinkDeltaQueue> queue)
+{
+    auto *publisher = new LinkPublisher(address, linkId, std::move(queue), link);
+
+    // The link builds complete deltas itself
+    connect(link, &SimulatedLink::changed, publisher, [publisher](const LinkDelta &delta) {
+        publisher->publish(delta);
+    });
+
+    return publisher;
+}
@@ -0,0 +1,70 @@
+#ifndef LINKPUBLISHER_H
+#define LINKPUBLISHER_H
+
+#include <QObject>
+#include <QSharedPointer>
+#include "LinkDelta.h"
+#include "src/models/FleetSnapshot.h"
+
+class BleRobotConnection;
+class JbdBmsConnection;
+class FalconsRobotConnection;
+class SimulatedLink;
+
+/**
+ * LinkPublisher - turns a connection's signals into LinkDeltas.
+ *
+ * Lives next to its connection on the BLE worker (as its child), reads the
+ * connection's getters there and pushes the result into the shared
+ * LinkDeltaQueue. RPC and bulk-transfer results are not state; they are
+ * forwarded as queued signals carrying their values.
+ *
+ * With a FleetSnapshot slot set, every delta also refreshes the link's
+ * RobotSample there, so render-thread gauges see values as they arrive
+ * rather than after the GUI thread has drained the queue.
+ */
+class LinkPublisher : public QObject
+{
+    Q_OBJECT
+
+public:
+    static LinkPublisher *attach(FalconsRobotConnection *connection, const QString &address,
+                                 quint64 linkId, QSharedPointer<LinkDeltaQueue> queue);
+    static LinkPublisher *attach(JbdBmsConnection *connection, const QString &address,
+                                 quint64 linkId, QSharedPointer<LinkDeltaQueue> queue);
+    static LinkPublisher *attach(BleRobotConnection *connection, const QString &address,
+                                 quint64 linkId, QSharedPointer<LinkDeltaQueue> queue);
+    static LinkPublisher *attach(SimulatedLink *link, const QString &address,
+                                 quint64 linkId, QSharedPointer<LinkDeltaQueue> queue);
+
+    ~LinkPublisher();
+
+    QString address() const { return m_address; }
+    quint64 linkId() const { return m_linkId; }
+
+    /** Write this link's samples to a snapshot slot; the slot is released with the publisher */
+    void setSnapshot(QSharedPointer<FleetSnapshot> snapshot, int slot, Robot::DeviceType type);
+
+signals:
+    void rpcFinished(const QString &address, quint16 callId, int method, int status,
+                     const QByteArray &payload, qint64 latencyUs);
+    void transferProgress(const QString &address, qint64 bytes, qint64 total, double bytesPerSecond);
+    void transferFinished(const QString &address, bool success, const QString &error,
+                          qint64 bytes, double bytesPerSecond, int mtu);
+
+private:
+    LinkPublisher(const QString &address, quint64 linkId, QSharedPointer<LinkDeltaQueue> queue,
+                  QObject *parent);
+
+    void publish(LinkDelta delta);
+    void updateSample(const LinkDelta &delta);
+
+    QString m_address;
+    quint64 m_linkId;       // stamped on every delta; the manager drops those of replaced links
+    QSharedPointer<LinkDeltaQueue> m_queue;
+    QSharedPointer<FleetSnapshot> m_snapshot;
+    int m_slot;
+    RobotSample m_sample;
+};
+
+#endif // LINKPUBLISHER_H
@@ -0,0 +1,200 @@
+#include "LinkQualityMonitor.h"
+#include <QDebug>
+#include <cmath>
+
+LinkQualityMonitor::LinkQualityMonitor(TimerWheel *timers, QObject *parent)
+    : QObject(parent)
+    , m_publishTimer(timers)
+    , m_currentBucket(0)
+    , m_received(0)
+    , m_sequenced(0)
+    , m_lost(0)
+    , m_reordered(0)
+    , m_duplicates(0)
+    , m_gaps(0)
+    , m_dirty(false)
+{
+    m_publishTimer.setInterval(PUBLISH_INTERVAL_MS);
+    m_publishTimer.callOnTimeout([this]() { onPublishTimer(); });
+}
+
+void LinkQualityMonitor::start()
+{
+    m_arrivals.clear();
+    m_sequences.clear();
+    m_rateBuckets.clear();
+    m_currentBucket = 0;
+    m_received = 0;
+    m_sequenced = 0;
+    m_lost = 0;
+    m_reordered = 0;
+    m_duplicates = 0;
+    m_gaps = 0;
+    m_dirty = true;
+    m_clock.start();
+    m_publishTimer.start();
+}
+
+void LinkQualityMonitor::stop()
+{
+    m_publishTimer.stop();
+    m_clock.invalidate();
+}
+
+void LinkQualityMonitor::notificationReceived(const QBluetoothUuid &stream)
+{
+    if (!m_clock.isValid()) {
+        return;
+    }
+
+    m_received++;
+    m_currentBucket++;
+    m_dirty = true;
+
+    ArrivalState &state = m_arrivals[stream];
+    const qint64 now = m_clock.elapsed();
+    if (state.lastArrivalMs >= 0) {
+        const double interval = now - state.lastArrivalMs;
+        if (state.intervals == 0) {
+            state.meanIntervalMs = interval;
+        } else {
+            state.meanIntervalMs += (interval - state.meanIntervalMs) / 8.0;
+        }
+        state.jitterMs += (std::abs(interval - state.meanIntervalMs) - state.jitterMs) / 16.0;
+        state.intervals++;
+    }
+    state.lastArrivalMs = now;
+}
+
+void LinkQualityMonitor::sequenceReceived(const QBluetoothUuid &stream, quint16 sequence)
+{
+    if (!m_clock.isValid()) {
+        return;
+    }
+
+    m_dirty = true;
+
+    auto it = m_sequences.find(stream);
+    if (it == m_sequences.end()) {
+        SequenceState state;
+        state.expected = static_cast<quint16>(sequence + 1);
+        m_sequences.insert(stream, state);
+        m_sequenced++;
+        return;
+    }
+
+    SequenceState &state = it.value();
+    const quint16 ahead = static_cast<quint16>(sequence - state.expected);
+
+    if (ahead == 0) {
+        state.expected = static_cast<quint16>(sequence + 1);
+        m_sequenced++;
+    } else if (ahead < 0x8000) {
+        if (ahead > RESTART_THRESHOLD) {
+            qDebug() << "LinkQualityMonitor: Sequence jumped by" << ahead << "- peripheral restarted?";
+            state.missing.clear();
+        } else {
+            // Remember the most recent missing numbers in case they arrive late
+            for (int i = qMax(0, int(ahead) - REORDER_WINDOW); i < ahead; ++i) {
+                state.missing.append(static_cast<quint16>(state.expected + i));
+            }
+            while (state.missing.size() > REORDER_WINDOW) {
+                state.missing.removeFirst();
+            }
+            m_lost += ahead;
+            m_gaps++;
+        }
+        state.expected = static_cast<quint16>(sequence + 1);
+        m_sequenced++;
+    } else {
+        const int behind = 0x10000 - ahead;
+        const int index = state.missing.indexOf(sequence);
+        if (index >= 0) {
+            state.missing.removeAt(index);
+            m_lost--;
+            m_reordered++;
+            m_sequenced++;
+        } else if (behind > RESTART_THRESHOLD) {
+            qDebug() << "LinkQualityMonitor: Sequence went back by" << behind << "- peripheral restarted?";
+            state.missing.clear();
+            state.expected = static_cast<quint16>(sequence + 1);
+            m_sequenced++;
+        } else {
+            m_duplicates++;
+        }
+    }
+}
+
+void LinkQualityMonitor::onPublishTimer()
+{
+    m_rateBuckets.append(m_currentBucket);
+    while (m_rateBuckets.size() > RATE_WINDOW_S) {
+        m_rateBuckets.removeFirst();
+    }
+
+    // Keep publishing while the rate is still decaying after traffic stops
+    const bool rateMoving = m_currentBucket > 0 || m_rateBuckets.first() > 0;
+    m_currentBucket = 0;
+
+    if (m_dirty || rateMoving) {
+        m_dirty = false;
+        emit updated();
+    }
+}
+
+LinkStatistics LinkQualityMonitor::statistics() const
+{
+    LinkStatistics statistics;
+    statistics.sequenced = !m_sequences.isEmpty();
+    statistics.received = m_received;
+    statistics.lost = m_lost;
+    statistics.reordered = m_reordered;
+    statistics.duplicates = m_duplicates;
+    statistics.gaps = m_gaps;
+
+    if (!m_rateBuckets.isEmpty()) {
+        int total = 0;
+        for (int count : m_rateBuckets) {
+            total += count;
+        }
+        statistics.updateRate = double(total) * 1000.0 / (m_rateBuckets.size() * PUBLISH_INTERVAL_MS);
+    }
+
+    if (m_sequenced + m_lost > 0) {
+        statistics.lossPercent = 100.0 * m_lost / (m_sequenced + m_lost);
+    }
+
+    double jitterSum = 0.0;
+    int jitterStreams = 0;
+    for (const ArrivalState &state : m_arrivals) {
+        if (state.intervals >= 2) {
+            jitterSum += state.jitterMs;
+            jitterStreams++;
+        }
+    }
+    if (jitterStreams > 0) {
+        statistics.jitterMs = jitterSum / jitterStreams;
+    }
+
+    return statistics;
+}
+
+QString LinkQualityMonitor::summary() const
+{
+    const LinkStatistics s = statistics();
+    QString text = QStringLiteral("%1 notif/s, jitter %2 ms, %3 received")
+                       .arg(s.updateRate, 0, 'f', 1)
+                       .arg(s.jitterMs, 0, 'f', 1)
+                       .arg(s.received);
+    if (s.sequenced) {
+        text += QStringLiteral(", loss %1% (%2 lost in %3 gaps, %4 reordered, %5 duplicate)")
+                    .arg(s.lossPercent, 0, 'f', 2)
+                    .arg(s.lost)
+                    .arg(s.gaps)
+                    .arg(s.reordered)
+                    .arg(s.duplicates);
+    } else {
+        text += QStringLiteral(", no sequence numbers");
+    }
+    return text;
+}
@@ -0,0 +1,85 @@
+#ifndef LINKQUALITYMONITOR_H
+#define LINKQUALITYMONITOR_H
+
+#include <QObject>
+#include <QBluetoothUuid>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include "TimerWheel.h"
+#include "src/models/Robot.h"
+
+/**
+ * LinkQualityMonitor - notification delivery statistics for one link.
+ *
+ * Every notification is counted per stream (characteristic) for update rate
+ * and inter-arrival jitter. Peripherals that number their notifications also
+ * report each 16-bit sequence number, from which gaps, reordering and
+ * duplicates are derived. A sequence number arriving after it was counted
+ * lost (within REORDER_WINDOW) turns the loss into a reordering; a jump
+ * beyond RESTART_THRESHOLD in either direction is taken as a peripheral
+ * restart and rebases the stream without counting loss.
+ *
+ * Statistics are published through updated() at most once per
+ * PUBLISH_INTERVAL_MS, so the model is not refreshed per notification.
+ */
+class LinkQualityMonitor : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int PUBLISH_INTERVAL_MS = 1000;
+    static constexpr int RATE_WINDOW_S = 5;
+    static constexpr int REORDER_WINDOW = 32;
+    static constexpr int RESTART_THRESHOLD = 1000;
+
+    explicit LinkQualityMonitor(TimerWheel *timers, QObject *parent = nullptr);
+
+    /** Clear all counters (new connection) and start publishing */
+    void start();
+    void stop();
+
+    /** A notification arrived on a stream */
+    void notificationReceived(const QBluetoothUuid &stream);
+
+    /** A notification (or framed packet) on a stream carried this sequence number */
+    void sequenceReceived(const QBluetoothUuid &stream, quint16 sequence);
+
+    LinkStatistics statistics() const;
+    QString summary() const;
+
+signals:
+    void updated();
+
+private slots:
+    void onPublishTimer();
+
+private:
+    struct ArrivalState {
+        qint64 lastArrivalMs = -1;
+        double meanIntervalMs = 0.0;
+        double jitterMs = 0.0;
+        int intervals = 0;
+    };
+
+    struct SequenceState {
+        quint16 expected = 0;
+        QList<quint16> missing;     // most recent REORDER_WINDOW lost numbers
+    };
+
+    WheelTimer m_publishTimer;
+    QElapsedTimer m_clock;
+    QHash<QBluetoothUuid, ArrivalState> m_arrivals;
+    QHash<QBluetoothUuid, SequenceState> m_sequences;
+    QList<int> m_rateBuckets;       // notifications per second, newest last
+    int m_currentBucket;
+    qint64 m_received;
+    qint64 m_sequenced;
+    qint64 m_lost;
+    qint64 m_reordered;
+    qint64 m_duplicates;
+    int m_gaps;
+    bool m_dirty;
+};
+
+#endif // LINKQUALITYMONITOR_H
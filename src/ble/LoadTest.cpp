@@ -0,0 +1,86 @@
+#include "LoadTest.h"
+#include "BleConnectionManager.h"
+#include "src/protocol/MonotonicClock.h"
+#include <QDebug>
+#include <ctime>
+
+namespace {
+
+// CPU time of the whole process, all threads
+qint64 processCpuNs()
+{
+    return qint64(std::clock()) * 1000000000 / CLOCKS_PER_SEC;
+}
+
+}
+
+LoadTest::LoadTest(BleConnectionManager *manager, const QList<int> &deviceCounts, QObject *parent)
+    : QObject(parent)
+    , m_manager(manager)
+    , m_deviceCounts(deviceCounts)
+    , m_step(-1)
+    , m_timer(new QTimer(this))
+    , m_startNs(0)
+    , m_startCpuNs(0)
+    , m_startDropped(0)
+{
+    m_timer->setSingleShot(true);
+}
+
+void LoadTest::start()
+{
+    m_step = -1;
+    m_lines.clear();
+    nextStep();
+}
+
+void LoadTest::nextStep()
+{
+    if (++m_step >= m_deviceCounts.size()) {
+        m_manager->simulateFleet(0);
+        const QString report = m_lines.join('\n');
+        qDebug().noquote() << "LoadTest: Finished\n" + report;
+        emit finished(report);
+        return;
+    }
+
+    const int count = m_deviceCounts.at(m_step);
+    qDebug() << "LoadTest: Simulating" << count << "devices";
+    m_manager->simulateFleet(count);
+
+    m_timer->disconnect();
+    connect(m_timer, &QTimer::timeout, this, &LoadTest::beginMeasuring);
+    m_timer->start(WARMUP_MS);
+}
+
+void LoadTest::beginMeasuring()
+{
+    m_manager->resetDeltaLatency();
+    m_startDropped = m_manager->droppedDeltaCount();
+    m_startCpuNs = processCpuNs();
+    m_startNs = MonotonicClock::nowNs();
+
+    m_timer->disconnect();
+    connect(m_timer, &QTimer::timeout, this, &LoadTest::endMeasuring);
+    m_timer->start(MEASURE_MS);
+}
+
+void LoadTest::endMeasuring()
+{
+    const double wallS = (MonotonicClock::nowNs() - m_startNs) / 1e9;
+    const double cpuS = (processCpuNs() - m_startCpuNs) / 1e9;
+    const LatencyHistogram &latency = m_manager->deltaLatency();
+
+    const QString line = QStringLiteral("%1 devices (%2 requested): CPU %3% of a core, %4 deltas/s, "
+                                        "dropped %5, publish-to-model %6")
+        .arg(m_manager->robotListModel()->count())
+        .arg(m_deviceCounts.at(m_step))
+        .arg(100.0 * cpuS / wallS, 0, 'f', 1)
+        .arg(latency.count() / wallS, 0, 'f', 0)
+        .arg(m_manager->droppedDeltaCount() - m_startDropped)
+        .arg(latency.summary());
+    qDebug().noquote() << "LoadTest:" << line;
+    m_lines.append(line);
+
+    nextStep();
+}
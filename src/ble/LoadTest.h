@@ -0,0 +1,51 @@
+#ifndef LOADTEST_H
+#define LOADTEST_H
+
+#include <QObject>
+#include <QList>
+#include <QStringList>
+#include <QTimer>
+
+class BleConnectionManager;
+
+/**
+ * LoadTest - what the app costs as the fleet grows, on simulated links.
+ *
+ * For each device count in turn, BleConnectionManager::simulateFleet()
+ * brings up that many SimulatedLinks; after WARMUP_MS the test measures for
+ * MEASURE_MS: process CPU time over all threads (worker, GUI, render) as a
+ * share of one core, deltas applied per second, publish-to-model latency
+ * and deltas dropped by the queue. Started with --load-test 16,32,64,96;
+ * finished() carries one line per step.
+ */
+class LoadTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int WARMUP_MS = 3000;
+    static constexpr int MEASURE_MS = 10000;
+
+    LoadTest(BleConnectionManager *manager, const QList<int> &deviceCounts, QObject *parent = nullptr);
+
+    void start();
+
+signals:
+    void finished(const QString &report);
+
+private:
+    void nextStep();
+    void beginMeasuring();
+    void endMeasuring();
+
+    BleConnectionManager *m_manager;
+    QList<int> m_deviceCounts;
+    int m_step;
+    QTimer *m_timer;
+    qint64 m_startNs;           // MonotonicClock
+    qint64 m_startCpuNs;
+    qint64 m_startDropped;
+    QStringList m_lines;
+};
+
+#endif // LOADTEST_H
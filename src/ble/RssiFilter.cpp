@@ -0,0 +1,50 @@
+#include "RssiFilter.h"
+#include <algorithm>
+#include <cmath>
+
+RssiFilter::RssiFilter(double processNoise, double measurementNoise)
+    : m_processNoise(processNoise)
+    , m_measurementNoise(measurementNoise)
+    , m_estimate(0.0)
+    , m_variance(0.0)
+    , m_initialised(false)
+{
+}
+
+void RssiFilter::reset(double initialDbm)
+{
+    m_estimate = initialDbm;
+    m_variance = m_measurementNoise;     // as uncertain as one sample
+    m_initialised = true;
+}
+
+void RssiFilter::reset()
+{
+    m_estimate = 0.0;
+    m_variance = 0.0;
+    m_initialised = false;
+}
+
+double RssiFilter::update(double sampleDbm)
+{
+    if (!m_initialised) {
+        reset(sampleDbm);
+        return m_estimate;
+    }
+
+    // Predict: level unchanged, uncertainty grows
+    m_variance += m_processNoise;
+
+    // Correct
+    const double gain = m_variance / (m_variance + m_measurementNoise);
+    m_estimate += gain * (sampleDbm - m_estimate);
+    m_variance *= (1.0 - gain);
+
+    return m_estimate;
+}
+
+int RssiFilter::linkQuality(double rssiDbm)
+{
+    const double scaled = (rssiDbm - UNUSABLE_DBM) / (EXCELLENT_DBM - UNUSABLE_DBM) * 100.0;
+    return static_cast<int>(std::lround(std::clamp(scaled, 0.0, 100.0)));
+}
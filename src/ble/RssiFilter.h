@@ -0,0 +1,47 @@
+#ifndef RSSIFILTER_H
+#define RSSIFILTER_H
+
+/**
+ * RssiFilter - scalar Kalman filter for RSSI samples (dBm).
+ *
+ * RSSI is modelled as a slowly drifting level (process noise Q per sample)
+ * observed through heavy multipath noise (measurement noise R). With the
+ * defaults the filter settles within a few samples and follows a robot
+ * walking away within seconds while ignoring single-sample fades.
+ */
+class RssiFilter
+{
+public:
+    static constexpr double DEFAULT_PROCESS_NOISE = 1.0;        // dB^2 per sample
+    static constexpr double DEFAULT_MEASUREMENT_NOISE = 16.0;   // (4 dB)^2
+
+    // Link-quality scale: at or above EXCELLENT is 100, at or below UNUSABLE is 0
+    static constexpr double EXCELLENT_DBM = -55.0;
+    static constexpr double UNUSABLE_DBM = -95.0;
+
+    explicit RssiFilter(double processNoise = DEFAULT_PROCESS_NOISE,
+                        double measurementNoise = DEFAULT_MEASUREMENT_NOISE);
+
+    /** Start from a known level (e.g. the advertisement RSSI) */
+    void reset(double initialDbm);
+    void reset();
+
+    /** Feed one sample; returns the new estimate */
+    double update(double sampleDbm);
+
+    bool isInitialised() const { return m_initialised; }
+    double value() const { return m_estimate; }
+    double variance() const { return m_variance; }
+
+    /** 0..100 score for an RSSI level, linear between UNUSABLE_DBM and EXCELLENT_DBM */
+    static int linkQuality(double rssiDbm);
+
+private:
+    double m_processNoise;
+    double m_measurementNoise;
+    double m_estimate;
+    double m_variance;
+    bool m_initialised;
+};
+
+#endif // RSSIFILTER_H
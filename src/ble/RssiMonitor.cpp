@@ -0,0 +1,108 @@
+#include "RssiMonitor.h"
+#include "GattOperationQueue.h"
+#include <QDebug>
+#include <cmath>
+
+RssiMonitor::RssiMonitor(GattOperationQueue *queue, TimerWheel *timers, QObject *parent)
+    : QObject(parent)
+    , m_queue(queue)
+    , m_sampleTimer(timers)
+    , m_readPending(false)
+    , m_deferrals(0)
+    , m_consecutiveErrors(0)
+{
+    m_sampleTimer.setSingleShot(true);
+    m_sampleTimer.callOnTimeout([this]() { onSampleTimer(); });
+}
+
+void RssiMonitor::setController(QLowEnergyController *controller)
+{
+    if (m_controller == controller) {
+        return;
+    }
+
+    if (m_controller) {
+        QObject::disconnect(m_controller, nullptr, this, nullptr);
+    }
+    stop();
+
+    m_controller = controller;
+    if (m_controller) {
+        connect(m_controller, &QLowEnergyController::rssiRead,
+                this, &RssiMonitor::onRssiRead);
+    }
+}
+
+void RssiMonitor::start(int initialRssi)
+{
+    m_filter.reset(initialRssi);
+    m_history.clear();
+    m_history.append(initialRssi);
+    m_readPending = false;
+    m_deferrals = 0;
+    m_consecutiveErrors = 0;
+    m_sampleTimer.startStaggered(SAMPLE_INTERVAL_MS);
+    emit updated();
+}
+
+void RssiMonitor::stop()
+{
+    m_sampleTimer.stop();
+    m_readPending = false;
+}
+
+int RssiMonitor::rssi() const
+{
+    return static_cast<int>(std::lround(m_filter.value()));
+}
+
+void RssiMonitor::onSampleTimer()
+{
+    if (!m_controller || m_controller->state() == QLowEnergyController::UnconnectedState) {
+        return;
+    }
+
+    // Stay out of the way of commands and their responses
+    if (m_queue && !m_queue->isIdle() && m_deferrals < MAX_DEFERRALS) {
+        m_deferrals++;
+        m_sampleTimer.start(DEFER_MS);
+        return;
+    }
+
+    m_deferrals = 0;
+    m_readPending = true;
+    m_controller->readRssi();
+}
+
+void RssiMonitor::onRssiRead(qint16 rssi)
+{
+    if (!m_readPending) {
+        return;
+    }
+
+    m_readPending = false;
+    m_consecutiveErrors = 0;
+
+    m_filter.update(rssi);
+    m_history.append(this->rssi());
+    if (m_history.size() > HISTORY_LENGTH) {
+        m_history.removeFirst();
+    }
+
+    m_sampleTimer.start(SAMPLE_INTERVAL_MS);
+    emit updated();
+}
+
+void RssiMonitor::handleReadError()
+{
+    if (!m_readPending) {
+        return;
+    }
+
+    m_readPending = false;
+    if (++m_consecutiveErrors >= MAX_CONSECUTIVE_ERRORS) {
+        qWarning() << "RssiMonitor: RSSI reads keep failing, sampling stopped";
+        return;
+    }
+    m_sampleTimer.start(SAMPLE_INTERVAL_MS);
+}
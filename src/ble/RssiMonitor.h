@@ -0,0 +1,72 @@
+#ifndef RSSIMONITOR_H
+#define RSSIMONITOR_H
+
+#include <QObject>
+#include <QList>
+#include <QPointer>
+#include <QLowEnergyController>
+#include "RssiFilter.h"
+#include "TimerWheel.h"
+
+class GattOperationQueue;
+
+/**
+ * RssiMonitor - periodic RSSI sampling on a connected link.
+ *
+ * Samples once per SAMPLE_INTERVAL_MS through QLowEnergyController::readRssi(),
+ * feeds them into an RssiFilter and keeps a short history of filtered values
+ * for the dashboard. A sample is put off (up to MAX_DEFERRALS times) while the
+ * link's GATT queue has work in flight, so it never sits between a command and
+ * its response. Sampling stops after repeated read errors (e.g. a backend that
+ * cannot read RSSI on a connection).
+ */
+class RssiMonitor : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int SAMPLE_INTERVAL_MS = 1000;
+    static constexpr int DEFER_MS = 100;
+    static constexpr int MAX_DEFERRALS = 5;
+    static constexpr int MAX_CONSECUTIVE_ERRORS = 5;
+    static constexpr int HISTORY_LENGTH = 60;
+
+    RssiMonitor(GattOperationQueue *queue, TimerWheel *timers, QObject *parent = nullptr);
+
+    void setController(QLowEnergyController *controller);
+
+    /** Start sampling, seeding the filter with a known level (e.g. advertisement RSSI) */
+    void start(int initialRssi);
+    void stop();
+
+    bool isActive() const { return m_sampleTimer.isActive() || m_readPending; }
+
+    /** Filtered RSSI (dBm) */
+    int rssi() const;
+    int linkQuality() const { return RssiFilter::linkQuality(m_filter.value()); }
+
+    /** Filtered RSSI, oldest first, one entry per sample */
+    QList<int> history() const { return m_history; }
+
+    /** Controller reported RssiReadError */
+    void handleReadError();
+
+signals:
+    void updated();
+
+private slots:
+    void onSampleTimer();
+    void onRssiRead(qint16 rssi);
+
+private:
+    GattOperationQueue *m_queue;
+    QPointer<QLowEnergyController> m_controller;
+    WheelTimer m_sampleTimer;
+    RssiFilter m_filter;
+    QList<int> m_history;
+    bool m_readPending;
+    int m_deferrals;
+    int m_consecutiveErrors;
+};
+
+#endif // RSSIMONITOR_H
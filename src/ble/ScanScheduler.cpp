@@ -0,0 +1,187 @@
+#include "ScanScheduler.h"
+#include "src/protocol/MonotonicClock.h"
+#include <QDebug>
+
+ScanScheduler::ScanScheduler(QObject *parent)
+    : QObject(parent)
+    , m_phaseTimer(new QTimer(this))
+    , m_dutyCycles{{ { 4000, 0 },          // Searching
+                     { 2000, 8000 },       // Sparse
+                     { 0, 0 } }}           // Paused
+    , m_profile(Paused)
+    , m_enabled(false)
+    , m_discoveryRequested(false)
+    , m_windowOpen(false)
+    , m_pendingSetups(0)
+    , m_activeLinks(0)
+    , m_backoffLevel(0)
+    , m_lastCongestionMs(-CONGESTION_HOLDOFF_MS)
+    , m_backoffChangedMs(0)
+{
+    m_phaseTimer->setSingleShot(true);
+    connect(m_phaseTimer, &QTimer::timeout, this, &ScanScheduler::onPhaseTimer);
+}
+
+void ScanScheduler::setEnabled(bool enabled)
+{
+    if (m_enabled == enabled) return;
+    m_enabled = enabled;
+    reevaluate();
+}
+
+void ScanScheduler::setDiscoveryRequested(bool requested)
+{
+    if (m_discoveryRequested == requested) return;
+    m_discoveryRequested = requested;
+    reevaluate();
+}
+
+void ScanScheduler::setPendingSetups(int count)
+{
+    if (m_pendingSetups == count) return;
+    m_pendingSetups = count;
+    reevaluate();
+}
+
+void ScanScheduler::setActiveLinks(int count)
+{
+    if (m_activeLinks == count) return;
+    m_activeLinks = count;
+    reevaluate();
+}
+
+void ScanScheduler::setDutyCycle(Profile profile, int onMs, int offMs)
+{
+    if (profile == Paused) return;
+    m_dutyCycles[profile] = { qMax(onMs, 100), qMax(offMs, 0) };
+    if (profile == m_profile && m_windowOpen) {
+        openWindow();       // restart the cycle with the new timing
+    }
+}
+
+void ScanScheduler::reportCongestion()
+{
+    const qint64 now = MonotonicClock::nowMs();
+    if (now - m_lastCongestionMs < CONGESTION_HOLDOFF_MS) {
+        return;
+    }
+    m_lastCongestionMs = now;
+
+    m_backoffChangedMs = now;
+    if (m_backoffLevel < MAX_BACKOFF_LEVEL) {
+        m_backoffLevel++;
+        qDebug() << "ScanScheduler: Link congestion, backoff level" << m_backoffLevel;
+        emit profileChanged();
+    }
+
+    // Give the airtime back right away
+    if (m_windowOpen && effectiveOffMs() > 0) {
+        closeWindow();
+    }
+}
+
+ScanScheduler::Profile ScanScheduler::selectProfile() const
+{
+    if (!m_enabled) return Paused;
+    if (m_discoveryRequested) return Searching;     // the user is waiting on the list
+    if (m_pendingSetups > 0) return Paused;
+    if (m_activeLinks == 0) return Searching;
+    return Sparse;
+}
+
+void ScanScheduler::reevaluate()
+{
+    const Profile next = selectProfile();
+    if (next == m_profile) {
+        return;
+    }
+
+    qDebug() << "ScanScheduler: Profile" << profileName(m_profile) << "->" << profileName(next);
+    m_profile = next;
+    emit profileChanged();
+
+    if (m_profile == Paused) {
+        m_phaseTimer->stop();
+        if (m_windowOpen) {
+            m_windowOpen = false;
+            emit scanRequested(false);
+        }
+        return;
+    }
+    openWindow();
+}
+
+int ScanScheduler::effectiveOffMs() const
+{
+    const int offMs = m_dutyCycles[m_profile].offMs;
+    if (m_backoffLevel == 0) {
+        return offMs;
+    }
+    return qMin(MAX_OFF_MS, qMax(offMs, BACKOFF_BASE_MS) << m_backoffLevel);
+}
+
+void ScanScheduler::decayBackoff()
+{
+    if (m_backoffLevel > 0 && MonotonicClock::nowMs() - m_backoffChangedMs > CONGESTION_COOLDOWN_MS) {
+        m_backoffLevel--;
+        m_backoffChangedMs = MonotonicClock::nowMs();
+        qDebug() << "ScanScheduler: Backoff level" << m_backoffLevel;
+        emit profileChanged();
+    }
+}
+
+void ScanScheduler::openWindow()
+{
+    decayBackoff();
+
+    // Re-requested every window so discovery that ended on its own is restarted
+    m_windowOpen = true;
+    emit scanRequested(true);
+    m_phaseTimer->start(m_dutyCycles[m_profile].onMs);
+}
+
+void ScanScheduler::closeWindow()
+{
+    m_windowOpen = false;
+    emit scanRequested(false);
+    m_phaseTimer->start(effectiveOffMs());
+}
+
+void ScanScheduler::onPhaseTimer()
+{
+    if (m_profile == Paused) {
+        return;
+    }
+
+    if (m_windowOpen && effectiveOffMs() > 0) {
+        closeWindow();
+    } else {
+        openWindow();
+    }
+}
+
+QString ScanScheduler::profileName(Profile profile)
+{
+    switch (profile) {
+    case Searching: return QStringLiteral("Searching");
+    case Sparse:    return QStringLiteral("Sparse");
+    case Paused:    return QStringLiteral("Paused");
+    default:        return QStringLiteral("Unknown");
+    }
+}
+
+QString ScanScheduler::summary() const
+{
+    const DutyCycle cycle = m_dutyCycles[m_profile];
+    if (m_profile == Paused) {
+        return QStringLiteral("Paused");
+    }
+    QString text = effectiveOffMs() == 0
+        ? QStringLiteral("%1, continuous").arg(profileName(m_profile))
+        : QStringLiteral("%1, %2 ms on / %3 ms off").arg(profileName(m_profile))
+              .arg(cycle.onMs).arg(effectiveOffMs());
+    if (m_backoffLevel > 0) {
+        text += QStringLiteral(" (backoff %1)").arg(m_backoffLevel);
+    }
+    return text;
+}
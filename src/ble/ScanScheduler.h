@@ -0,0 +1,102 @@
+#ifndef SCANSCHEDULER_H
+#define SCANSCHEDULER_H
+
+#include <QObject>
+#include <QTimer>
+#include <array>
+
+/**
+ * ScanScheduler - decides when the radio may scan.
+ *
+ * Scanning shares airtime with every live link, so it follows a duty-cycle
+ * profile chosen from what the deck is doing:
+ *   - Searching: nothing connected yet, or the scan tab is open (continuous)
+ *   - Sparse:    links are up; short windows with long gaps
+ *   - Paused:    a link is in GATT setup (avoids HCI contention), unless
+ *                the scan tab is open
+ *
+ * Congestion reports from the links (notification loss, stalled writes)
+ * raise a backoff level that stretches the gaps; it decays one level per
+ * CONGESTION_COOLDOWN_MS without new reports. scanRequested() tells the
+ * scanner to start or stop discovery.
+ */
+class ScanScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Profile {
+        Searching,
+        Sparse,
+        Paused,
+        ProfileCount
+    };
+    Q_ENUM(Profile)
+
+    struct DutyCycle {
+        int onMs;
+        int offMs;          // 0 = scan continuously
+    };
+
+    static constexpr int BACKOFF_BASE_MS = 1000;
+    static constexpr int MAX_BACKOFF_LEVEL = 4;
+    static constexpr int MAX_OFF_MS = 30000;
+    static constexpr int CONGESTION_HOLDOFF_MS = 5000;
+    static constexpr int CONGESTION_COOLDOWN_MS = 30000;
+
+    explicit ScanScheduler(QObject *parent = nullptr);
+
+    /** Master switch (startScan/stopScan) */
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return m_enabled; }
+
+    /** Someone is looking for devices (scan tab open) */
+    void setDiscoveryRequested(bool requested);
+    bool isDiscoveryRequested() const { return m_discoveryRequested; }
+
+    /** Links connected but still in GATT setup, and links that are up */
+    void setPendingSetups(int count);
+    void setActiveLinks(int count);
+
+    /** A link saw loss or backlog; scanning backs off */
+    void reportCongestion();
+
+    void setDutyCycle(Profile profile, int onMs, int offMs);
+    DutyCycle dutyCycle(Profile profile) const { return m_dutyCycles[profile]; }
+
+    Profile profile() const { return m_profile; }
+    int backoffLevel() const { return m_backoffLevel; }
+    bool isScanWindowOpen() const { return m_windowOpen; }
+
+    static QString profileName(Profile profile);
+    QString summary() const;
+
+signals:
+    void scanRequested(bool scan);
+    void profileChanged();          // profile or backoff level
+
+private slots:
+    void onPhaseTimer();
+
+private:
+    Profile selectProfile() const;
+    void reevaluate();
+    void openWindow();
+    void closeWindow();
+    int effectiveOffMs() const;
+    void decayBackoff();
+
+    QTimer *m_phaseTimer;
+    std::array<DutyCycle, ProfileCount> m_dutyCycles;
+    Profile m_profile;
+    bool m_enabled;
+    bool m_discoveryRequested;
+    bool m_windowOpen;
+    int m_pendingSetups;
+    int m_activeLinks;
+    int m_backoffLevel;
+    qint64 m_lastCongestionMs;
+    qint64 m_backoffChangedMs;
+};
+
+#endif // SCANSCHEDULER_H
@@ -0,0 +1,111 @@
+#include "SimulatedLink.h"
+#include "JbdBmsConnection.h"
+#include <QDebug>
+#include <algorithm>
+
+SimulatedLink::SimulatedLink(Robot::DeviceType type, const QString &name, TimerWheel *timers,
+                             QObject *parent)
+    : QObject(parent)
+    , m_type(type)
+    , m_name(name)
+    , m_dataTimer(timers)
+    , m_linkTimer(timers)
+    , m_random(quint32(qHash(name)))
+    , m_rssi(-60)
+    , m_received(0)
+    , m_batteryVoltage(24.5f)
+    , m_totalVoltage(25.2f)
+    , m_current(-8.0f)
+    , m_soc(90.0f)
+{
+    m_dataTimer.callOnTimeout([this]() { publishData(); });
+    m_linkTimer.callOnTimeout([this]() { publishLink(); });
+
+    for (int i = 0; i < CELL_COUNT; ++i) {
+        m_cellVoltages.append(3.6f);
+    }
+}
+
+void SimulatedLink::start()
+{
+    qDebug() << "SimulatedLink: Starting" << m_name << Robot::deviceTypeToString(m_type);
+
+    LinkDelta delta;
+    delta.fields = LinkDelta::State;
+    delta.state = Robot::Ready;
+    delta.name = m_name;
+    emit changed(delta);
+
+    m_dataTimer.startStaggered(m_type == Robot::SmartBMS ? JbdBmsConnection::POLL_INTERVAL_MS
+                                                         : ROBOT_INTERVAL_MS);
+    m_linkTimer.startStaggered(LINK_INTERVAL_MS);
+}
+
+void SimulatedLink::stop()
+{
+    m_dataTimer.stop();
+    m_linkTimer.stop();
+
+    LinkDelta delta;
+    delta.fields = LinkDelta::State;
+    delta.state = Robot::Disconnected;
+    delta.name = m_name;
+    emit changed(delta);
+}
+
+void SimulatedLink::publishData()
+{
+    m_received++;
+
+    LinkDelta delta;
+    if (m_type == Robot::SmartBMS) {
+        m_current = walk(m_current, 0.5f, -20.0f, 0.0f);
+        m_soc = std::max(0.0f, m_soc - 0.01f);
+        float total = 0.0f;
+        for (float &cell : m_cellVoltages) {
+            cell = walk(cell, 0.005f, 3.3f, 4.2f);
+            total += cell;
+        }
+        m_totalVoltage = total;
+
+        delta.fields = LinkDelta::BmsData;
+        delta.totalVoltage = m_totalVoltage;
+        delta.current = m_current;
+        delta.soc = int(m_soc);
+        delta.cellVoltages = m_cellVoltages;
+    } else {
+        m_batteryVoltage = walk(m_batteryVoltage, 0.02f, 22.0f, 25.2f);
+
+        delta.fields = LinkDelta::RobotData;
+        delta.playState = 4;
+        delta.wifiSsid = QStringLiteral("falcons");
+        delta.batteryVoltage = m_batteryVoltage;
+        delta.robotIdentity = m_name;
+        delta.name = m_name;
+    }
+    emit changed(delta);
+}
+
+void SimulatedLink::publishLink()
+{
+    m_rssi = int(walk(float(m_rssi), 2.0f, -90.0f, -40.0f));
+    m_rssiHistory.append(m_rssi);
+    if (m_rssiHistory.size() > RSSI_HISTORY) {
+        m_rssiHistory.removeFirst();
+    }
+
+    LinkDelta delta;
+    delta.fields = LinkDelta::Rssi | LinkDelta::Statistics;
+    delta.rssi = m_rssi;
+    delta.linkQuality = std::clamp((m_rssi + 90) * 2, 0, 100);
+    delta.rssiHistory = m_rssiHistory;
+    delta.statistics.updateRate = 1000.0 / m_dataTimer.interval();
+    delta.statistics.received = m_received;
+    emit changed(delta);
+}
+
+float SimulatedLink::walk(float value, float step, float low, float high)
+{
+    const float delta = float(m_random.bounded(2.0) - 1.0) * step;
+    return std::clamp(value + delta, low, high);
+}
@@ -0,0 +1,66 @@
+#ifndef SIMULATEDLINK_H
+#define SIMULATEDLINK_H
+
+#include <QObject>
+#include <QList>
+#include <QRandomGenerator>
+#include "LinkDelta.h"
+#include "TimerWheel.h"
+#include "src/models/Robot.h"
+
+/**
+ * SimulatedLink - a link with no radio behind it, for load testing.
+ *
+ * Behaves like a Ready connection of its type as seen from the GUI: a
+ * Falcons robot publishes its status every ROBOT_INTERVAL_MS, a BMS a
+ * reading every JbdBmsConnection::POLL_INTERVAL_MS, and both RSSI and link
+ * statistics every LINK_INTERVAL_MS. It lives on the BLE worker, keeps its
+ * timers on the TimerWheel (staggered like real polls) and publishes
+ * through a LinkPublisher, so the delta queue, fleet snapshot, model and
+ * cards do the same work as for a real device. Values are a random walk.
+ */
+class SimulatedLink : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int ROBOT_INTERVAL_MS = 100;
+    static constexpr int LINK_INTERVAL_MS = 1000;
+    static constexpr int CELL_COUNT = 7;
+    static constexpr int RSSI_HISTORY = 60;         // RssiMonitor::HISTORY_LENGTH
+
+    SimulatedLink(Robot::DeviceType type, const QString &name, TimerWheel *timers,
+                  QObject *parent = nullptr);
+
+    /** Go Ready and start publishing (on the worker) */
+    void start();
+
+    /** Stop publishing and report Disconnected */
+    void stop();
+
+signals:
+    /** A change for the link's LinkPublisher */
+    void changed(const LinkDelta &delta);
+
+private:
+    void publishData();
+    void publishLink();
+    float walk(float value, float step, float low, float high);
+
+    Robot::DeviceType m_type;
+    QString m_name;
+    WheelTimer m_dataTimer;
+    WheelTimer m_linkTimer;
+    QRandomGenerator m_random;
+
+    int m_rssi;
+    QList<int> m_rssiHistory;
+    qint64 m_received;
+    float m_batteryVoltage;
+    float m_totalVoltage;
+    float m_current;
+    float m_soc;
+    QList<float> m_cellVoltages;
+};
+
+#endif // SIMULATEDLINK_H
@@ -0,0 +1,63 @@
+#include "StalenessMonitor.h"
+#include "src/protocol/MonotonicClock.h"
+#include <QDebug>
+
+StalenessMonitor::StalenessMonitor(TimerWheel *timers, QObject *parent)
+    : QObject(parent)
+    , m_deadline(timers)
+    , m_lastDataNs(0)
+    , m_timeoutMs(DEFAULT_TIMEOUT_MS)
+    , m_running(false)
+    , m_stale(false)
+{
+    m_deadline.setSingleShot(true);
+    m_deadline.callOnTimeout([this]() { onDeadline(); });
+}
+
+void StalenessMonitor::start(int timeoutMs)
+{
+    m_deadline.stop();
+    m_timeoutMs = timeoutMs;
+    m_running = true;
+    setStale(false);
+}
+
+void StalenessMonitor::stop()
+{
+    m_deadline.stop();
+    m_running = false;
+    setStale(false);
+}
+
+void StalenessMonitor::dataReceived()
+{
+    if (!m_running) {
+        return;
+    }
+
+    m_lastDataNs = MonotonicClock::nowNs();
+    setStale(false);
+    if (!m_deadline.isActive()) {
+        m_deadline.start(m_timeoutMs);
+    }
+}
+
+void StalenessMonitor::onDeadline()
+{
+    const qint64 silentMs = (MonotonicClock::nowNs() - m_lastDataNs) / 1000000;
+    if (silentMs < m_timeoutMs) {
+        m_deadline.start(int(m_timeoutMs - silentMs));
+        return;
+    }
+
+    qWarning() << "StalenessMonitor: No data for" << silentMs << "ms";
+    setStale(true);
+}
+
+void StalenessMonitor::setStale(bool stale)
+{
+    if (m_stale != stale) {
+        m_stale = stale;
+        emit staleChanged();
+    }
+}
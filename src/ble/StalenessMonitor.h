@@ -0,0 +1,50 @@
+#ifndef STALENESSMONITOR_H
+#define STALENESSMONITOR_H
+
+#include <QObject>
+#include "TimerWheel.h"
+
+/**
+ * StalenessMonitor - notices a connected link that has gone quiet.
+ *
+ * The connection reports every value it receives through dataReceived().
+ * Once data has arrived after start(), a link silent for longer than the
+ * timeout is flagged stale until data arrives again. The deadline is not
+ * moved per value: the one wheel timer checks the last arrival when it
+ * expires and re-arms for the remainder, so a link streaming at 50 Hz
+ * touches the TimerWheel about once per timeout.
+ */
+class StalenessMonitor : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int DEFAULT_TIMEOUT_MS = 5000;
+
+    explicit StalenessMonitor(TimerWheel *timers, QObject *parent = nullptr);
+
+    /** Watch a link that just became Ready; the deadline arms with its first value */
+    void start(int timeoutMs = DEFAULT_TIMEOUT_MS);
+
+    /** Stop watching and clear the flag (link lost) */
+    void stop();
+
+    void dataReceived();
+
+    bool isStale() const { return m_stale; }
+
+signals:
+    void staleChanged();
+
+private:
+    void onDeadline();
+    void setStale(bool stale);
+
+    WheelTimer m_deadline;
+    qint64 m_lastDataNs;        // MonotonicClock
+    int m_timeoutMs;
+    bool m_running;
+    bool m_stale;
+};
+
+#endif // STALENESSMONITOR_H
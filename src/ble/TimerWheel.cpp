@@ -0,0 +1,235 @@
+#include "TimerWheel.h"
+#include "src/protocol/MonotonicClock.h"
+#include <QThread>
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+TimerWheel::TimerWheel(QObject *parent)
+    : QObject(parent)
+    , m_timer(new QTimer(this))
+    , m_originNs(MonotonicClock::nowNs())
+    , m_tick(0)
+    , m_wakeTick(0)
+    , m_nextId(0)
+{
+    m_timer->setSingleShot(true);
+    m_timer->setTimerType(Qt::PreciseTimer);
+    connect(m_timer, &QTimer::timeout, this, &TimerWheel::onTick);
+}
+
+TimerWheel::TimerId TimerWheel::add(int delayMs, std::function<void()> callback)
+{
+    Q_ASSERT(QThread::currentThread() == thread());
+
+    if (m_entries.isEmpty()) {
+        // Nothing is waiting, so the ticks slept through need no processing
+        m_tick = std::max(m_tick, clockTick());
+    }
+
+    // First tick boundary at or after the due time
+    const qint64 dueNs = MonotonicClock::nowNs() - m_originNs + qint64(std::max(0, delayMs)) * 1000000;
+    const qint64 deadline = std::max((dueNs + TICK_NS - 1) / TICK_NS, m_tick + 1);
+
+    const TimerId id = ++m_nextId;
+    Entry &entry = m_entries[id];
+    entry.deadline = deadline;
+    entry.callback = std::move(callback);
+    place(id, entry);
+
+    if (!m_timer->isActive() || deadline < m_wakeTick) {
+        scheduleWake();
+    }
+    return id;
+}
+
+void TimerWheel::cancel(TimerId id)
+{
+    Q_ASSERT(QThread::currentThread() == thread());
+
+    const auto it = m_entries.find(id);
+    if (it == m_entries.end()) {
+        return;
+    }
+    m_slots[it->slot].removeOne(id);
+    m_entries.erase(it);
+
+    if (m_entries.isEmpty()) {
+        m_timer->stop();
+    }
+}
+
+int TimerWheel::staggerDelay(int periodMs)
+{
+    if (periodMs <= 0) {
+        return 0;
+    }
+
+    // Fibonacci hashing: k * 2^32 / phi, taken as a fraction of the period
+    const quint32 k = m_staggerCounts[periodMs]++;
+    const quint64 fraction = quint32(k * 2654435769u);
+    return int((fraction * quint64(periodMs)) >> 32);
+}
+
+void TimerWheel::onTick()
+{
+    advanceTo(clockTick());
+    scheduleWake();
+}
+
+qint64 TimerWheel::clockTick() const
+{
+    return (MonotonicClock::nowNs() - m_originNs) / TICK_NS;
+}
+
+int TimerWheel::slotFor(qint64 deadline) const
+{
+    const qint64 delta = deadline - m_tick;
+    if (delta < LEVEL0_SLOTS) {
+        return int(deadline & (LEVEL0_SLOTS - 1));
+    }
+
+    int shift = LEVEL0_BITS;
+    int base = LEVEL0_SLOTS;
+    for (int level = 1; level < LEVELS - 1; ++level) {
+        if (delta < (qint64(1) << (shift + LEVEL_BITS))) {
+            return base + int((deadline >> shift) & (LEVEL_SLOTS - 1));
+        }
+        shift += LEVEL_BITS;
+        base += LEVEL_SLOTS;
+    }
+
+    // Beyond the last level's turn: park in its furthest slot and re-place on cascade
+    const qint64 horizon = m_tick + (qint64(1) << (shift + LEVEL_BITS)) - 1;
+    return base + int((std::min(deadline, horizon) >> shift) & (LEVEL_SLOTS - 1));
+}
+
+void TimerWheel::place(TimerId id, Entry &entry)
+{
+    entry.slot = slotFor(entry.deadline);
+    m_slots[entry.slot].append(id);
+}
+
+void TimerWheel::cascade(int level)
+{
+    const int shift = LEVEL0_BITS + (level - 1) * LEVEL_BITS;
+    const int base = LEVEL0_SLOTS + (level - 1) * LEVEL_SLOTS;
+    const QList<TimerId> ids = std::exchange(m_slots[base + int((m_tick >> shift) & (LEVEL_SLOTS - 1))], {});
+    for (TimerId id : ids) {
+        const auto it = m_entries.find(id);
+        if (it != m_entries.end()) {
+            place(id, *it);
+        }
+    }
+}
+
+void TimerWheel::advanceTo(qint64 tick)
+{
+    while (m_tick < tick) {
+        ++m_tick;
+
+        // Level 0 wrapped: bring down whatever falls due in its next turn, highest level first
+        if ((m_tick & (LEVEL0_SLOTS - 1)) == 0) {
+            for (int level = LEVELS - 1; level >= 1; --level) {
+                const int shift = LEVEL0_BITS + (level - 1) * LEVEL_BITS;
+                if ((m_tick & ((qint64(1) << shift) - 1)) == 0) {
+                    cascade(level);
+                }
+            }
+        }
+
+        const QList<TimerId> due = std::exchange(m_slots[m_tick & (LEVEL0_SLOTS - 1)], {});
+        for (TimerId id : due) {
+            // An earlier callback in this tick may have cancelled it
+            const auto it = m_entries.find(id);
+            if (it == m_entries.end()) {
+                continue;
+            }
+            const std::function<void()> callback = std::move(it->callback);
+            m_entries.erase(it);
+            callback();
+        }
+    }
+}
+
+void TimerWheel::scheduleWake()
+{
+    if (m_entries.isEmpty()) {
+        m_timer->stop();
+        return;
+    }
+
+    // Next occupied level-0 slot in this turn, else the wrap where a cascade may fill one
+    const qint64 wrap = (m_tick | (LEVEL0_SLOTS - 1)) + 1;
+    qint64 next = m_tick + 1;
+    while (next < wrap && m_slots[next & (LEVEL0_SLOTS - 1)].isEmpty()) {
+        ++next;
+    }
+
+    m_wakeTick = next;
+    const qint64 delayNs = m_originNs + next * TICK_NS - MonotonicClock::nowNs();
+    const qint64 delayMs = std::clamp<qint64>((delayNs + 999999) / 1000000, 0,
+                                              std::numeric_limits<int>::max());
+    m_timer->start(int(delayMs));
+}
+
+// ── WheelTimer ──
+
+WheelTimer::WheelTimer(TimerWheel *wheel)
+    : m_wheel(wheel)
+    , m_id(0)
+    , m_interval(0)
+    , m_singleShot(false)
+{
+}
+
+WheelTimer::~WheelTimer()
+{
+    stop();
+}
+
+void WheelTimer::setWheel(TimerWheel *wheel)
+{
+    Q_ASSERT(!isActive());
+    m_wheel = wheel;
+}
+
+void WheelTimer::start()
+{
+    Q_ASSERT(m_wheel);
+    stop();
+    m_id = m_wheel->add(m_interval, [this]() { fire(); });
+}
+
+void WheelTimer::start(int ms)
+{
+    m_interval = ms;
+    start();
+}
+
+void WheelTimer::startStaggered(int periodMs)
+{
+    Q_ASSERT(m_wheel);
+    stop();
+    m_interval = periodMs;
+    m_id = m_wheel->add(m_wheel->staggerDelay(periodMs), [this]() { fire(); });
+}
+
+void WheelTimer::stop()
+{
+    if (m_id != 0) {
+        m_wheel->cancel(m_id);
+        m_id = 0;
+    }
+}
+
+void WheelTimer::fire()
+{
+    m_id = 0;
+    if (!m_singleShot) {
+        start();
+    }
+    if (m_callback) {
+        m_callback();
+    }
+}
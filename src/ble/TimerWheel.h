@@ -0,0 +1,137 @@
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QTimer>
+#include <array>
+#include <functional>
+
+/**
+ * TimerWheel - every deadline on the BLE worker behind one QTimer.
+ *
+ * A hierarchical timing wheel with TICK_MS resolution: LEVEL0_SLOTS slots of
+ * one tick, then LEVELS - 1 levels of LEVEL_SLOTS slots, each slot spanning a
+ * full turn of the level below (turns of about 2.6 s, 2.7 min and 2.9 h;
+ * longer delays wait in the last level and are re-placed). Adding a timer
+ * is O(1) and cancelling one only searches its slot; entries move down a
+ * level when their slot comes round, so each is touched at most LEVELS
+ * times before it fires.
+ * The QTimer sleeps until the next occupied tick and stops while the wheel
+ * is empty, so hundreds of poll ticks, request timeouts and staleness
+ * deadlines cost one wake-up per due tick rather than one QTimer each.
+ *
+ * Deadlines come from MonotonicClock and never fire early; they fire at the
+ * first tick boundary at or after the requested time. Only used from the
+ * thread the wheel lives on (the BLE worker).
+ */
+class TimerWheel : public QObject
+{
+    Q_OBJECT
+
+public:
+    using TimerId = quint64;
+
+    static constexpr int TICK_MS = 10;
+    static constexpr int LEVEL0_BITS = 8;
+    static constexpr int LEVEL_BITS = 6;
+    static constexpr int LEVELS = 3;
+    static constexpr int LEVEL0_SLOTS = 1 << LEVEL0_BITS;
+    static constexpr int LEVEL_SLOTS = 1 << LEVEL_BITS;
+
+    explicit TimerWheel(QObject *parent = nullptr);
+
+    /** Call callback once after delayMs; returns a non-zero id for cancel() */
+    TimerId add(int delayMs, std::function<void()> callback);
+
+    /** Drop a pending timer; unknown or already fired ids are ignored */
+    void cancel(TimerId id);
+
+    /**
+     * First delay for the next periodic timer of periodMs. Successive calls
+     * for one period step through it by the golden ratio, so links that turn
+     * Ready together still poll at phases spread across the period.
+     */
+    int staggerDelay(int periodMs);
+
+    int pendingCount() const { return m_entries.size(); }
+
+private slots:
+    void onTick();
+
+private:
+    struct Entry {
+        qint64 deadline = 0;        // tick
+        int slot = -1;
+        std::function<void()> callback;
+    };
+
+    static constexpr int SLOT_COUNT = LEVEL0_SLOTS + (LEVELS - 1) * LEVEL_SLOTS;
+    static constexpr qint64 TICK_NS = qint64(TICK_MS) * 1000000;
+
+    qint64 clockTick() const;
+    int slotFor(qint64 deadline) const;
+    void place(TimerId id, Entry &entry);
+    void cascade(int level);
+    void advanceTo(qint64 tick);
+    void scheduleWake();
+
+    QTimer *m_timer;
+    qint64 m_originNs;
+    qint64 m_tick;                  // last tick processed
+    qint64 m_wakeTick;              // tick m_timer is set for
+    TimerId m_nextId;
+    QHash<TimerId, Entry> m_entries;
+    QHash<int, quint32> m_staggerCounts;        // by period
+    std::array<QList<TimerId>, SLOT_COUNT> m_slots;
+};
+
+/**
+ * WheelTimer - a QTimer-like handle on a TimerWheel.
+ *
+ * Held by value in the object that owns the deadline; stopping or destroying
+ * the handle cancels it. The wheel may be set after construction (objects
+ * are built on the GUI thread and adopted by the worker), but the timer must
+ * only be started there.
+ */
+class WheelTimer
+{
+public:
+    explicit WheelTimer(TimerWheel *wheel = nullptr);
+    ~WheelTimer();
+
+    void setWheel(TimerWheel *wheel);
+
+    /** Callback for every expiry; it may restart, stop or re-time the timer */
+    void callOnTimeout(std::function<void()> callback) { m_callback = std::move(callback); }
+
+    void setInterval(int ms) { m_interval = ms; }
+    int interval() const { return m_interval; }
+
+    void setSingleShot(bool singleShot) { m_singleShot = singleShot; }
+    bool isSingleShot() const { return m_singleShot; }
+
+    /** (Re)start with the current interval, or with a new one */
+    void start();
+    void start(int ms);
+
+    /** Start with interval periodMs, first expiring at the wheel's staggered phase for it */
+    void startStaggered(int periodMs);
+    void stop();
+
+    bool isActive() const { return m_id != 0; }
+
+private:
+    Q_DISABLE_COPY(WheelTimer)
+
+    void fire();
+
+    TimerWheel *m_wheel;
+    std::function<void()> m_callback;
+    TimerWheel::TimerId m_id;
+    int m_interval;
+    bool m_singleShot;
+};
+
+#endif // TIMERWHEEL_H
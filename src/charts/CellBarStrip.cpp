@@ -0,0 +1,94 @@
+#include "CellBarStrip.h"
+#include "QuadBatchNode.h"
+
+CellBarStrip::CellBarStrip(QQuickItem *parent)
+    : TelemetryItem(parent)
+    , m_minimumVoltage(2.5)
+    , m_maximumVoltage(4.2)
+    , m_spacing(2.0)
+    , m_trackColor(QStringLiteral("#252525"))
+    , m_color(QStringLiteral("#4caf50"))
+    , m_warningColor(QStringLiteral("#ff9800"))
+    , m_criticalColor(QStringLiteral("#f44336"))
+{
+}
+
+void CellBarStrip::setMinimumVoltage(qreal voltage)
+{
+    if (qFuzzyCompare(m_minimumVoltage, voltage))
+        return;
+    m_minimumVoltage = voltage;
+    invalidateLayout();
+    emit rangeChanged();
+}
+
+void CellBarStrip::setMaximumVoltage(qreal voltage)
+{
+    if (qFuzzyCompare(m_maximumVoltage, voltage))
+        return;
+    m_maximumVoltage = voltage;
+    invalidateLayout();
+    emit rangeChanged();
+}
+
+void CellBarStrip::setSpacing(qreal spacing)
+{
+    if (qFuzzyCompare(m_spacing, spacing))
+        return;
+    m_spacing = spacing;
+    invalidateLayout();
+    emit spacingChanged();
+}
+
+void CellBarStrip::setColorProperty(QColor &member, const QColor &color)
+{
+    if (member == color)
+        return;
+    member = color;
+    invalidateLayout();
+    emit colorsChanged();
+}
+
+void CellBarStrip::setTrackColor(const QColor &color) { setColorProperty(m_trackColor, color); }
+void CellBarStrip::setColor(const QColor &color) { setColorProperty(m_color, color); }
+void CellBarStrip::setWarningColor(const QColor &color) { setColorProperty(m_warningColor, color); }
+void CellBarStrip::setCriticalColor(const QColor &color) { setColorProperty(m_criticalColor, color); }
+
+QSGNode *CellBarStrip::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data)
+{
+    Q_UNUSED(data)
+    // Quads 0..MAX_CELLS-1 are tracks, MAX_CELLS.. the fills
+    auto *node = static_cast<QuadBatchNode*>(oldNode);
+    if (!node) {
+        node = new QuadBatchNode(window(), 2 * RobotSample::MAX_CELLS);
+    }
+    takeLayoutDirty();
+
+    RobotSample sample;
+    const int cells = readSample(sample) ? sample.cellCount : 0;
+    const qreal range = m_maximumVoltage - m_minimumVoltage;
+    const qreal barWidth = cells > 0 ? (width() - (cells - 1) * m_spacing) / cells : 0.0;
+
+    // Unchanged quads are skipped by the node, so only moved fills cost vertices
+    for (int i = 0; i < RobotSample::MAX_CELLS; ++i) {
+        if (i >= cells || barWidth <= 0) {
+            node->clear(i);
+            node->clear(RobotSample::MAX_CELLS + i);
+            continue;
+        }
+
+        const qreal x = i * (barWidth + m_spacing);
+        const qreal fraction = range > 0
+            ? qBound<qreal>(0.0, (sample.cellVoltages[i] - m_minimumVoltage) / range, 1.0) : 0.0;
+        const QColor &fill = fraction > WARNING_FRACTION ? m_color
+                           : fraction > CRITICAL_FRACTION ? m_warningColor : m_criticalColor;
+        const qreal fillHeight = fraction * height();
+
+        node->setBar(i, QRectF(x, 0, barWidth, height()), m_trackColor);
+        node->setBar(RobotSample::MAX_CELLS + i,
+                     QRectF(x, height() - fillHeight, barWidth, fillHeight), fill);
+    }
+
+    node->commit();
+    return node;
+}
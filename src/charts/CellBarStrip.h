@@ -0,0 +1,71 @@
+#ifndef CELLBARSTRIP_H
+#define CELLBARSTRIP_H
+
+#include <QColor>
+#include "TelemetryItem.h"
+
+class QuadBatchNode;
+
+/**
+ * CellBarStrip - one vertical bar per BMS cell, filled by its voltage.
+ *
+ * Every cell is a track quad and a fill quad in one QuadBatchNode; a new
+ * sample rewrites only the fills of cells whose voltage moved.
+ */
+class CellBarStrip : public TelemetryItem
+{
+    Q_OBJECT
+    QML_ELEMENT
+    Q_PROPERTY(qreal minimumVoltage READ minimumVoltage WRITE setMinimumVoltage NOTIFY rangeChanged)
+    Q_PROPERTY(qreal maximumVoltage READ maximumVoltage WRITE setMaximumVoltage NOTIFY rangeChanged)
+    Q_PROPERTY(qreal spacing READ spacing WRITE setSpacing NOTIFY spacingChanged)
+    Q_PROPERTY(QColor trackColor READ trackColor WRITE setTrackColor NOTIFY colorsChanged)
+    Q_PROPERTY(QColor color READ color WRITE setColor NOTIFY colorsChanged)
+    Q_PROPERTY(QColor warningColor READ warningColor WRITE setWarningColor NOTIFY colorsChanged)
+    Q_PROPERTY(QColor criticalColor READ criticalColor WRITE setCriticalColor NOTIFY colorsChanged)
+
+public:
+    // Fill fractions below which a cell is drawn in warningColor / criticalColor
+    static constexpr qreal WARNING_FRACTION = 0.60;
+    static constexpr qreal CRITICAL_FRACTION = 0.25;
+
+    explicit CellBarStrip(QQuickItem *parent = nullptr);
+
+    qreal minimumVoltage() const { return m_minimumVoltage; }
+    void setMinimumVoltage(qreal voltage);
+    qreal maximumVoltage() const { return m_maximumVoltage; }
+    void setMaximumVoltage(qreal voltage);
+
+    qreal spacing() const { return m_spacing; }
+    void setSpacing(qreal spacing);
+
+    QColor trackColor() const { return m_trackColor; }
+    void setTrackColor(const QColor &color);
+    QColor color() const { return m_color; }
+    void setColor(const QColor &color);
+    QColor warningColor() const { return m_warningColor; }
+    void setWarningColor(const QColor &color);
+    QColor criticalColor() const { return m_criticalColor; }
+    void setCriticalColor(const QColor &color);
+
+signals:
+    void rangeChanged();
+    void spacingChanged();
+    void colorsChanged();
+
+protected:
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
+
+private:
+    void setColorProperty(QColor &member, const QColor &color);
+
+    qreal m_minimumVoltage;
+    qreal m_maximumVoltage;
+    qreal m_spacing;
+    QColor m_trackColor;
+    QColor m_color;
+    QColor m_warningColor;
+    QColor m_criticalColor;
+};
+
+#endif // CELLBARSTRIP_H
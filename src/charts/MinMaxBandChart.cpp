@@ -0,0 +1,149 @@
+#include "MinMaxBandChart.h"
+#include "QuadBatchNode.h"
+
+static constexpr qreal MIN_BAND_HEIGHT = 1.0;
+
+MinMaxBandChart::MinMaxBandChart(QQuickItem *parent)
+    : TelemetryItem(parent)
+    , m_channel(Current)
+    , m_minimum(-10.0)
+    , m_maximum(10.0)
+    , m_capacity(DEFAULT_CAPACITY)
+    , m_bucketMs(DEFAULT_BUCKET_MS)
+    , m_color(QStringLiteral("#2196f3"))
+    , m_current(0)
+    , m_lastBucket(-1)
+{
+}
+
+void MinMaxBandChart::setChannel(Channel channel)
+{
+    if (m_channel == channel)
+        return;
+    m_channel = channel;
+    invalidateLayout();
+    emit channelChanged();
+}
+
+void MinMaxBandChart::setMinimum(qreal minimum)
+{
+    if (qFuzzyCompare(m_minimum, minimum))
+        return;
+    m_minimum = minimum;
+    invalidateLayout();
+    emit rangeChanged();
+}
+
+void MinMaxBandChart::setMaximum(qreal maximum)
+{
+    if (qFuzzyCompare(m_maximum, maximum))
+        return;
+    m_maximum = maximum;
+    invalidateLayout();
+    emit rangeChanged();
+}
+
+void MinMaxBandChart::setCapacity(int capacity)
+{
+    capacity = qMax(capacity, 2);
+    if (m_capacity == capacity)
+        return;
+    m_capacity = capacity;
+    invalidateLayout();
+    emit capacityChanged();
+}
+
+void MinMaxBandChart::setBucketMs(int ms)
+{
+    ms = qMax(ms, TICK_MS);
+    if (m_bucketMs == ms)
+        return;
+    m_bucketMs = ms;
+    invalidateLayout();
+    emit bucketMsChanged();
+}
+
+void MinMaxBandChart::setColor(const QColor &color)
+{
+    if (m_color == color)
+        return;
+    m_color = color;
+    invalidateLayout();
+    emit colorChanged();
+}
+
+qreal MinMaxBandChart::yFor(float value) const
+{
+    const qreal range = m_maximum - m_minimum;
+    const qreal fraction = range != 0 ? qBound<qreal>(0.0, (value - m_minimum) / range, 1.0) : 0.5;
+    return (1.0 - fraction) * height();
+}
+
+void MinMaxBandChart::drawBucket(QuadBatchNode *node, int index) const
+{
+    const Bucket &bucket = m_buckets[index];
+    if (!bucket.used) {
+        node->clear(index);
+        return;
+    }
+
+    const qreal slot = width() / m_capacity;
+    const qreal top = yFor(bucket.high);
+    const qreal bottom = qMax(yFor(bucket.low), top + MIN_BAND_HEIGHT);
+    node->setBar(index, QRectF(index * slot, top, qMax<qreal>(slot - 1.0, 1.0), bottom - top), m_color);
+}
+
+QSGNode *MinMaxBandChart::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data)
+{
+    Q_UNUSED(data)
+    auto *node = static_cast<QuadBatchNode*>(oldNode);
+    bool relayout = takeLayoutDirty();
+
+    if (!node || node->count() != m_capacity) {
+        delete node;
+        node = new QuadBatchNode(window(), m_capacity);
+        relayout = true;
+    }
+    if (relayout) {
+        m_buckets.assign(m_capacity, Bucket());
+        m_current = 0;
+        m_lastBucket = -1;
+        for (int i = 0; i < m_capacity; ++i) {
+            node->clear(i);
+        }
+    }
+
+    RobotSample sample;
+    if (readSample(sample)) {
+        const float value = channelValue(sample, m_channel);
+        const qint64 bucket = sample.updatedNs / (qint64(m_bucketMs) * 1000000);
+
+        if (m_lastBucket >= 0 && bucket != m_lastBucket) {
+            // Buckets that saw no sample stay empty; at most a full sweep
+            const qint64 steps = qMin<qint64>(bucket - m_lastBucket, m_capacity);
+            for (qint64 i = 0; i < steps; ++i) {
+                m_current = (m_current + 1) % m_capacity;
+                m_buckets[m_current] = Bucket();
+                drawBucket(node, m_current);
+            }
+
+            // Gap ahead of the bucket being filled
+            const int next = (m_current + 1) % m_capacity;
+            m_buckets[next] = Bucket();
+            drawBucket(node, next);
+        }
+        m_lastBucket = bucket;
+
+        Bucket &current = m_buckets[m_current];
+        if (!current.used) {
+            current = { value, value, true };
+        } else {
+            current.low = qMin(current.low, value);
+            current.high = qMax(current.high, value);
+        }
+        drawBucket(node, m_current);
+    }
+
+    node->commit();
+    return node;
+}
@@ -0,0 +1,86 @@
+#ifndef MINMAXBANDCHART_H
+#define MINMAXBANDCHART_H
+
+#include <QColor>
+#include <vector>
+#include "TelemetryItem.h"
+
+class QuadBatchNode;
+
+/**
+ * MinMaxBandChart - lowest and highest value of a channel per time bucket.
+ *
+ * Each bucketMs gets a bar from its minimum to its maximum, so spikes that a
+ * sparkline would sample past stay visible (current draw, RSSI fades). Like
+ * Sparkline it sweeps: only the bar of the current bucket and the gap after it
+ * are rewritten.
+ */
+class MinMaxBandChart : public TelemetryItem
+{
+    Q_OBJECT
+    QML_ELEMENT
+    Q_PROPERTY(Channel channel READ channel WRITE setChannel NOTIFY channelChanged)
+    Q_PROPERTY(qreal minimum READ minimum WRITE setMinimum NOTIFY rangeChanged)
+    Q_PROPERTY(qreal maximum READ maximum WRITE setMaximum NOTIFY rangeChanged)
+    Q_PROPERTY(int capacity READ capacity WRITE setCapacity NOTIFY capacityChanged)
+    Q_PROPERTY(int bucketMs READ bucketMs WRITE setBucketMs NOTIFY bucketMsChanged)
+    Q_PROPERTY(QColor color READ color WRITE setColor NOTIFY colorChanged)
+
+public:
+    static constexpr int DEFAULT_CAPACITY = 60;
+    static constexpr int DEFAULT_BUCKET_MS = 1000;
+
+    explicit MinMaxBandChart(QQuickItem *parent = nullptr);
+
+    Channel channel() const { return m_channel; }
+    void setChannel(Channel channel);
+
+    qreal minimum() const { return m_minimum; }
+    void setMinimum(qreal minimum);
+    qreal maximum() const { return m_maximum; }
+    void setMaximum(qreal maximum);
+
+    /** Buckets across the width */
+    int capacity() const { return m_capacity; }
+    void setCapacity(int capacity);
+
+    int bucketMs() const { return m_bucketMs; }
+    void setBucketMs(int ms);
+
+    QColor color() const { return m_color; }
+    void setColor(const QColor &color);
+
+signals:
+    void channelChanged();
+    void rangeChanged();
+    void capacityChanged();
+    void bucketMsChanged();
+    void colorChanged();
+
+protected:
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
+
+private:
+    struct Bucket {
+        float low = 0.0f;
+        float high = 0.0f;
+        bool used = false;
+    };
+
+    qreal yFor(float value) const;
+    void drawBucket(QuadBatchNode *node, int index) const;
+
+    Channel m_channel;
+    qreal m_minimum;
+    qreal m_maximum;
+    int m_capacity;
+    int m_bucketMs;
+    QColor m_color;
+
+    // Render thread only
+    std::vector<Bucket> m_buckets;
+    int m_current;                  // bucket being filled
+    qint64 m_lastBucket;
+};
+
+#endif // MINMAXBANDCHART_H
@@ -0,0 +1,130 @@
+#include "QuadBatchNode.h"
+#include <QQuickWindow>
+#include <QSGGeometryNode>
+#include <QSGRectangleNode>
+#include <QSGRendererInterface>
+#include <QSGVertexColorMaterial>
+#include <algorithm>
+#include <cmath>
+
+static constexpr int VERTICES_PER_QUAD = 6;
+
+bool QuadBatchNode::Quad::operator==(const Quad &other) const
+{
+    return color == other.color
+        && std::equal(std::begin(corners), std::end(corners), std::begin(other.corners));
+}
+
+QuadBatchNode::QuadBatchNode(QQuickWindow *window, int count)
+    : m_count(qMax(count, 0))
+    , m_quads(m_count)
+    , m_geometryNode(nullptr)
+    , m_dirty(false)
+{
+    const bool software = window->rendererInterface()->graphicsApi() == QSGRendererInterface::Software;
+    if (software) {
+        m_rectangles.reserve(m_count);
+        for (int i = 0; i < m_count; ++i) {
+            QSGRectangleNode *rectangle = window->createRectangleNode();
+            rectangle->setRect(QRectF());
+            rectangle->setColor(Qt::transparent);
+            appendChildNode(rectangle);
+            m_rectangles.append(rectangle);
+        }
+        return;
+    }
+
+    auto *geometry = new QSGGeometry(QSGGeometry::defaultAttributes_ColoredPoint2D(),
+                                     m_count * VERTICES_PER_QUAD);
+    geometry->setDrawingMode(QSGGeometry::DrawTriangles);
+    geometry->setVertexDataPattern(QSGGeometry::DynamicPattern);
+    std::fill_n(geometry->vertexDataAsColoredPoint2D(), geometry->vertexCount(),
+                QSGGeometry::ColoredPoint2D{0, 0, 0, 0, 0, 0});
+
+    m_geometryNode = new QSGGeometryNode();
+    m_geometryNode->setGeometry(geometry);
+    m_geometryNode->setFlag(QSGNode::OwnsGeometry);
+    m_geometryNode->setMaterial(new QSGVertexColorMaterial());
+    m_geometryNode->setFlag(QSGNode::OwnsMaterial);
+    appendChildNode(m_geometryNode);
+}
+
+void QuadBatchNode::setBar(int index, const QRectF &rect, const QColor &color)
+{
+    Quad quad;
+    quad.corners[0] = rect.topLeft();
+    quad.corners[1] = rect.topRight();
+    quad.corners[2] = rect.bottomRight();
+    quad.corners[3] = rect.bottomLeft();
+    quad.color = color;
+    setQuad(index, quad);
+}
+
+void QuadBatchNode::setSegment(int index, const QPointF &from, const QPointF &to, qreal width,
+                               const QColor &color)
+{
+    // Offset both ends perpendicular to the segment by half the width
+    const QPointF direction = to - from;
+    const qreal length = std::hypot(direction.x(), direction.y());
+    const QPointF normal = length > 0 ? QPointF(-direction.y(), direction.x()) * (width / 2 / length)
+                                      : QPointF(0, width / 2);
+    Quad quad;
+    quad.corners[0] = from - normal;
+    quad.corners[1] = to - normal;
+    quad.corners[2] = to + normal;
+    quad.corners[3] = from + normal;
+    quad.color = color;
+    setQuad(index, quad);
+}
+
+void QuadBatchNode::clear(int index)
+{
+    setQuad(index, Quad());
+}
+
+void QuadBatchNode::setQuad(int index, const Quad &quad)
+{
+    if (index < 0 || index >= m_count || m_quads[index] == quad) {
+        return;
+    }
+    m_quads[index] = quad;
+
+    if (!m_geometryNode) {
+        qreal left = quad.corners[0].x(), right = left;
+        qreal top = quad.corners[0].y(), bottom = top;
+        for (const QPointF &corner : quad.corners) {
+            left = qMin(left, corner.x());
+            right = qMax(right, corner.x());
+            top = qMin(top, corner.y());
+            bottom = qMax(bottom, corner.y());
+        }
+        m_rectangles[index]->setRect(QRectF(left, top, right - left, bottom - top));
+        m_rectangles[index]->setColor(quad.color.isValid() ? quad.color : QColor(Qt::transparent));
+        return;
+    }
+
+    // Two triangles, premultiplied colour as QSGVertexColorMaterial expects
+    const QColor color = quad.color.isValid() ? quad.color : QColor(Qt::transparent);
+    const float alpha = color.alphaF();
+    const uchar r = uchar(color.red() * alpha);
+    const uchar g = uchar(color.green() * alpha);
+    const uchar b = uchar(color.blue() * alpha);
+    const uchar a = uchar(color.alpha());
+
+    static constexpr int ORDER[VERTICES_PER_QUAD] = { 0, 1, 2, 0, 2, 3 };
+    QSGGeometry::ColoredPoint2D *vertices =
+        m_geometryNode->geometry()->vertexDataAsColoredPoint2D() + index * VERTICES_PER_QUAD;
+    for (int i = 0; i < VERTICES_PER_QUAD; ++i) {
+        const QPointF &corner = quad.corners[ORDER[i]];
+        vertices[i].set(float(corner.x()), float(corner.y()), r, g, b, a);
+    }
+    m_dirty = true;
+}
+
+void QuadBatchNode::commit()
+{
+    if (m_geometryNode && m_dirty) {
+        m_geometryNode->markDirty(QSGNode::DirtyGeometry);
+    }
+    m_dirty = false;
+}
@@ -0,0 +1,60 @@
+#ifndef QUADBATCHNODE_H
+#define QUADBATCHNODE_H
+
+#include <QColor>
+#include <QList>
+#include <QPointF>
+#include <QRectF>
+#include <QSGNode>
+
+class QQuickWindow;
+class QSGGeometryNode;
+class QSGRectangleNode;
+
+/**
+ * QuadBatchNode - a fixed number of coloured quads, rewritten one at a time.
+ *
+ * With a hardware scene graph all quads share one QSGGeometryNode with
+ * per-vertex colour (one draw call); setting a quad rewrites its six vertices
+ * only and the geometry is marked dirty once per commit(). The software
+ * backend cannot draw custom geometry, so there every quad is a
+ * QSGRectangleNode covering the quad's bounding box.
+ *
+ * Quads that do not change are not touched. Only call from updatePaintNode().
+ */
+class QuadBatchNode : public QSGNode
+{
+public:
+    QuadBatchNode(QQuickWindow *window, int count);
+
+    int count() const { return m_count; }
+
+    /** Axis-aligned bar */
+    void setBar(int index, const QRectF &rect, const QColor &color);
+
+    /** Line segment of the given width (bounding box on the software backend) */
+    void setSegment(int index, const QPointF &from, const QPointF &to, qreal width, const QColor &color);
+
+    /** Make a quad invisible */
+    void clear(int index);
+
+    /** Flush the quads set since the last commit to the renderer */
+    void commit();
+
+private:
+    struct Quad {
+        QPointF corners[4];
+        QColor color;
+        bool operator==(const Quad &other) const;
+    };
+
+    void setQuad(int index, const Quad &quad);
+
+    int m_count;
+    QList<Quad> m_quads;
+    QSGGeometryNode *m_geometryNode;            // hardware
+    QList<QSGRectangleNode*> m_rectangles;      // software
+    bool m_dirty;
+};
+
+#endif // QUADBATCHNODE_H
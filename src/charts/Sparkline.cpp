@@ -0,0 +1,156 @@
+#include "Sparkline.h"
+#include "QuadBatchNode.h"
+#include <cmath>
+#include <limits>
+
+Sparkline::Sparkline(QQuickItem *parent)
+    : TelemetryItem(parent)
+    , m_channel(Rssi)
+    , m_minimum(-100.0)
+    , m_maximum(-40.0)
+    , m_capacity(DEFAULT_CAPACITY)
+    , m_sampleIntervalMs(DEFAULT_SAMPLE_INTERVAL_MS)
+    , m_color(QStringLiteral("#4caf50"))
+    , m_lineWidth(1.5)
+    , m_cursor(0)
+    , m_lastBucket(-1)
+{
+}
+
+void Sparkline::setChannel(Channel channel)
+{
+    if (m_channel == channel)
+        return;
+    m_channel = channel;
+    invalidateLayout();
+    emit channelChanged();
+}
+
+void Sparkline::setMinimum(qreal minimum)
+{
+    if (qFuzzyCompare(m_minimum, minimum))
+        return;
+    m_minimum = minimum;
+    invalidateLayout();
+    emit rangeChanged();
+}
+
+void Sparkline::setMaximum(qreal maximum)
+{
+    if (qFuzzyCompare(m_maximum, maximum))
+        return;
+    m_maximum = maximum;
+    invalidateLayout();
+    emit rangeChanged();
+}
+
+void Sparkline::setCapacity(int capacity)
+{
+    capacity = qMax(capacity, 2);
+    if (m_capacity == capacity)
+        return;
+    m_capacity = capacity;
+    invalidateLayout();
+    emit capacityChanged();
+}
+
+void Sparkline::setSampleIntervalMs(int ms)
+{
+    ms = qMax(ms, TICK_MS);
+    if (m_sampleIntervalMs == ms)
+        return;
+    m_sampleIntervalMs = ms;
+    invalidateLayout();
+    emit sampleIntervalMsChanged();
+}
+
+void Sparkline::setColor(const QColor &color)
+{
+    if (m_color == color)
+        return;
+    m_color = color;
+    invalidateLayout();
+    emit colorChanged();
+}
+
+void Sparkline::setLineWidth(qreal width)
+{
+    if (qFuzzyCompare(m_lineWidth, width))
+        return;
+    m_lineWidth = width;
+    invalidateLayout();
+    emit colorChanged();
+}
+
+QPointF Sparkline::pointAt(int index) const
+{
+    const qreal range = m_maximum - m_minimum;
+    const qreal fraction = range != 0 ? qBound<qreal>(0.0, (m_values[index] - m_minimum) / range, 1.0) : 0.5;
+    const qreal inset = m_lineWidth / 2;
+    return QPointF(index * width() / (m_capacity - 1),
+                   inset + (1.0 - fraction) * (height() - m_lineWidth));
+}
+
+void Sparkline::drawSegment(QuadBatchNode *node, int index) const
+{
+    // Segment i joins point i-1 to point i; there is none into the first point
+    if (index <= 0 || index >= m_capacity
+        || std::isnan(m_values[index - 1]) || std::isnan(m_values[index])) {
+        node->clear(index);
+        return;
+    }
+    node->setSegment(index, pointAt(index - 1), pointAt(index), m_lineWidth, m_color);
+}
+
+QSGNode *Sparkline::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data)
+{
+    Q_UNUSED(data)
+    auto *node = static_cast<QuadBatchNode*>(oldNode);
+    bool relayout = takeLayoutDirty();
+
+    if (!node || node->count() != m_capacity) {
+        delete node;
+        node = new QuadBatchNode(window(), m_capacity);
+        relayout = true;
+    }
+    if (relayout) {
+        // Range, size or source changed: start a fresh sweep
+        m_values.assign(m_capacity, std::numeric_limits<float>::quiet_NaN());
+        m_cursor = 0;
+        m_lastBucket = -1;
+        for (int i = 0; i < m_capacity; ++i) {
+            node->clear(i);
+        }
+    }
+
+    RobotSample sample;
+    if (readSample(sample)) {
+        const float value = channelValue(sample, m_channel);
+        const qint64 bucket = sample.updatedNs / (qint64(m_sampleIntervalMs) * 1000000);
+
+        if (m_lastBucket >= 0 && bucket == m_lastBucket) {
+            // Same interval: the newest point follows the latest value
+            const int newest = (m_cursor + m_capacity - 1) % m_capacity;
+            m_values[newest] = value;
+            drawSegment(node, newest);
+            drawSegment(node, newest + 1);
+        } else {
+            // One point per elapsed interval (held value across gaps), at most a full sweep
+            const qint64 steps = m_lastBucket < 0 ? 1 : qMin<qint64>(bucket - m_lastBucket, m_capacity);
+            for (qint64 i = 0; i < steps; ++i) {
+                m_values[m_cursor] = value;
+                drawSegment(node, m_cursor);
+                m_cursor = (m_cursor + 1) % m_capacity;
+            }
+            m_lastBucket = bucket;
+
+            // Gap ahead of the newest point
+            m_values[m_cursor] = std::numeric_limits<float>::quiet_NaN();
+            drawSegment(node, m_cursor);
+            drawSegment(node, m_cursor + 1);
+        }
+    }
+
+    node->commit();
+    return node;
+}
@@ -0,0 +1,84 @@
+#ifndef SPARKLINE_H
+#define SPARKLINE_H
+
+#include <QColor>
+#include <vector>
+#include "TelemetryItem.h"
+
+class QuadBatchNode;
+
+/**
+ * Sparkline - one channel of a robot's telemetry as a sweeping line.
+ *
+ * The latest value of every sampleIntervalMs is a point; points are written
+ * left to right and wrap, with a gap ahead of the newest one (like a patient
+ * monitor), so a new point rewrites one segment and clears the next instead
+ * of shifting the whole line.
+ */
+class Sparkline : public TelemetryItem
+{
+    Q_OBJECT
+    QML_ELEMENT
+    Q_PROPERTY(Channel channel READ channel WRITE setChannel NOTIFY channelChanged)
+    Q_PROPERTY(qreal minimum READ minimum WRITE setMinimum NOTIFY rangeChanged)
+    Q_PROPERTY(qreal maximum READ maximum WRITE setMaximum NOTIFY rangeChanged)
+    Q_PROPERTY(int capacity READ capacity WRITE setCapacity NOTIFY capacityChanged)
+    Q_PROPERTY(int sampleIntervalMs READ sampleIntervalMs WRITE setSampleIntervalMs NOTIFY sampleIntervalMsChanged)
+    Q_PROPERTY(QColor color READ color WRITE setColor NOTIFY colorChanged)
+    Q_PROPERTY(qreal lineWidth READ lineWidth WRITE setLineWidth NOTIFY colorChanged)
+
+public:
+    static constexpr int DEFAULT_CAPACITY = 60;
+    static constexpr int DEFAULT_SAMPLE_INTERVAL_MS = 250;
+
+    explicit Sparkline(QQuickItem *parent = nullptr);
+
+    Channel channel() const { return m_channel; }
+    void setChannel(Channel channel);
+
+    qreal minimum() const { return m_minimum; }
+    void setMinimum(qreal minimum);
+    qreal maximum() const { return m_maximum; }
+    void setMaximum(qreal maximum);
+
+    /** Points across the width */
+    int capacity() const { return m_capacity; }
+    void setCapacity(int capacity);
+
+    int sampleIntervalMs() const { return m_sampleIntervalMs; }
+    void setSampleIntervalMs(int ms);
+
+    QColor color() const { return m_color; }
+    void setColor(const QColor &color);
+    qreal lineWidth() const { return m_lineWidth; }
+    void setLineWidth(qreal width);
+
+signals:
+    void channelChanged();
+    void rangeChanged();
+    void capacityChanged();
+    void sampleIntervalMsChanged();
+    void colorChanged();
+
+protected:
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
+
+private:
+    QPointF pointAt(int index) const;
+    void drawSegment(QuadBatchNode *node, int index) const;
+
+    Channel m_channel;
+    qreal m_minimum;
+    qreal m_maximum;
+    int m_capacity;
+    int m_sampleIntervalMs;
+    QColor m_color;
+    qreal m_lineWidth;
+
+    // Render thread only
+    std::vector<float> m_values;    // NaN where there is no point
+    int m_cursor;                   // next point to write
+    qint64 m_lastBucket;
+};
+
+#endif // SPARKLINE_H
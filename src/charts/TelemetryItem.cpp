@@ -0,0 +1,110 @@
+#include "TelemetryItem.h"
+#include <QTimer>
+
+namespace {
+QSharedPointer<FleetSnapshot> s_snapshot;
+QList<TelemetryItem*> s_items;
+QTimer *s_ticker = nullptr;
+}
+
+TelemetryItem::TelemetryItem(QQuickItem *parent)
+    : QQuickItem(parent)
+    , m_snapshotSlot(-1)
+    , m_seenSequence(0)
+    , m_layoutDirty(true)
+{
+    setFlag(ItemHasContents, true);
+}
+
+TelemetryItem::~TelemetryItem()
+{
+    s_items.removeOne(this);
+    if (s_items.isEmpty() && s_ticker) {
+        s_ticker->stop();
+    }
+}
+
+void TelemetryItem::setFleetSnapshot(QSharedPointer<FleetSnapshot> snapshot)
+{
+    s_snapshot = std::move(snapshot);
+}
+
+void TelemetryItem::setSnapshotSlot(int slot)
+{
+    if (m_snapshotSlot == slot)
+        return;
+
+    m_snapshotSlot = slot;
+    m_seenSequence = 0;
+    invalidateLayout();
+    emit snapshotSlotChanged();
+}
+
+void TelemetryItem::componentComplete()
+{
+    QQuickItem::componentComplete();
+
+    s_items.append(this);
+    if (!s_ticker) {
+        s_ticker = new QTimer();
+        s_ticker->setInterval(TICK_MS);
+        QObject::connect(s_ticker, &QTimer::timeout, &TelemetryItem::tick);
+    }
+    if (!s_ticker->isActive()) {
+        s_ticker->start();
+    }
+}
+
+void TelemetryItem::geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry)
+{
+    QQuickItem::geometryChange(newGeometry, oldGeometry);
+    if (newGeometry.size() != oldGeometry.size()) {
+        invalidateLayout();
+    }
+}
+
+void TelemetryItem::tick()
+{
+    for (TelemetryItem *item : std::as_const(s_items)) {
+        item->poll();
+    }
+}
+
+void TelemetryItem::poll()
+{
+    if (!s_snapshot || m_snapshotSlot < 0 || !isVisible() || !window()) {
+        return;
+    }
+
+    const quint32 sequence = s_snapshot->sequence(m_snapshotSlot);
+    if (sequence != m_seenSequence) {
+        m_seenSequence = sequence;
+        update();
+    }
+}
+
+bool TelemetryItem::readSample(RobotSample &sample) const
+{
+    return s_snapshot && s_snapshot->read(m_snapshotSlot, sample);
+}
+
+float TelemetryItem::channelValue(const RobotSample &sample, Channel channel)
+{
+    switch (channel) {
+    case Rssi:
+        return sample.rssi;
+    case LinkQuality:
+        return sample.linkQuality;
+    case BatteryVoltage:
+        return sample.batteryVoltage;
+    case TotalVoltage:
+        return sample.totalVoltage;
+    case Current:
+        return sample.current;
+    case Soc:
+        return sample.soc;
+    case UpdateRate:
+        return sample.updateRate;
+    }
+    return 0.0f;
+}
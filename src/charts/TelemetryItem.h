@@ -0,0 +1,76 @@
+#ifndef TELEMETRYITEM_H
+#define TELEMETRYITEM_H
+
+#include <QQuickItem>
+#include <QSharedPointer>
+#include <QtQml/qqmlregistration.h>
+#include <utility>
+#include "src/models/FleetSnapshot.h"
+
+/**
+ * TelemetryItem - base of the scene-graph telemetry charts.
+ *
+ * Charts read one FleetSnapshot slot (the robot's snapshotSlot role) directly
+ * in updatePaintNode on the render thread; no QVariant or QML array is
+ * involved. A single GUI-thread ticker compares each visible chart's slot
+ * sequence once per frame and schedules a repaint only when the link wrote a
+ * new sample, so the GUI thread does a few atomic loads per frame however
+ * fast samples arrive.
+ */
+class TelemetryItem : public QQuickItem
+{
+    Q_OBJECT
+    QML_ELEMENT
+    QML_UNCREATABLE("Base of the telemetry charts")
+    Q_PROPERTY(int snapshotSlot READ snapshotSlot WRITE setSnapshotSlot NOTIFY snapshotSlotChanged)
+
+public:
+    /** Values a chart can plot */
+    enum Channel {
+        Rssi,
+        LinkQuality,
+        BatteryVoltage,
+        TotalVoltage,
+        Current,
+        Soc,
+        UpdateRate
+    };
+    Q_ENUM(Channel)
+
+    static constexpr int TICK_MS = 16;
+
+    explicit TelemetryItem(QQuickItem *parent = nullptr);
+    ~TelemetryItem();
+
+    /** Snapshot every chart reads from; set once at startup */
+    static void setFleetSnapshot(QSharedPointer<FleetSnapshot> snapshot);
+
+    int snapshotSlot() const { return m_snapshotSlot; }
+    void setSnapshotSlot(int slot);
+
+    static float channelValue(const RobotSample &sample, Channel channel);
+
+signals:
+    void snapshotSlotChanged();
+
+protected:
+    /** Copy of the current sample; false without a slot or data. Render thread. */
+    bool readSample(RobotSample &sample) const;
+
+    /** Re-lay out everything on the next updatePaintNode */
+    void invalidateLayout() { m_layoutDirty = true; update(); }
+    bool takeLayoutDirty() { return std::exchange(m_layoutDirty, false); }
+
+    void geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry) override;
+    void componentComplete() override;
+
+private:
+    static void tick();
+    void poll();
+
+    int m_snapshotSlot;
+    quint32 m_seenSequence;
+    bool m_layoutDirty;
+};
+
+#endif // TELEMETRYITEM_H
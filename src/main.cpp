@@ -1,11 +1,15 @@
 #include <QGuiApplication>
+#include <QCommandLineParser>
 #include <QQmlApplicationEngine>
 #include <QQmlContext>
 #include <QIcon>
 #include <QBluetoothDeviceInfo>
 #include <QQuickWindow>
+#include "src/ble/BleWorker.h"
 #include "src/ble/BleDeviceScanner.h"
 #include "src/ble/BleConnectionManager.h"
+#include "src/ble/LoadTest.h"
+#include "src/charts/TelemetryItem.h"
 
 int main(int argc, char *argv[])
 {
@@ -21,13 +25,31 @@ int main(int argc, char *argv[])
     app.setOrganizationName("Falcons");
     app.setApplicationVersion("1.0.0");
 
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addVersionOption();
+    const QCommandLineOption maxDevicesOption(
+        "max-devices", "Most devices connected at once (robots and BMS packs count separately).", "count");
+    const QCommandLineOption loadTestOption(
+        "load-test", "Measure CPU and latency with simulated devices, e.g. 16,32,64, then quit.", "counts");
+    parser.addOption(maxDevicesOption);
+    parser.addOption(loadTestOption);
+    parser.process(app);
+
     // Register metatypes for QML
     qRegisterMetaType<QBluetoothDeviceInfo>("QBluetoothDeviceInfo");
 
-    // Create BLE components
-    BleDeviceScanner scanner;
-    BleConnectionManager connectionManager;
+    // Create BLE components; the worker outlives everything that posts to it
+    BleWorker bleWorker;
+    BleDeviceScanner scanner(&bleWorker);
+    BleConnectionManager connectionManager(&bleWorker);
     connectionManager.setScanner(&scanner);
+    if (parser.isSet(maxDevicesOption)) {
+        connectionManager.setMaxDevices(parser.value(maxDevicesOption).toInt());
+    }
+
+    // Telemetry charts read the fleet snapshot on the render thread
+    TelemetryItem::setFleetSnapshot(connectionManager.fleetSnapshot());
 
     QQmlApplicationEngine engine;
 
@@ -45,6 +67,22 @@ int main(int argc, char *argv[])
 
     engine.load(url);
 
+    if (parser.isSet(loadTestOption)) {
+        // Simulated devices only, so the numbers are not mixed with real radio traffic
+        QList<int> counts;
+        const QStringList values = parser.value(loadTestOption).split(',', Qt::SkipEmptyParts);
+        for (const QString &value : values) {
+            counts.append(value.toInt());
+        }
+        LoadTest *loadTest = new LoadTest(&connectionManager, counts, &app);
+        QObject::connect(loadTest, &LoadTest::finished, &app, &QCoreApplication::quit);
+        loadTest->start();
+        return app.exec();
+    }
+
+    // Known devices connect by address right away; discovery fills in the rest
+    connectionManager.connectKnownDevices();
+
     // Auto-start BLE scanning
     scanner.startScan();
 
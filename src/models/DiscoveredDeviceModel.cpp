@@ -0,0 +1,300 @@
+#include "DiscoveredDeviceModel.h"
+#include "src/protocol/MonotonicClock.h"
+#include <algorithm>
+#include <cstdlib>
+#include <numeric>
+#include <utility>
+
+DiscoveredDeviceModel::DiscoveredDeviceModel(QObject *parent)
+    : QAbstractListModel(parent)
+    , m_capacity(DEFAULT_CAPACITY)
+    , m_evicted(0)
+{
+}
+
+int DiscoveredDeviceModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return m_devices.count();
+}
+
+QVariant DiscoveredDeviceModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_devices.count())
+        return QVariant();
+
+    const Entry &entry = m_devices.at(index.row());
+
+    switch (role) {
+    case NameRole:
+        return entry.name;
+    case AddressRole:
+        return entry.address;
+    case RssiRole:
+        return entry.rssi;
+    case DeviceTypeRole:
+        return Robot::deviceTypeToString(entry.type);
+    case BroadcastingRole:
+        return entry.broadcasting;
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int, QByteArray> DiscoveredDeviceModel::roleNames() const
+{
+    QHash<int, QByteArray> roles;
+    roles[NameRole] = "name";
+    roles[AddressRole] = "address";
+    roles[RssiRole] = "rssi";
+    roles[DeviceTypeRole] = "deviceType";
+    roles[BroadcastingRole] = "broadcasting";
+    return roles;
+}
+
+QString DiscoveredDeviceModel::displayName(const QBluetoothDeviceInfo &device)
+{
+    return device.name().isEmpty() ? QStringLiteral("Unknown Device") : device.name();
+}
+
+bool DiscoveredDeviceModel::upsert(const QBluetoothDeviceInfo &device, Robot::DeviceType type,
+                                   bool broadcasting, int rssiThreshold)
+{
+    const qint64 now = MonotonicClock::nowMs();
+    const auto it = m_rowByAddress.constFind(device.address().toUInt64());
+    if (it == m_rowByAddress.constEnd()) {
+        if (m_devices.count() >= m_capacity) {
+            // Full: the new device takes over the least recently seen row
+            const int row = leastRecentlySeenRow();
+            unlinkRecency(row);
+            Entry &victim = m_devices[row];
+            m_rowByAddress.remove(victim.info.address().toUInt64());
+            victim = { device, displayName(device), device.address().toString(),
+                       device.rssi(), type, broadcasting, now };
+            m_rowByAddress.insert(device.address().toUInt64(), row);
+            linkNewest(row);
+            m_evicted++;
+
+            const QModelIndex modelIndex = createIndex(row, 0);
+            emit dataChanged(modelIndex, modelIndex);
+            emit countChanged();
+            return true;
+        }
+
+        const int row = m_devices.count();
+        beginInsertRows(QModelIndex(), row, row);
+        m_devices.append({ device, displayName(device), device.address().toString(),
+                           device.rssi(), type, broadcasting, now });
+        m_rowByAddress.insert(device.address().toUInt64(), row);
+        linkNewest(row);
+        endInsertRows();
+        emit countChanged();
+        return true;
+    }
+
+    const int row = it.value();
+    unlinkRecency(row);
+    Entry &entry = m_devices[row];
+    entry.info = device;
+    entry.lastSeenMs = now;
+
+    // Only announce the roles that actually changed
+    QList<int> changed;
+    if (entry.rssi != device.rssi() && std::abs(entry.rssi - device.rssi()) >= rssiThreshold) {
+        entry.rssi = device.rssi();
+        changed.append(RssiRole);
+    }
+    if (!device.name().isEmpty() && entry.name != device.name()) {
+        entry.name = device.name();
+        changed.append(NameRole);
+    }
+    if (entry.type != type) {
+        entry.type = type;
+        changed.append(DeviceTypeRole);
+    }
+    if (entry.broadcasting != broadcasting) {
+        entry.broadcasting = broadcasting;
+        changed.append(BroadcastingRole);
+    }
+    linkNewest(row);        // after the type, which picks the list
+
+    if (!changed.isEmpty()) {
+        const QModelIndex modelIndex = createIndex(row, 0);
+        emit dataChanged(modelIndex, modelIndex, changed);
+    }
+    return !changed.isEmpty();
+}
+
+void DiscoveredDeviceModel::clear()
+{
+    if (m_devices.isEmpty())
+        return;
+
+    beginResetModel();
+    m_devices.clear();
+    m_rowByAddress.clear();
+    m_recency.fill(RecencyList());
+    endResetModel();
+    emit countChanged();
+}
+
+int DiscoveredDeviceModel::evictOlderThan(qint64 maxAgeMs)
+{
+    const qint64 cutoff = MonotonicClock::nowMs() - maxAgeMs;
+    int removed = 0;
+
+    // Walk backwards so removing a run does not shift rows still to be visited
+    int row = m_devices.count() - 1;
+    while (row >= 0) {
+        if (m_devices.at(row).lastSeenMs >= cutoff) {
+            row--;
+            continue;
+        }
+        const int last = row;
+        while (row > 0 && m_devices.at(row - 1).lastSeenMs < cutoff) {
+            row--;
+        }
+        beginRemoveRows(QModelIndex(), row, last);
+        m_devices.remove(row, last - row + 1);
+        endRemoveRows();
+        removed += last - row + 1;
+        row--;
+    }
+
+    if (removed > 0) {
+        rebuildIndex();
+        m_evicted += removed;
+        emit countChanged();
+    }
+    return removed;
+}
+
+void DiscoveredDeviceModel::setCapacity(int maxDevices)
+{
+    m_capacity = qMax(1, maxDevices);
+
+    // Shrinking: drop the least recently seen rows until it fits
+    if (m_devices.count() > m_capacity) {
+        QList<qint64> lastSeen;
+        lastSeen.reserve(m_devices.count());
+        for (const Entry &entry : std::as_const(m_devices)) {
+            lastSeen.append(entry.lastSeenMs);
+        }
+        std::nth_element(lastSeen.begin(), lastSeen.end() - m_capacity, lastSeen.end());
+        const qint64 keepFromMs = *(lastSeen.end() - m_capacity);
+        evictOlderThan(MonotonicClock::nowMs() - keepFromMs);
+    }
+}
+
+DiscoveredDeviceModel::RecencyList &DiscoveredDeviceModel::recencyListOf(const Entry &entry)
+{
+    return m_recency[entry.type == Robot::Unknown ? 0 : 1];
+}
+
+void DiscoveredDeviceModel::unlinkRecency(int row)
+{
+    Entry &entry = m_devices[row];
+    RecencyList &list = recencyListOf(entry);
+    if (entry.older >= 0) {
+        m_devices[entry.older].newer = entry.newer;
+    } else {
+        list.oldest = entry.newer;
+    }
+    if (entry.newer >= 0) {
+        m_devices[entry.newer].older = entry.older;
+    } else {
+        list.newest = entry.older;
+    }
+    entry.older = entry.newer = -1;
+}
+
+void DiscoveredDeviceModel::linkNewest(int row)
+{
+    Entry &entry = m_devices[row];
+    RecencyList &list = recencyListOf(entry);
+    entry.older = list.newest;
+    entry.newer = -1;
+    if (list.newest >= 0) {
+        m_devices[list.newest].newer = row;
+    } else {
+        list.oldest = row;
+    }
+    list.newest = row;
+}
+
+int DiscoveredDeviceModel::leastRecentlySeenRow() const
+{
+    return m_recency[0].oldest >= 0 ? m_recency[0].oldest : m_recency[1].oldest;
+}
+
+void DiscoveredDeviceModel::rebuildIndex()
+{
+    m_rowByAddress.clear();
+    m_rowByAddress.reserve(m_devices.count());
+    for (int row = 0; row < m_devices.count(); ++row) {
+        m_rowByAddress.insert(m_devices.at(row).info.address().toUInt64(), row);
+    }
+
+    // Rows moved; thread them again in the order they were last heard
+    QList<int> rows(m_devices.count());
+    std::iota(rows.begin(), rows.end(), 0);
+    std::stable_sort(rows.begin(), rows.end(), [this](int a, int b) {
+        return m_devices.at(a).lastSeenMs < m_devices.at(b).lastSeenMs;
+    });
+    m_recency.fill(RecencyList());
+    for (int row : std::as_const(rows)) {
+        linkNewest(row);
+    }
+}
+
+qint64 DiscoveredDeviceModel::memoryEstimate() const
+{
+    qint64 bytes = m_devices.capacity() * qint64(sizeof(Entry))
+                 + m_rowByAddress.capacity() * qint64(sizeof(quint64) + sizeof(int));
+    for (const Entry &entry : m_devices) {
+        // QBluetoothDeviceInfo keeps name, UUIDs and advertisement payloads in its private data
+        bytes += (entry.name.size() + entry.address.size() + entry.info.name().size()) * 2
+               + entry.info.serviceUuids().size() * qint64(sizeof(QBluetoothUuid))
+               + 256;
+        const QList<quint16> ids = entry.info.manufacturerIds();
+        for (quint16 id : ids) {
+            bytes += entry.info.manufacturerData(id).size();
+        }
+    }
+    return bytes;
+}
+
+qint64 DiscoveredDeviceModel::ageMs(int row) const
+{
+    if (row < 0 || row >= m_devices.count()) {
+        return -1;
+    }
+    return MonotonicClock::nowMs() - m_devices.at(row).lastSeenMs;
+}
+
+int DiscoveredDeviceModel::rowOf(const QBluetoothAddress &address) const
+{
+    return m_rowByAddress.value(address.toUInt64(), -1);
+}
+
+QBluetoothDeviceInfo DiscoveredDeviceModel::deviceAt(int row) const
+{
+    if (row >= 0 && row < m_devices.count()) {
+        return m_devices.at(row).info;
+    }
+    return QBluetoothDeviceInfo();
+}
+
+QBluetoothDeviceInfo DiscoveredDeviceModel::deviceByAddress(const QBluetoothAddress &address) const
+{
+    return deviceAt(rowOf(address));
+}
+
+Robot::DeviceType DiscoveredDeviceModel::deviceTypeAt(int row) const
+{
+    if (row >= 0 && row < m_devices.count()) {
+        return m_devices.at(row).type;
+    }
+    return Robot::Unknown;
+}
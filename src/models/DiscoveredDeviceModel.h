@@ -0,0 +1,117 @@
+#ifndef DISCOVEREDDEVICEMODEL_H
+#define DISCOVEREDDEVICEMODEL_H
+
+#include <QAbstractListModel>
+#include <QBluetoothDeviceInfo>
+#include <QHash>
+#include <QList>
+#include <array>
+#include "Robot.h"
+
+/**
+ * DiscoveredDeviceModel - scan results keyed by Bluetooth address.
+ *
+ * Rows are looked up through an address hash, so an advertisement costs one
+ * hash lookup and, if something visible changed, a dataChanged() for that row
+ * and those roles only. Display strings are formatted once when a device is
+ * first seen.
+ *
+ * Memory stays bounded over a long session: every row records when it was
+ * last heard, evictOlderThan() drops stale rows, and once capacity() rows
+ * exist a new device takes over the least recently seen row (unclassified
+ * devices go first, so robots and BMSes are kept). Rows are threaded onto
+ * two recency lists, unclassified and classified, so that row is found in
+ * O(1) rather than by scanning.
+ */
+class DiscoveredDeviceModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+    Q_PROPERTY(qint64 evictedCount READ evictedCount NOTIFY countChanged)
+
+public:
+    static constexpr int DEFAULT_CAPACITY = 512;
+
+    enum DeviceRoles {
+        NameRole = Qt::UserRole + 1,
+        AddressRole,
+        RssiRole,
+        DeviceTypeRole,
+        BroadcastingRole
+    };
+
+    explicit DiscoveredDeviceModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    /**
+     * Insert a new device or refresh a known one. broadcasting marks devices
+     * that advertise telemetry (can be watched without connecting). RSSI moves
+     * smaller than rssiThreshold dB are stored in the device info but not
+     * announced. Returns true if a row was inserted or a role changed.
+     */
+    bool upsert(const QBluetoothDeviceInfo &device, Robot::DeviceType type,
+                bool broadcasting = false, int rssiThreshold = 0);
+    void clear();
+
+    /** Remove rows not heard from for maxAgeMs; returns how many were removed */
+    int evictOlderThan(qint64 maxAgeMs);
+
+    int capacity() const { return m_capacity; }
+    void setCapacity(int maxDevices);
+
+    /** Rows dropped by aging or replaced by the capacity limit */
+    qint64 evictedCount() const { return m_evicted; }
+
+    /** Rough heap use of the stored devices (bytes) */
+    qint64 memoryEstimate() const;
+
+    /** Milliseconds since the device at a row was last heard */
+    qint64 ageMs(int row) const;
+
+    int count() const { return m_devices.count(); }
+    int rowOf(const QBluetoothAddress &address) const;
+
+    QBluetoothDeviceInfo deviceAt(int row) const;
+    QBluetoothDeviceInfo deviceByAddress(const QBluetoothAddress &address) const;
+    Robot::DeviceType deviceTypeAt(int row) const;
+
+signals:
+    void countChanged();
+
+private:
+    struct Entry {
+        QBluetoothDeviceInfo info;
+        QString name;
+        QString address;
+        int rssi;
+        Robot::DeviceType type;
+        bool broadcasting;
+        qint64 lastSeenMs;         // MonotonicClock
+        int older = -1;            // recency list neighbours by row, -1 at the ends
+        int newer = -1;
+    };
+
+    /** Rows of one kind from least to most recently seen */
+    struct RecencyList {
+        int oldest = -1;
+        int newest = -1;
+    };
+
+    static QString displayName(const QBluetoothDeviceInfo &device);
+    RecencyList &recencyListOf(const Entry &entry);
+    void unlinkRecency(int row);
+    void linkNewest(int row);
+    int leastRecentlySeenRow() const;
+    void rebuildIndex();
+
+    QList<Entry> m_devices;
+    QHash<quint64, int> m_rowByAddress;
+    std::array<RecencyList, 2> m_recency;      // unclassified, then robots and BMSes
+    int m_capacity;
+    qint64 m_evicted;
+};
+
+#endif // DISCOVEREDDEVICEMODEL_H
@@ -0,0 +1,64 @@
+#include "DiscoveredDeviceProxyModel.h"
+#include "DiscoveredDeviceModel.h"
+
+DiscoveredDeviceProxyModel::DiscoveredDeviceProxyModel(DiscoveredDeviceModel *source, QObject *parent)
+    : QSortFilterProxyModel(parent)
+    , m_source(source)
+    , m_knownTypesOnly(true)
+{
+    setSourceModel(m_source);
+    setSortRole(DiscoveredDeviceModel::RssiRole);
+    setDynamicSortFilter(true);
+    sort(0, Qt::DescendingOrder);
+
+    connect(this, &QAbstractItemModel::rowsInserted, this, &DiscoveredDeviceProxyModel::countChanged);
+    connect(this, &QAbstractItemModel::rowsRemoved, this, &DiscoveredDeviceProxyModel::countChanged);
+    connect(this, &QAbstractItemModel::modelReset, this, &DiscoveredDeviceProxyModel::countChanged);
+}
+
+void DiscoveredDeviceProxyModel::setKnownTypesOnly(bool enabled)
+{
+    if (m_knownTypesOnly == enabled)
+        return;
+
+    beginFilterChange();
+    m_knownTypesOnly = enabled;
+    endFilterChange(Direction::Rows);
+    emit knownTypesOnlyChanged();
+}
+
+void DiscoveredDeviceProxyModel::setNameFilter(const QString &filter)
+{
+    if (m_nameFilter == filter)
+        return;
+
+    beginFilterChange();
+    m_nameFilter = filter;
+    endFilterChange(Direction::Rows);
+    emit nameFilterChanged();
+}
+
+int DiscoveredDeviceProxyModel::sourceRow(int row) const
+{
+    const QModelIndex proxyIndex = index(row, 0);
+    if (!proxyIndex.isValid())
+        return -1;
+    return mapToSource(proxyIndex).row();
+}
+
+bool DiscoveredDeviceProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
+{
+    Q_UNUSED(sourceParent)
+
+    if (m_knownTypesOnly && m_source->deviceTypeAt(sourceRow) == Robot::Unknown)
+        return false;
+
+    if (!m_nameFilter.isEmpty()) {
+        const QModelIndex sourceIndex = m_source->index(sourceRow, 0);
+        const QString name = sourceIndex.data(DiscoveredDeviceModel::NameRole).toString();
+        if (!name.contains(m_nameFilter, Qt::CaseInsensitive))
+            return false;
+    }
+
+    return true;
+}
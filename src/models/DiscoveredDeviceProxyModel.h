@@ -0,0 +1,51 @@
+#ifndef DISCOVEREDDEVICEPROXYMODEL_H
+#define DISCOVEREDDEVICEPROXYMODEL_H
+
+#include <QSortFilterProxyModel>
+
+class DiscoveredDeviceModel;
+
+/**
+ * DiscoveredDeviceProxyModel - scanner view over DiscoveredDeviceModel.
+ *
+ * Sorts by RSSI (strongest first) and filters on device type and name.
+ * Dynamic sorting/filtering re-evaluates only the rows named in the source's
+ * dataChanged(), so one advertisement moves at most one row instead of
+ * rebuilding the list.
+ */
+class DiscoveredDeviceProxyModel : public QSortFilterProxyModel
+{
+    Q_OBJECT
+    Q_PROPERTY(bool knownTypesOnly READ knownTypesOnly WRITE setKnownTypesOnly NOTIFY knownTypesOnlyChanged)
+    Q_PROPERTY(QString nameFilter READ nameFilter WRITE setNameFilter NOTIFY nameFilterChanged)
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+public:
+    explicit DiscoveredDeviceProxyModel(DiscoveredDeviceModel *source, QObject *parent = nullptr);
+
+    bool knownTypesOnly() const { return m_knownTypesOnly; }
+    void setKnownTypesOnly(bool enabled);
+
+    QString nameFilter() const { return m_nameFilter; }
+    void setNameFilter(const QString &filter);
+
+    int count() const { return rowCount(); }
+
+    /** Source row for a row in this view, -1 if out of range */
+    Q_INVOKABLE int sourceRow(int row) const;
+
+signals:
+    void knownTypesOnlyChanged();
+    void nameFilterChanged();
+    void countChanged();
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
+
+private:
+    DiscoveredDeviceModel *m_source;
+    bool m_knownTypesOnly;
+    QString m_nameFilter;
+};
+
+#endif // DISCOVEREDDEVICEPROXYMODEL_H
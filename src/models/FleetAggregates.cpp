@@ -0,0 +1,194 @@
+#include "FleetAggregates.h"
+#include <QMetaObject>
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+// Fields any aggregate is derived from; changes to the rest are ignored
+constexpr quint32 AGGREGATED_FIELDS = FleetStore::ConnectionState | FleetStore::DeviceType
+    | FleetStore::Stale | FleetStore::Soc | FleetStore::TotalVoltage | FleetStore::Current
+    | FleetStore::CellVoltages | FleetStore::BatteryVoltage;
+
+}
+
+FleetAggregates::FleetAggregates(const FleetStore *store, QObject *parent)
+    : QObject(parent)
+    , m_store(store)
+    , m_deviceCount(0)
+    , m_stateCounts{}
+    , m_typeCounts{}
+    , m_staleCount(0)
+    , m_lowBatteryCount(0)
+    , m_totalCurrentMa(0)
+    , m_pending(0)
+{
+}
+
+void FleetAggregates::insert(FleetStore::Handle robot)
+{
+    if (robot >= m_contributions.size()) {
+        m_contributions.resize(robot + 1);
+    }
+    apply(robot, measure(robot));
+}
+
+void FleetAggregates::update(FleetStore::Handle robot, quint32 fields)
+{
+    if (fields & AGGREGATED_FIELDS) {
+        apply(robot, measure(robot));
+    }
+    if ((fields & FleetStore::Name) && robot == m_minSoc.holder) {
+        schedule(Battery);
+    }
+}
+
+void FleetAggregates::remove(FleetStore::Handle robot)
+{
+    apply(robot, Contribution());
+}
+
+void FleetAggregates::clear()
+{
+    m_contributions.clear();
+    m_deviceCount = 0;
+    m_stateCounts.fill(0);
+    m_typeCounts.fill(0);
+    m_staleCount = 0;
+    m_lowBatteryCount = 0;
+    m_totalCurrentMa = 0;
+    m_minSoc = Minimum();
+    m_minCell = Minimum();
+    schedule(Counts | Stale | Battery);
+}
+
+QString FleetAggregates::minSocName() const
+{
+    return m_minSoc.holder >= 0 ? m_store->name(m_minSoc.holder) : QString();
+}
+
+QString FleetAggregates::minSocAddress() const
+{
+    return m_minSoc.holder >= 0 ? m_store->address(m_minSoc.holder).toString() : QString();
+}
+
+FleetAggregates::Contribution FleetAggregates::measure(FleetStore::Handle robot) const
+{
+    Contribution contribution;
+    contribution.present = true;
+    contribution.state = quint8(m_store->connectionState(robot));
+    contribution.type = quint8(m_store->deviceType(robot));
+    contribution.stale = m_store->isStale(robot);
+
+    // Values a lost link left behind are not the fleet's battery
+    if (contribution.state != Robot::Ready && contribution.state != Robot::Watching) {
+        return contribution;
+    }
+
+    if (contribution.type == Robot::SmartBMS && m_store->totalMv(robot) > 0) {
+        contribution.soc = m_store->soc(robot);
+        contribution.currentMa = m_store->currentMa(robot);
+        contribution.low = contribution.soc <= LOW_SOC_PERCENT;
+
+        const FleetStore::Cells &cells = m_store->cells(robot);
+        if (cells.count > 0) {
+            contribution.minCellMv = *std::min_element(cells.mv.cbegin(), cells.mv.cbegin() + cells.count);
+        }
+    } else if (contribution.type == Robot::FalconsRobot && m_store->batteryMv(robot) > 0) {
+        contribution.low = m_store->batteryMv(robot) <= LOW_BATTERY_MV;
+    }
+    return contribution;
+}
+
+void FleetAggregates::apply(FleetStore::Handle robot, const Contribution &next)
+{
+    const Contribution previous = std::exchange(m_contributions[robot], next);
+    account(previous, -1);
+    account(next, 1);
+
+    quint32 groups = 0;
+    if (previous.present != next.present || previous.state != next.state || previous.type != next.type) {
+        groups |= Counts;
+    }
+    if (previous.stale != next.stale) {
+        groups |= Stale;
+    }
+    if (previous.low != next.low || previous.currentMa != next.currentMa) {
+        groups |= Battery;
+    }
+    if (track(m_minSoc, robot, &Contribution::soc)) {
+        groups |= Battery;
+    }
+    if (track(m_minCell, robot, &Contribution::minCellMv)) {
+        groups |= Battery;
+    }
+    schedule(groups);
+}
+
+void FleetAggregates::account(const Contribution &contribution, int sign)
+{
+    if (!contribution.present) {
+        return;
+    }
+
+    m_deviceCount += sign;
+    m_stateCounts[contribution.state] += sign;
+    m_typeCounts[contribution.type] += sign;
+    if (contribution.stale) {
+        m_staleCount += sign;
+    }
+    if (contribution.low) {
+        m_lowBatteryCount += sign;
+    }
+    m_totalCurrentMa += sign * contribution.currentMa;
+}
+
+bool FleetAggregates::track(Minimum &minimum, FleetStore::Handle robot, qint32 Contribution::*field)
+{
+    const Minimum before = minimum;
+    const qint32 value = m_contributions.at(robot).*field;
+
+    if (robot == minimum.holder) {
+        if (value >= 0 && value <= minimum.value) {
+            minimum.value = value;
+        } else {
+            // The lowest robot rose or left; only now is every contribution looked at
+            minimum = Minimum();
+            for (FleetStore::Handle other = 0; other < m_contributions.size(); ++other) {
+                const qint32 candidate = m_contributions.at(other).*field;
+                if (candidate >= 0 && (minimum.holder < 0 || candidate < minimum.value)) {
+                    minimum = { other, candidate };
+                }
+            }
+        }
+    } else if (value >= 0 && (minimum.holder < 0 || value < minimum.value)) {
+        minimum = { robot, value };
+    }
+
+    return minimum.holder != before.holder || minimum.value != before.value;
+}
+
+void FleetAggregates::schedule(quint32 groups)
+{
+    if (groups == 0) {
+        return;
+    }
+    if (m_pending == 0) {
+        QMetaObject::invokeMethod(this, &FleetAggregates::publish, Qt::QueuedConnection);
+    }
+    m_pending |= groups;
+}
+
+void FleetAggregates::publish()
+{
+    const quint32 groups = std::exchange(m_pending, 0);
+    if (groups & Counts) {
+        emit countsChanged();
+    }
+    if (groups & Stale) {
+        emit staleCountChanged();
+    }
+    if (groups & Battery) {
+        emit batteryChanged();
+    }
+}
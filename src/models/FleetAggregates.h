@@ -0,0 +1,131 @@
+#ifndef FLEETAGGREGATES_H
+#define FLEETAGGREGATES_H
+
+#include <QObject>
+#include <QList>
+#include <QString>
+#include <array>
+#include "FleetStore.h"
+#include "Robot.h"
+
+/**
+ * FleetAggregates - fleet-wide figures for the header bar and team overview.
+ *
+ * Fed by RobotListModel with the same per-field changes it publishes. What
+ * each robot contributes is remembered by handle, so an update subtracts
+ * the old contribution and adds the new one, and a change to a field no
+ * aggregate uses returns at once. Counts, the stale count and the current
+ * sum are O(1) per update. A minimum is O(1) unless the robot holding it
+ * rises or leaves; only then are the contributions rescanned.
+ *
+ * Battery figures only count live devices (Ready or Watching) that have
+ * reported: BMS packs give SoC, current and cells; a robot is low below
+ * LOW_BATTERY_MV. Notifications are coalesced, so each property group is
+ * notified at most once per event loop pass however many rows changed.
+ * GUI thread only.
+ */
+class FleetAggregates : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int deviceCount READ deviceCount NOTIFY countsChanged)
+    Q_PROPERTY(int readyCount READ readyCount NOTIFY countsChanged)
+    Q_PROPERTY(QList<int> stateCounts READ stateCounts NOTIFY countsChanged)
+    Q_PROPERTY(QList<int> typeCounts READ typeCounts NOTIFY countsChanged)
+    Q_PROPERTY(int staleCount READ staleCount NOTIFY staleCountChanged)
+    Q_PROPERTY(int minSoc READ minSoc NOTIFY batteryChanged)
+    Q_PROPERTY(QString minSocName READ minSocName NOTIFY batteryChanged)
+    Q_PROPERTY(QString minSocAddress READ minSocAddress NOTIFY batteryChanged)
+    Q_PROPERTY(qreal minCellVoltage READ minCellVoltage NOTIFY batteryChanged)
+    Q_PROPERTY(qreal totalCurrent READ totalCurrent NOTIFY batteryChanged)
+    Q_PROPERTY(int lowBatteryCount READ lowBatteryCount NOTIFY batteryChanged)
+
+public:
+    static constexpr int LOW_SOC_PERCENT = 20;      // RobotCard shows SoC red from here
+    static constexpr int LOW_BATTERY_MV = 25000;    // and a robot's battery
+    static constexpr int STATE_COUNT = Robot::Watching + 1;
+    static constexpr int TYPE_COUNT = Robot::SmartBMS + 1;
+
+    explicit FleetAggregates(const FleetStore *store, QObject *parent = nullptr);
+
+    /** Count a robot just inserted into the store */
+    void insert(FleetStore::Handle robot);
+
+    /** Apply the fields just taken from the robot's dirty mask */
+    void update(FleetStore::Handle robot, quint32 fields);
+
+    /** Uncount a robot before the store drops it */
+    void remove(FleetStore::Handle robot);
+
+    void clear();
+
+    int deviceCount() const { return m_deviceCount; }
+    int readyCount() const { return m_stateCounts[Robot::Ready]; }
+    QList<int> stateCounts() const { return QList<int>(m_stateCounts.cbegin(), m_stateCounts.cend()); }
+    QList<int> typeCounts() const { return QList<int>(m_typeCounts.cbegin(), m_typeCounts.cend()); }
+    int staleCount() const { return m_staleCount; }
+
+    /** Lowest SoC in %, or -1 with no pack reporting */
+    int minSoc() const { return m_minSoc.value; }
+    QString minSocName() const;
+    QString minSocAddress() const;
+
+    /** Lowest cell of any pack in volts, 0 with no pack reporting */
+    qreal minCellVoltage() const { return m_minCell.value < 0 ? 0.0 : m_minCell.value / 1000.0; }
+
+    /** Sum of the packs' current in amps, negative while discharging */
+    qreal totalCurrent() const { return m_totalCurrentMa / 1000.0; }
+
+    int lowBatteryCount() const { return m_lowBatteryCount; }
+
+signals:
+    void countsChanged();
+    void staleCountChanged();
+    void batteryChanged();
+
+private:
+    enum Group : quint32 {
+        Counts  = 1u << 0,
+        Stale   = 1u << 1,
+        Battery = 1u << 2
+    };
+
+    /** What one robot adds to the aggregates */
+    struct Contribution {
+        bool present = false;
+        quint8 state = 0;
+        quint8 type = 0;
+        bool stale = false;
+        bool low = false;
+        qint32 currentMa = 0;
+        qint32 soc = -1;            // -1: no SoC reading
+        qint32 minCellMv = -1;      // -1: no cells
+    };
+
+    struct Minimum {
+        FleetStore::Handle holder = -1;
+        qint32 value = -1;
+    };
+
+    Contribution measure(FleetStore::Handle robot) const;
+    void apply(FleetStore::Handle robot, const Contribution &next);
+    void account(const Contribution &contribution, int sign);
+    bool track(Minimum &minimum, FleetStore::Handle robot, qint32 Contribution::*field);
+    void schedule(quint32 groups);
+    void publish();
+
+    const FleetStore *m_store;
+    QList<Contribution> m_contributions;     // by handle
+
+    int m_deviceCount;
+    std::array<int, STATE_COUNT> m_stateCounts;
+    std::array<int, TYPE_COUNT> m_typeCounts;
+    int m_staleCount;
+    int m_lowBatteryCount;
+    qint64 m_totalCurrentMa;
+    Minimum m_minSoc;
+    Minimum m_minCell;
+
+    quint32 m_pending;      // groups to notify on the next publish()
+};
+
+#endif // FLEETAGGREGATES_H
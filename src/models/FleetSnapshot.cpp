@@ -0,0 +1,57 @@
+#include "FleetSnapshot.h"
+#include <cstring>
+
+int FleetSnapshot::claim()
+{
+    for (int i = 0; i < MAX_SLOTS; ++i) {
+        bool expected = false;
+        if (m_slots[i].claimed.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void FleetSnapshot::release(int slot)
+{
+    if (slot < 0 || slot >= MAX_SLOTS) return;
+
+    write(slot, RobotSample());
+    m_slots[slot].claimed.store(false, std::memory_order_release);
+}
+
+void FleetSnapshot::write(int slot, const RobotSample &sample)
+{
+    if (slot < 0 || slot >= MAX_SLOTS) return;
+
+    // Odd while writing; readers that saw the old even value retry
+    Slot &target = m_slots[slot];
+    const quint32 sequence = target.sequence.load(std::memory_order_relaxed);
+    target.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(static_cast<void *>(&target.sample), &sample, sizeof(RobotSample));
+    target.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+bool FleetSnapshot::read(int slot, RobotSample &sample) const
+{
+    if (slot < 0 || slot >= MAX_SLOTS) return false;
+
+    const Slot &source = m_slots[slot];
+    for (;;) {
+        const quint32 before = source.sequence.load(std::memory_order_acquire);
+        if (before & 1u) continue;
+
+        std::memcpy(static_cast<void *>(&sample), &source.sample, sizeof(RobotSample));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (source.sequence.load(std::memory_order_relaxed) == before) {
+            return sample.isValid();
+        }
+    }
+}
+
+quint32 FleetSnapshot::sequence(int slot) const
+{
+    if (slot < 0 || slot >= MAX_SLOTS) return 0;
+    return m_slots[slot].sequence.load(std::memory_order_acquire);
+}
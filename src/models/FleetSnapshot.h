@@ -0,0 +1,89 @@
+#ifndef FLEETSNAPSHOT_H
+#define FLEETSNAPSHOT_H
+
+#include <QtGlobal>
+#include <array>
+#include <atomic>
+#include <type_traits>
+
+/**
+ * One robot's high-rate values in a fixed layout: no heap, no QVariant, safe
+ * to copy byte-wise between threads. address == 0 marks an empty slot.
+ */
+struct RobotSample
+{
+    static constexpr int MAX_CELLS = 24;
+    static constexpr int RSSI_HISTORY = 60;     // RssiMonitor::HISTORY_LENGTH
+
+    quint64 address = 0;
+    qint64 updatedNs = 0;           // MonotonicClock
+    quint32 updates = 0;            // samples written since the link opened
+    qint8 deviceType = 0;           // Robot::DeviceType
+    qint8 connectionState = 0;      // Robot::ConnectionState
+    qint16 rssi = 0;
+    qint16 linkQuality = 0;
+    qint16 playState = 0;
+    qint16 soc = 0;
+    qint16 cellCount = 0;
+    qint16 rssiHistoryCount = 0;
+    float batteryVoltage = 0.0f;
+    float totalVoltage = 0.0f;
+    float current = 0.0f;
+    float updateRate = 0.0f;
+    float lossPercent = 0.0f;
+    std::array<float, MAX_CELLS> cellVoltages{};
+    std::array<qint16, RSSI_HISTORY> rssiHistory{};
+
+    bool isValid() const { return address != 0; }
+};
+static_assert(std::is_trivially_copyable_v<RobotSample>, "RobotSample is copied under a seqlock");
+
+/**
+ * FleetSnapshot - latest RobotSample of every link, readable from any thread
+ * without locks.
+ *
+ * Each slot is a seqlock with a single writer: the LinkPublisher of the link
+ * that claimed it, on the BLE worker. Readers (the render thread, in
+ * updatePaintNode) copy a slot and retry if a write overlapped; they never
+ * block the writer and the writer never waits for them. sequence() lets a
+ * reader skip a slot that has not changed since it last looked.
+ *
+ * Slots are claimed on the GUI thread when a link opens and released by the
+ * writer when its publisher goes away, so a claimed slot is always written by
+ * exactly one thread.
+ */
+class FleetSnapshot
+{
+public:
+    static constexpr int MAX_SLOTS = 128;          // upper bound of BleConnectionManager::maxDevices()
+
+    FleetSnapshot() = default;
+    FleetSnapshot(const FleetSnapshot &) = delete;
+    FleetSnapshot &operator=(const FleetSnapshot &) = delete;
+
+    /** Claim a free slot for a new link; -1 if all are taken */
+    int claim();
+
+    /** Clear the slot and make it claimable again (by its writer) */
+    void release(int slot);
+
+    /** Publish a sample (by the slot's writer only) */
+    void write(int slot, const RobotSample &sample);
+
+    /** Consistent copy of a slot; false if the slot is empty */
+    bool read(int slot, RobotSample &sample) const;
+
+    /** Even and unchanged while the slot is not being written */
+    quint32 sequence(int slot) const;
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<quint32> sequence{0};
+        std::atomic<bool> claimed{false};
+        RobotSample sample;
+    };
+
+    std::array<Slot, MAX_SLOTS> m_slots;
+};
+
+#endif // FLEETSNAPSHOT_H
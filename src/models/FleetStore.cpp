@@ -0,0 +1,109 @@
+#include "FleetStore.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+FleetStore::Handle FleetStore::insert(const Robot &robot)
+{
+    Handle handle;
+    if (!m_free.isEmpty()) {
+        handle = m_free.takeLast();
+    } else {
+        handle = m_cold.size();
+        m_dirty.append(0);
+        m_connectionState.append(0);
+        m_deviceType.append(0);
+        m_rssi.append(0);
+        m_linkQuality.append(0);
+        m_snapshotSlot.append(0);
+        m_stale.append(false);
+        m_lastPacketNs.append(0);
+        m_playState.append(0);
+        m_soc.append(0);
+        m_totalMv.append(0);
+        m_currentMa.append(0);
+        m_batteryMv.append(0);
+        m_cells.append(Cells());
+        m_cold.append(Cold());
+    }
+
+    m_connectionState[handle] = quint8(robot.connectionState());
+    m_deviceType[handle] = quint8(robot.deviceType());
+    m_rssi[handle] = qint16(robot.rssi());
+    m_linkQuality[handle] = qint16(robot.linkQuality());
+    m_snapshotSlot[handle] = qint16(robot.snapshotSlot());
+    m_stale[handle] = robot.isStale();
+    m_lastPacketNs[handle] = robot.lastPacketTime();
+    m_playState[handle] = qint16(robot.playState());
+    m_soc[handle] = qint16(robot.soc());
+    m_totalMv[handle] = toMilli(robot.totalVoltage());
+    m_currentMa[handle] = toMilli(robot.current());
+    m_batteryMv[handle] = toMilli(robot.batteryVoltage());
+    m_cells[handle] = Cells();
+
+    Cold &cold = m_cold[handle];
+    cold.id = robot.id();
+    cold.name = robot.name();
+    cold.address = robot.bluetoothAddress();
+    cold.rssiHistory = robot.rssiHistory();
+    cold.statistics = robot.linkStatistics();
+    cold.lastPacket = robot.lastPacketReceived();
+    cold.wifiSsid = robot.wifiSsid();
+    cold.wifiList = robot.wifiList();
+    cold.robotIdentity = robot.robotIdentity();
+
+    m_dirty[handle] = 0;
+    setCellVoltages(handle, robot.cellVoltages());
+    m_dirty[handle] = AllFields;
+    return handle;
+}
+
+void FleetStore::remove(Handle robot)
+{
+    Q_ASSERT(robot >= 0 && robot < m_cold.size() && !m_free.contains(robot));
+
+    // Drop the heap-backed values now; the hot entries are overwritten on reuse
+    m_cold[robot] = Cold();
+    m_dirty[robot] = 0;
+    m_free.append(robot);
+}
+
+void FleetStore::clear()
+{
+    m_dirty.clear();
+    m_connectionState.clear();
+    m_deviceType.clear();
+    m_rssi.clear();
+    m_linkQuality.clear();
+    m_snapshotSlot.clear();
+    m_stale.clear();
+    m_lastPacketNs.clear();
+    m_playState.clear();
+    m_soc.clear();
+    m_totalMv.clear();
+    m_currentMa.clear();
+    m_batteryMv.clear();
+    m_cells.clear();
+    m_cold.clear();
+    m_free.clear();
+}
+
+quint32 FleetStore::takeDirty(Handle robot)
+{
+    return std::exchange(m_dirty[robot], 0u);
+}
+
+qint32 FleetStore::toMilli(float value)
+{
+    return qint32(std::lround(double(value) * 1000.0));
+}
+
+void FleetStore::setCellVoltages(Handle robot, const QList<float> &volts)
+{
+    Cells cells;
+    cells.count = quint8(std::min<qsizetype>(volts.size(), MAX_CELLS));
+    for (int i = 0; i < cells.count; ++i) {
+        cells.mv[i] = quint16(std::clamp(toMilli(volts.at(i)), 0, 0xFFFF));
+    }
+    assign(m_cells, robot, cells, CellVoltages);
+}
@@ -0,0 +1,212 @@
+#ifndef FLEETSTORE_H
+#define FLEETSTORE_H
+
+#include <QBluetoothAddress>
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <algorithm>
+#include <array>
+#include "Robot.h"
+
+/**
+ * FleetStore - every robot's state, one array per field.
+ *
+ * A robot is a Handle, an index into each array that stays valid until the
+ * robot is removed (handles are then reused). The values read at telemetry
+ * rate - state, RSSI, link quality, play state, SoC, voltages, current,
+ * cells - are kept as small fixed-point integers (mV, mA, %) in their own
+ * contiguous arrays, with BMS cells inline in a fixed-capacity block, so a
+ * pass over one field for the whole fleet touches only that field's cache
+ * lines. Strings, lists and link counters sit in a separate cold side table.
+ *
+ * Setters only write a value that actually changed and record that field in
+ * the handle's dirty mask; the owner (RobotListModel) takes the mask when it
+ * publishes the change. GUI thread only.
+ */
+class FleetStore
+{
+public:
+    using Handle = int;
+
+    static constexpr int MAX_CELLS = 24;        // RobotSample::MAX_CELLS
+
+    enum Field : quint32 {
+        Id              = 1u << 0,
+        Name            = 1u << 1,
+        Address         = 1u << 2,
+        ConnectionState = 1u << 3,
+        DeviceType      = 1u << 4,
+        Rssi            = 1u << 5,
+        LinkQuality     = 1u << 6,
+        RssiHistory     = 1u << 7,
+        Statistics      = 1u << 8,
+        SnapshotSlot    = 1u << 9,
+        Stale           = 1u << 10,
+        LastPacket      = 1u << 11,
+        LastPacketTime  = 1u << 12,
+        TotalVoltage    = 1u << 13,
+        Current         = 1u << 14,
+        Soc             = 1u << 15,
+        CellVoltages    = 1u << 16,
+        PlayState       = 1u << 17,
+        WifiSsid        = 1u << 18,
+        WifiList        = 1u << 19,
+        BatteryVoltage  = 1u << 20,
+        RobotIdentity   = 1u << 21,
+        AllFields       = (1u << 22) - 1
+    };
+
+    /** BMS cell voltages in mV, stored inline */
+    struct Cells {
+        quint8 count = 0;
+        std::array<quint16, MAX_CELLS> mv{};
+
+        bool operator==(const Cells &other) const
+        {
+            return count == other.count
+                && std::equal(mv.cbegin(), mv.cbegin() + count, other.mv.cbegin());
+        }
+        bool operator!=(const Cells &other) const { return !(*this == other); }
+    };
+
+    FleetStore() = default;
+    FleetStore(const FleetStore &) = delete;
+    FleetStore &operator=(const FleetStore &) = delete;
+
+    /** Add a robot with every field marked dirty */
+    Handle insert(const Robot &robot);
+    void remove(Handle robot);
+    void clear();
+
+    int count() const { return int(m_cold.size() - m_free.size()); }
+
+    /** Fields changed since the last call, cleared on return */
+    quint32 takeDirty(Handle robot);
+
+    /** Volts or amps to the stored milli-units */
+    static qint32 toMilli(float value);
+
+    // ── Hot fields ──
+    Robot::ConnectionState connectionState(Handle robot) const { return Robot::ConnectionState(m_connectionState.at(robot)); }
+    void setConnectionState(Handle robot, Robot::ConnectionState state) { assign(m_connectionState, robot, quint8(state), ConnectionState); }
+
+    Robot::DeviceType deviceType(Handle robot) const { return Robot::DeviceType(m_deviceType.at(robot)); }
+    void setDeviceType(Handle robot, Robot::DeviceType type) { assign(m_deviceType, robot, quint8(type), DeviceType); }
+
+    int rssi(Handle robot) const { return m_rssi.at(robot); }
+    void setRssi(Handle robot, int rssi) { assign(m_rssi, robot, qint16(rssi), Rssi); }
+
+    int linkQuality(Handle robot) const { return m_linkQuality.at(robot); }
+    void setLinkQuality(Handle robot, int quality) { assign(m_linkQuality, robot, qint16(quality), LinkQuality); }
+
+    int snapshotSlot(Handle robot) const { return m_snapshotSlot.at(robot); }
+    void setSnapshotSlot(Handle robot, int slot) { assign(m_snapshotSlot, robot, qint16(slot), SnapshotSlot); }
+
+    bool isStale(Handle robot) const { return m_stale.at(robot); }
+    void setStale(Handle robot, bool stale) { assign(m_stale, robot, stale, Stale); }
+
+    qint64 lastPacketTime(Handle robot) const { return m_lastPacketNs.at(robot); }
+    void setLastPacketTime(Handle robot, qint64 stampNs) { assign(m_lastPacketNs, robot, stampNs, LastPacketTime); }
+
+    int playState(Handle robot) const { return m_playState.at(robot); }
+    void setPlayState(Handle robot, int state) { assign(m_playState, robot, qint16(state), PlayState); }
+
+    int soc(Handle robot) const { return m_soc.at(robot); }
+    void setSoc(Handle robot, int soc) { assign(m_soc, robot, qint16(soc), Soc); }
+
+    qint32 totalMv(Handle robot) const { return m_totalMv.at(robot); }
+    void setTotalVoltage(Handle robot, float volts) { assign(m_totalMv, robot, toMilli(volts), TotalVoltage); }
+
+    qint32 currentMa(Handle robot) const { return m_currentMa.at(robot); }
+    void setCurrent(Handle robot, float amps) { assign(m_currentMa, robot, toMilli(amps), Current); }
+
+    qint32 batteryMv(Handle robot) const { return m_batteryMv.at(robot); }
+    void setBatteryVoltage(Handle robot, float volts) { assign(m_batteryMv, robot, toMilli(volts), BatteryVoltage); }
+
+    const Cells &cells(Handle robot) const { return m_cells.at(robot); }
+    void setCellVoltages(Handle robot, const QList<float> &volts);
+
+    // ── Cold fields ──
+    int id(Handle robot) const { return m_cold.at(robot).id; }
+
+    QString name(Handle robot) const { return m_cold.at(robot).name; }
+    void setName(Handle robot, const QString &name) { assignCold(&Cold::name, robot, name, Name); }
+
+    QBluetoothAddress address(Handle robot) const { return m_cold.at(robot).address; }
+
+    QList<int> rssiHistory(Handle robot) const { return m_cold.at(robot).rssiHistory; }
+    void setRssiHistory(Handle robot, const QList<int> &history) { assignCold(&Cold::rssiHistory, robot, history, RssiHistory); }
+
+    const LinkStatistics &linkStatistics(Handle robot) const { return m_cold.at(robot).statistics; }
+    void setLinkStatistics(Handle robot, const LinkStatistics &statistics) { assignCold(&Cold::statistics, robot, statistics, Statistics); }
+
+    QByteArray lastPacket(Handle robot) const { return m_cold.at(robot).lastPacket; }
+    void setLastPacket(Handle robot, const QByteArray &packet) { assignCold(&Cold::lastPacket, robot, packet, LastPacket); }
+
+    QString wifiSsid(Handle robot) const { return m_cold.at(robot).wifiSsid; }
+    void setWifiSsid(Handle robot, const QString &ssid) { assignCold(&Cold::wifiSsid, robot, ssid, WifiSsid); }
+
+    QStringList wifiList(Handle robot) const { return m_cold.at(robot).wifiList; }
+    void setWifiList(Handle robot, const QStringList &list) { assignCold(&Cold::wifiList, robot, list, WifiList); }
+
+    QString robotIdentity(Handle robot) const { return m_cold.at(robot).robotIdentity; }
+    void setRobotIdentity(Handle robot, const QString &identity) { assignCold(&Cold::robotIdentity, robot, identity, RobotIdentity); }
+
+private:
+    struct Cold {
+        int id = 0;
+        QString name;
+        QBluetoothAddress address;
+        QList<int> rssiHistory;
+        LinkStatistics statistics;
+        QByteArray lastPacket;
+        QString wifiSsid;
+        QStringList wifiList;
+        QString robotIdentity;
+    };
+
+    template <typename T>
+    void assign(QList<T> &array, Handle robot, T value, Field field)
+    {
+        T &stored = array[robot];
+        if (stored != value) {
+            stored = value;
+            m_dirty[robot] |= field;
+        }
+    }
+
+    template <typename T>
+    void assignCold(T Cold::*member, Handle robot, const T &value, Field field)
+    {
+        T &stored = m_cold[robot].*member;
+        if (stored != value) {
+            stored = value;
+            m_dirty[robot] |= field;
+        }
+    }
+
+    // Hot: one entry per handle in each array
+    QList<quint32> m_dirty;
+    QList<quint8> m_connectionState;
+    QList<quint8> m_deviceType;
+    QList<qint16> m_rssi;
+    QList<qint16> m_linkQuality;
+    QList<qint16> m_snapshotSlot;
+    QList<bool> m_stale;
+    QList<qint64> m_lastPacketNs;       // MonotonicClock
+    QList<qint16> m_playState;
+    QList<qint16> m_soc;                // %
+    QList<qint32> m_totalMv;
+    QList<qint32> m_currentMa;
+    QList<qint32> m_batteryMv;
+    QList<Cells> m_cells;
+
+    // Cold side table, same indexing
+    QList<Cold> m_cold;
+
+    QList<Handle> m_free;
+};
+
+#endif // FLEETSTORE_H
@@ -5,6 +5,10 @@ Robot::Robot()
     , m_connectionState(Disconnected)
     , m_deviceType(Unknown)
     , m_rssi(-100)
+    , m_linkQuality(0)
+    , m_snapshotSlot(-1)
+    , m_stale(false)
+    , m_lastPacketTime(0)
     , m_totalVoltage(0.0f)
     , m_current(0.0f)
     , m_soc(0)
@@ -20,6 +24,10 @@ Robot::Robot(int id, const QString &name, const QBluetoothAddress &address)
     , m_connectionState(Disconnected)
     , m_deviceType(Unknown)
     , m_rssi(-100)
+    , m_linkQuality(0)
+    , m_snapshotSlot(-1)
+    , m_stale(false)
+    , m_lastPacketTime(0)
     , m_totalVoltage(0.0f)
     , m_current(0.0f)
     , m_soc(0)
@@ -41,6 +49,8 @@ QString Robot::connectionStateToString(ConnectionState state)
         return QStringLiteral("Ready");
     case Error:
         return QStringLiteral("Error");
+    case Watching:
+        return QStringLiteral("Watching");
     default:
         return QStringLiteral("Unknown");
     }
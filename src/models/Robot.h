@@ -5,9 +5,34 @@
 #include <QString>
 #include <QStringList>
 #include <QBluetoothAddress>
-#include <QDateTime>
 #include <QByteArray>
 
+/**
+ * Notification delivery on a connected link, as measured by LinkQualityMonitor.
+ * Loss and reordering are only known when the peripheral sends sequence numbers.
+ */
+struct LinkStatistics
+{
+    bool sequenced = false;         // peripheral sends sequence numbers
+    double updateRate = 0.0;        // notifications per second
+    double lossPercent = 0.0;
+    double jitterMs = 0.0;          // mean deviation of inter-arrival time
+    qint64 received = 0;
+    qint64 lost = 0;
+    qint64 reordered = 0;
+    qint64 duplicates = 0;
+    int gaps = 0;                   // runs of one or more missing sequence numbers
+
+    bool operator==(const LinkStatistics &other) const
+    {
+        return sequenced == other.sequenced && updateRate == other.updateRate
+            && lossPercent == other.lossPercent && jitterMs == other.jitterMs
+            && received == other.received && lost == other.lost && reordered == other.reordered
+            && duplicates == other.duplicates && gaps == other.gaps;
+    }
+    bool operator!=(const LinkStatistics &other) const { return !(*this == other); }
+};
+
 class Robot
 {
 public:
@@ -16,7 +41,8 @@ public:
         Connecting,
         Connected,
         Ready,
-        Error
+        Error,
+        Watching        // no connection; fed by advertisement telemetry
     };
 
     // Device type — determines which UI and protocol to use
@@ -47,11 +73,30 @@ public:
     int rssi() const { return m_rssi; }
     void setRssi(int rssi) { m_rssi = rssi; }
 
+    // Link quality 0..100 from the filtered RSSI, and its recent history (dBm)
+    int linkQuality() const { return m_linkQuality; }
+    void setLinkQuality(int quality) { m_linkQuality = quality; }
+
+    QList<int> rssiHistory() const { return m_rssiHistory; }
+    void setRssiHistory(const QList<int> &history) { m_rssiHistory = history; }
+
+    LinkStatistics linkStatistics() const { return m_linkStatistics; }
+    void setLinkStatistics(const LinkStatistics &statistics) { m_linkStatistics = statistics; }
+
+    // FleetSnapshot slot the link publishes into (-1 without a connection)
+    int snapshotSlot() const { return m_snapshotSlot; }
+    void setSnapshotSlot(int slot) { m_snapshotSlot = slot; }
+
+    // Connected, but no data within the link's staleness deadline
+    bool isStale() const { return m_stale; }
+    void setStale(bool stale) { m_stale = stale; }
+
     QByteArray lastPacketReceived() const { return m_lastPacketReceived; }
     void setLastPacketReceived(const QByteArray &packet) { m_lastPacketReceived = packet; }
 
-    QDateTime lastPacketTime() const { return m_lastPacketTime; }
-    void setLastPacketTime(const QDateTime &time) { m_lastPacketTime = time; }
+    // MonotonicClock stamp (ns) of the last data received; 0 before any
+    qint64 lastPacketTime() const { return m_lastPacketTime; }
+    void setLastPacketTime(qint64 stampNs) { m_lastPacketTime = stampNs; }
 
     // ── BMS data ──
     float totalVoltage() const { return m_totalVoltage; }
@@ -93,8 +138,13 @@ private:
     ConnectionState m_connectionState;
     DeviceType m_deviceType;
     int m_rssi;
+    int m_linkQuality;
+    QList<int> m_rssiHistory;
+    LinkStatistics m_linkStatistics;
+    int m_snapshotSlot;
+    bool m_stale;
     QByteArray m_lastPacketReceived;
-    QDateTime m_lastPacketTime;
+    qint64 m_lastPacketTime;
 
     // BMS data
     float m_totalVoltage;
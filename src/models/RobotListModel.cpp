@@ -1,7 +1,10 @@
 #include "RobotListModel.h"
+#include "src/protocol/MonotonicClock.h"
+#include <algorithm>
 
 RobotListModel::RobotListModel(QObject *parent)
     : QAbstractListModel(parent)
+    , m_aggregates(new FleetAggregates(&m_store, this))
 {
 }
 
@@ -9,66 +12,158 @@ int RobotListModel::rowCount(const QModelIndex &parent) const
 {
     if (parent.isValid())
         return 0;
-    return m_robots.count();
+    return m_rows.count();
 }
 
 QVariant RobotListModel::data(const QModelIndex &index, int role) const
 {
-    if (!index.isValid() || index.row() >= m_robots.count())
+    if (!index.isValid() || index.row() >= m_rows.count())
+        return QVariant();
+    if (role < NameRole || role > StaleRole)
         return QVariant();
 
-    const Robot &robot = m_robots.at(index.row());
-
+    const Row &row = m_rows.at(index.row());
+    const FleetStore::Handle robot = row.handle;
     switch (role) {
-    case NameRole:
-        return robot.name();
-    case AddressRole:
-        return robot.bluetoothAddress().toString();
-    case ConnectionStateRole:
-        return Robot::connectionStateToString(robot.connectionState());
-    case RssiRole:
-        return robot.rssi();
-    case LastDataRole:
-        return robot.lastPacketReceived().toHex(':');
-    case LastDataTimeRole:
-        return robot.lastPacketTime().toString("hh:mm:ss");
     case IdRole:
-        return robot.id();
+        return m_store.id(robot);
+    case RssiRole:
+        return m_store.rssi(robot);
+    case LinkQualityRole:
+        return m_store.linkQuality(robot);
+    case SnapshotSlotRole:
+        return m_store.snapshotSlot(robot);
+    case StaleRole:
+        return m_store.isStale(robot);
+    case PlayStateRole:
+        return m_store.playState(robot);
+    case SocRole:
+        return m_store.soc(robot);
     case TotalVoltageRole:
-        return robot.totalVoltage();
+        return m_store.totalMv(robot) / 1000.0;
     case CurrentRole:
-        return robot.current();
-    case SocRole:
-        return robot.soc();
-    case CellVoltagesRole: {
-        QVariantList list;
-        for (float v : robot.cellVoltages()) {
-            list.append(v);
+        return m_store.currentMa(robot) / 1000.0;
+    case BatteryVoltageRole:
+        return m_store.batteryMv(robot) / 1000.0;
+    case UpdateRateRole:
+        return m_store.linkStatistics(robot).updateRate;
+    case LossPercentRole:
+        return m_store.linkStatistics(robot).lossPercent;
+    case JitterRole:
+        return m_store.linkStatistics(robot).jitterMs;
+    default:
+        // Built in refresh(); copying a cached QVariant only bumps a reference count
+        return row.values[role - NameRole];
+    }
+}
+
+QList<int> RobotListModel::refresh(Row &row, quint32 fields)
+{
+    const FleetStore::Handle robot = row.handle;
+    QList<int> changed;
+    auto mark = [fields, &changed](FleetStore::Field field, int role) {
+        if (fields & field) {
+            changed.append(role);
+        }
+    };
+    auto set = [&row, &changed](int role, QVariant value) {
+        QVariant &cached = row.values[role - NameRole];
+        if (cached != value) {
+            cached = std::move(value);
+            changed.append(role);
+        }
+    };
+
+    // Numeric roles are read from the store; the store only flags a field that changed
+    mark(FleetStore::Id, IdRole);
+    mark(FleetStore::Rssi, RssiRole);
+    mark(FleetStore::LinkQuality, LinkQualityRole);
+    mark(FleetStore::SnapshotSlot, SnapshotSlotRole);
+    mark(FleetStore::Stale, StaleRole);
+    mark(FleetStore::PlayState, PlayStateRole);
+    mark(FleetStore::Soc, SocRole);
+    mark(FleetStore::TotalVoltage, TotalVoltageRole);
+    mark(FleetStore::Current, CurrentRole);
+    mark(FleetStore::BatteryVoltage, BatteryVoltageRole);
+    mark(FleetStore::Statistics, UpdateRateRole);
+    mark(FleetStore::Statistics, LossPercentRole);
+    mark(FleetStore::Statistics, JitterRole);
+
+    // Built values are only rebuilt when their source field changed
+    if (fields & FleetStore::Name)
+        set(NameRole, m_store.name(robot));
+    if (fields & FleetStore::Address)
+        set(AddressRole, m_store.address(robot).toString());
+    if (fields & FleetStore::ConnectionState)
+        set(ConnectionStateRole, Robot::connectionStateToString(m_store.connectionState(robot)));
+    if (fields & FleetStore::DeviceType)
+        set(DeviceTypeRole, Robot::deviceTypeToString(m_store.deviceType(robot)));
+    if (fields & FleetStore::PlayState)
+        set(PlayStateLabelRole, Robot::playStateToString(m_store.playState(robot)));
+    if (fields & FleetStore::WifiSsid)
+        set(WifiSsidRole, m_store.wifiSsid(robot));
+    if (fields & FleetStore::RobotIdentity)
+        set(RobotIdentityRole, m_store.robotIdentity(robot));
+    if (fields & FleetStore::LastPacket)
+        set(LastDataRole, m_store.lastPacket(robot).toHex(':'));
+    if (fields & FleetStore::LastPacketTime) {
+        // Shown to the second; only reformatted when that second changes
+        const qint64 stampNs = m_store.lastPacketTime(robot);
+        if (stampNs / 1000000000 != row.lastDataSecond) {
+            row.lastDataSecond = stampNs / 1000000000;
+            set(LastDataTimeRole, MonotonicClock::toString(stampNs, "hh:mm:ss"));
         }
-        return list;
     }
-    case DeviceTypeRole:
-        return Robot::deviceTypeToString(robot.deviceType());
-    case PlayStateRole:
-        return robot.playState();
-    case PlayStateLabelRole:
-        return Robot::playStateToString(robot.playState());
-    case WifiSsidRole:
-        return robot.wifiSsid();
-    case WifiListRole: {
-        QVariantList list;
-        for (const QString &s : robot.wifiList()) {
-            list.append(s);
+    if (fields & FleetStore::CellVoltages) {
+        const FleetStore::Cells &cells = m_store.cells(robot);
+        QList<qreal> volts;
+        volts.reserve(cells.count);
+        for (int i = 0; i < cells.count; ++i) {
+            volts.append(cells.mv[i] / 1000.0);
+        }
+        set(CellVoltagesRole, QVariant::fromValue(volts));
+
+        // Card text is formatted here once per reading, not per binding in QML
+        QStringList readout;
+        readout.reserve(cells.count);
+        for (int i = 0; i < cells.count; ++i) {
+            readout.append(QStringLiteral("C%1\u00a0%2V")      // no break inside a cell
+                               .arg(i + 1).arg(cells.mv[i] / 1000.0, 0, 'f', 3));
         }
-        return list;
+        set(CellReadoutRole, readout.join(QStringLiteral("  ")));
+
+        QString summary;
+        int spreadMv = 0;
+        if (cells.count > 0) {
+            const auto [lowest, highest] = std::minmax_element(cells.mv.cbegin(),
+                                                               cells.mv.cbegin() + cells.count);
+            spreadMv = *highest - *lowest;
+            summary = QStringLiteral("min %1V  max %2V  \u0394 %3 mV")
+                          .arg(*lowest / 1000.0, 0, 'f', 3)
+                          .arg(*highest / 1000.0, 0, 'f', 3)
+                          .arg(spreadMv);
+        }
+        set(CellSummaryRole, summary);
+        set(CellSpreadRole, spreadMv);
     }
-    case BatteryVoltageRole:
-        return robot.batteryVoltage();
-    case RobotIdentityRole:
-        return robot.robotIdentity();
-    default:
-        return QVariant();
+    if (fields & FleetStore::WifiList)
+        set(WifiListRole, QVariant::fromValue(m_store.wifiList(robot)));
+    if (fields & FleetStore::RssiHistory)
+        set(RssiHistoryRole, QVariant::fromValue(m_store.rssiHistory(robot)));
+
+    if (fields & FleetStore::Statistics) {
+        const LinkStatistics &statistics = m_store.linkStatistics(robot);
+        QVariantMap counters;
+        counters["sequenced"] = statistics.sequenced;
+        counters["received"] = statistics.received;
+        counters["lost"] = statistics.lost;
+        counters["reordered"] = statistics.reordered;
+        counters["duplicates"] = statistics.duplicates;
+        counters["gaps"] = statistics.gaps;
+        set(LinkCountersRole, counters);
     }
+
+    return changed;
 }
 
 QHash<int, QByteArray> RobotListModel::roleNames() const
@@ -85,6 +180,9 @@ QHash<int, QByteArray> RobotListModel::roleNames() const
     roles[CurrentRole] = "current";
     roles[SocRole] = "soc";
     roles[CellVoltagesRole] = "cellVoltages";
+    roles[CellReadoutRole] = "cellReadout";
+    roles[CellSummaryRole] = "cellSummary";
+    roles[CellSpreadRole] = "cellSpreadMv";
     roles[DeviceTypeRole] = "deviceType";
     roles[PlayStateRole] = "playState";
     roles[PlayStateLabelRole] = "playStateLabel";
@@ -92,44 +190,139 @@ QHash<int, QByteArray> RobotListModel::roleNames() const
     roles[WifiListRole] = "wifiList";
     roles[BatteryVoltageRole] = "batteryVoltage";
     roles[RobotIdentityRole] = "robotIdentity";
+    roles[LinkQualityRole] = "linkQuality";
+    roles[RssiHistoryRole] = "rssiHistory";
+    roles[UpdateRateRole] = "updateRate";
+    roles[LossPercentRole] = "lossPercent";
+    roles[JitterRole] = "jitterMs";
+    roles[LinkCountersRole] = "linkCounters";
+    roles[SnapshotSlotRole] = "snapshotSlot";
+    roles[StaleRole] = "stale";
     return roles;
 }
 
 void RobotListModel::addRobot(const Robot &robot)
 {
-    beginInsertRows(QModelIndex(), m_robots.count(), m_robots.count());
-    m_robots.append(robot);
+    Row row;
+    row.handle = m_store.insert(robot);
+    m_aggregates->insert(row.handle);
+    refresh(row, m_store.takeDirty(row.handle));
+
+    beginInsertRows(QModelIndex(), m_rows.count(), m_rows.count());
+    m_rowByAddress.insert(robot.bluetoothAddress().toUInt64(), m_rows.count());
+    m_rows.append(std::move(row));
     endInsertRows();
 }
 
-void RobotListModel::updateRobot(int index, const Robot &robot)
+void RobotListModel::addRobots(const QList<Robot> &robots)
 {
-    if (index >= 0 && index < m_robots.count()) {
-        m_robots[index] = robot;
-        QModelIndex modelIndex = createIndex(index, 0);
-        emit dataChanged(modelIndex, modelIndex);
+    if (robots.isEmpty()) {
+        return;
+    }
+
+    const int first = m_rows.count();
+    beginInsertRows(QModelIndex(), first, first + robots.count() - 1);
+    m_rows.reserve(first + robots.count());
+    m_rowByAddress.reserve(first + robots.count());
+    for (const Robot &robot : robots) {
+        Row row;
+        row.handle = m_store.insert(robot);
+        m_aggregates->insert(row.handle);
+        refresh(row, m_store.takeDirty(row.handle));
+        m_rowByAddress.insert(robot.bluetoothAddress().toUInt64(), m_rows.count());
+        m_rows.append(std::move(row));
+    }
+    endInsertRows();
+}
+
+void RobotListModel::commit(int index)
+{
+    if (index >= 0 && index < m_rows.count()) {
+        Row &row = m_rows[index];
+        const quint32 fields = m_store.takeDirty(row.handle);
+        if (fields == 0) {
+            return;
+        }
+        m_aggregates->update(row.handle, fields);
+
+        const QList<int> roles = refresh(row, fields);
+        if (!roles.isEmpty()) {
+            QModelIndex modelIndex = createIndex(index, 0);
+            emit dataChanged(modelIndex, modelIndex, roles);
+        }
     }
 }
 
 void RobotListModel::removeRobot(int index)
 {
-    if (index >= 0 && index < m_robots.count()) {
+    if (index >= 0 && index < m_rows.count()) {
         beginRemoveRows(QModelIndex(), index, index);
-        m_robots.removeAt(index);
+        const FleetStore::Handle handle = m_rows.takeAt(index).handle;
+        rebuildIndex();
         endRemoveRows();
+        m_aggregates->remove(handle);
+        m_store.remove(handle);
+    }
+}
+
+void RobotListModel::removeRobots(QList<int> indexes)
+{
+    std::sort(indexes.begin(), indexes.end());
+    indexes.erase(std::unique(indexes.begin(), indexes.end()), indexes.end());
+    indexes.erase(std::remove_if(indexes.begin(), indexes.end(),
+                                 [this](int index) { return index < 0 || index >= m_rows.count(); }),
+                  indexes.end());
+    if (indexes.isEmpty()) {
+        return;
+    }
+    if (indexes.count() == m_rows.count()) {
+        clear();
+        return;
+    }
+
+    // From the back, so the runs still to go keep their indexes
+    int end = indexes.count();
+    while (end > 0) {
+        int begin = end - 1;
+        while (begin > 0 && indexes.at(begin - 1) == indexes.at(begin) - 1) {
+            --begin;
+        }
+        const int first = indexes.at(begin);
+        const int last = indexes.at(end - 1);
+
+        beginRemoveRows(QModelIndex(), first, last);
+        QList<FleetStore::Handle> handles;
+        handles.reserve(last - first + 1);
+        for (int index = first; index <= last; ++index) {
+            handles.append(m_rows.at(index).handle);
+        }
+        m_rows.remove(first, last - first + 1);
+        rebuildIndex();
+        endRemoveRows();
+        for (FleetStore::Handle handle : handles) {
+            m_aggregates->remove(handle);
+            m_store.remove(handle);
+        }
+        end = begin;
     }
 }
 
 void RobotListModel::clear()
 {
     beginResetModel();
-    m_robots.clear();
+    m_rows.clear();
+    m_rowByAddress.clear();
+    m_store.clear();
+    m_aggregates->clear();
     endResetModel();
 }
 
-Robot RobotListModel::robotAt(int index) const
+void RobotListModel::rebuildIndex()
 {
-    if (index >= 0 && index < m_robots.count())
-        return m_robots.at(index);
-    return Robot();
+    // Rows after a removed one move up; removal is rare next to lookups
+    m_rowByAddress.clear();
+    m_rowByAddress.reserve(m_rows.count());
+    for (int row = 0; row < m_rows.count(); ++row) {
+        m_rowByAddress.insert(m_store.address(m_rows.at(row).handle).toUInt64(), row);
+    }
 }
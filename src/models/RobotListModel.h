@@ -2,9 +2,28 @@
 #define ROBOTLISTMODEL_H
 
 #include <QAbstractListModel>
+#include <QHash>
 #include <QList>
+#include <QVariant>
+#include <array>
+#include "FleetAggregates.h"
+#include "FleetStore.h"
 #include "Robot.h"
 
+/**
+ * RobotListModel - the connected and watched devices, one row per device.
+ *
+ * Row state lives in a FleetStore: the model keeps each row's store handle
+ * and the display values that need building (strings, hex dumps, timestamps,
+ * labels, lists), rebuilt only when their field changed. Numeric roles are
+ * read straight from the store's field arrays, so data() does not allocate.
+ * List roles are typed sequences (QList<qreal>, QList<int>, QStringList)
+ * rather than QVariantLists.
+ *
+ * Updates are written into store() in place and published with commit(),
+ * which emits one dataChanged() naming only the roles whose fields changed.
+ * The same changes keep aggregates() up to date.
+ */
 class RobotListModel : public QAbstractListModel
 {
     Q_OBJECT
@@ -22,14 +41,26 @@ public:
         CurrentRole,
         SocRole,
         CellVoltagesRole,
+        CellReadoutRole,
+        CellSummaryRole,
+        CellSpreadRole,
         DeviceTypeRole,
         PlayStateRole,
         PlayStateLabelRole,
         WifiSsidRole,
         WifiListRole,
         BatteryVoltageRole,
-        RobotIdentityRole
+        RobotIdentityRole,
+        LinkQualityRole,
+        RssiHistoryRole,
+        UpdateRateRole,
+        LossPercentRole,
+        JitterRole,
+        LinkCountersRole,
+        SnapshotSlotRole,
+        StaleRole
     };
+    static constexpr int ROLE_COUNT = StaleRole - NameRole + 1;
 
     explicit RobotListModel(QObject *parent = nullptr);
 
@@ -38,15 +69,50 @@ public:
     QHash<int, QByteArray> roleNames() const override;
 
     void addRobot(const Robot &robot);
-    void updateRobot(int index, const Robot &robot);
     void removeRobot(int index);
     void clear();
 
-    Robot robotAt(int index) const;
-    int count() const { return m_robots.count(); }
+    /** Append several rows with one insert */
+    void addRobots(const QList<Robot> &robots);
+
+    /**
+     * Remove several rows, one removal per contiguous run; removing every row
+     * is a single model reset. Out-of-range and repeated indexes are ignored.
+     */
+    void removeRobots(QList<int> indexes);
+
+    int count() const { return m_rows.count(); }
+
+    /** Row of a device by address, or -1 (hash lookup) */
+    int indexOf(const QBluetoothAddress &address) const { return m_rowByAddress.value(address.toUInt64(), -1); }
+
+    /** Store handle of a row; stays valid until the row is removed */
+    FleetStore::Handle handleAt(int index) const { return m_rows.at(index).handle; }
+
+    FleetStore *store() { return &m_store; }
+    const FleetStore *store() const { return &m_store; }
+
+    /** Fleet-wide counts and battery figures over all rows */
+    FleetAggregates *aggregates() const { return m_aggregates; }
+
+    /** Publish the fields written to a row's handle since its last commit */
+    void commit(int index);
 
 private:
-    QList<Robot> m_robots;
+    struct Row {
+        FleetStore::Handle handle = -1;
+        qint64 lastDataSecond = -1;                 // second shown by LastDataTimeRole
+        std::array<QVariant, ROLE_COUNT> values;    // by role - NameRole; built roles only
+    };
+
+    /** Rebuild the display values of `fields`; returns the roles that changed */
+    QList<int> refresh(Row &row, quint32 fields);
+    void rebuildIndex();
+
+    FleetStore m_store;
+    FleetAggregates *m_aggregates;
+    QList<Row> m_rows;
+    QHash<quint64, int> m_rowByAddress;
 };
 
 #endif // ROBOTLISTMODEL_H
@@ -0,0 +1,47 @@
+#include "AdvertisementTelemetry.h"
+#include <QBluetoothDeviceInfo>
+
+AdvertisementTelemetry AdvertisementTelemetry::decode(const QBluetoothDeviceInfo &device)
+{
+    const QByteArray data = device.manufacturerData(COMPANY_ID);
+    if (data.isEmpty()) {
+        return AdvertisementTelemetry();
+    }
+    return decode(data);
+}
+
+AdvertisementTelemetry AdvertisementTelemetry::decode(const QByteArray &data)
+{
+    AdvertisementTelemetry telemetry;
+    if (data.size() < 3 || static_cast<quint8>(data[1]) != VERSION) {
+        return telemetry;
+    }
+
+    auto u8 = [&data](int pos) { return static_cast<quint8>(data[pos]); };
+    auto u16 = [&data](int pos) {
+        return static_cast<quint16>(static_cast<quint8>(data[pos]) |
+                                    (static_cast<quint8>(data[pos + 1]) << 8));
+    };
+
+    switch (data[0]) {
+    case 'F':
+        if (data.size() < ROBOT_RECORD_SIZE) break;
+        telemetry.kind = RobotRecord;
+        telemetry.sequence = u8(2);
+        telemetry.playState = u8(3);
+        telemetry.batteryVoltage = u16(4) / 1000.0f;
+        break;
+    case 'B':
+        if (data.size() < BMS_RECORD_SIZE) break;
+        telemetry.kind = BmsRecord;
+        telemetry.sequence = u8(2);
+        telemetry.soc = u8(3);
+        telemetry.totalVoltage = u16(4) / 1000.0f;
+        telemetry.current = static_cast<qint16>(u16(6)) / 100.0f;
+        break;
+    default:
+        break;
+    }
+
+    return telemetry;
+}
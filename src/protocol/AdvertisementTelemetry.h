@@ -0,0 +1,55 @@
+#ifndef ADVERTISEMENTTELEMETRY_H
+#define ADVERTISEMENTTELEMETRY_H
+
+#include <QtGlobal>
+#include <QByteArray>
+
+class QBluetoothDeviceInfo;
+
+/**
+ * AdvertisementTelemetry - compact status record broadcast in advertisements.
+ *
+ * Peripherals that support connectionless monitoring put a small record in
+ * their manufacturer-specific data (company ID COMPANY_ID), so a watched
+ * device never needs a GATT connection just to be seen:
+ *
+ *   Robot:  'F' <ver=1> <seq> <play_state> <battery_mv u16>             (6 bytes)
+ *   BMS:    'B' <ver=1> <seq> <soc> <total_mv u16> <current_10ma s16>   (8 bytes)
+ *
+ * Multi-byte fields are little-endian. seq increments whenever the content
+ * changes, so repeated advertisements of the same state can be skipped.
+ */
+class AdvertisementTelemetry
+{
+public:
+    enum Kind {
+        None,
+        RobotRecord,
+        BmsRecord
+    };
+
+    static constexpr quint16 COMPANY_ID = 0xFFFF;      // Bluetooth SIG "internal use / testing"
+    static constexpr quint8 VERSION = 1;
+    static constexpr int ROBOT_RECORD_SIZE = 6;
+    static constexpr int BMS_RECORD_SIZE = 8;
+
+    /** Decode the record from an advertisement; isValid() is false if there is none */
+    static AdvertisementTelemetry decode(const QBluetoothDeviceInfo &device);
+    static AdvertisementTelemetry decode(const QByteArray &manufacturerData);
+
+    bool isValid() const { return kind != None; }
+
+    Kind kind = None;
+    quint8 sequence = 0;
+
+    // Robot
+    int playState = 0;
+    float batteryVoltage = 0.0f;
+
+    // BMS
+    int soc = 0;
+    float totalVoltage = 0.0f;
+    float current = 0.0f;
+};
+
+#endif // ADVERTISEMENTTELEMETRY_H
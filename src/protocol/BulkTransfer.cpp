@@ -0,0 +1,654 @@
+#include "BulkTransfer.h"
+#include "PacketInterface.h"
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <algorithm>
+#include <cstring>
+
+BulkTransfer::BulkTransfer(PacketInterface *packetInterface, QObject *parent)
+    : QObject(parent)
+    , m_packetInterface(packetInterface)
+    , m_retransmitTimer(new QTimer(this))
+    , m_elapsedAtFinishMs(-1)
+    , m_state(Idle)
+    , m_transferId(0)
+    , m_nextTransferId(1)
+    , m_chunkSize(DEFAULT_CHUNK_SIZE)
+    , m_windowSize(DEFAULT_WINDOW_SIZE)
+    , m_totalSize(0)
+    , m_startOffset(0)
+    , m_ackedOffset(0)
+    , m_nextOffset(0)
+    , m_isSender(false)
+    , m_retransmits(0)
+    , m_duplicateAcks(0)
+    , m_packetsSinceAck(0)
+    , m_stagingUsed(0)
+{
+    m_retransmitTimer->setSingleShot(true);
+    m_retransmitTimer->setInterval(RETRANSMIT_TIMEOUT_MS);
+    connect(m_retransmitTimer, &QTimer::timeout, this, &BulkTransfer::onRetransmitTimeout);
+
+    connect(m_packetInterface, &PacketInterface::packetReceived,
+            this, &BulkTransfer::onPacketReceived);
+}
+
+BulkTransfer::~BulkTransfer()
+{
+    // Staged bytes past the last flush are dropped; the ".resume" sidecar
+    // still points at data that is safely on disk.
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+}
+
+void BulkTransfer::setChunkSize(int bytes)
+{
+    m_chunkSize = std::clamp(bytes, 1, PacketInterface::MAX_PAYLOAD_SIZE - DATA_HEADER_SIZE);
+}
+
+void BulkTransfer::setWindowSize(int packets)
+{
+    m_windowSize = std::max(1, packets);
+}
+
+qint64 BulkTransfer::bytesTransferred() const
+{
+    return (m_isSender ? m_ackedOffset : m_nextOffset) - m_startOffset;
+}
+
+double BulkTransfer::throughput() const
+{
+    if (!m_elapsed.isValid()) {
+        return 0.0;
+    }
+    qint64 ms = m_elapsedAtFinishMs >= 0 ? m_elapsedAtFinishMs : m_elapsed.elapsed();
+    if (ms <= 0) {
+        return 0.0;
+    }
+    return bytesTransferred() * 1000.0 / ms;
+}
+
+double BulkTransfer::theoreticalThroughput(int attMtu, double connectionIntervalMs, int packetsPerEvent)
+{
+    // ATT write header (3) + packet frame header (3) + packet kind/id (2) + DATA offset (4)
+    const int payload = attMtu - 3 - PacketInterface::HEADER_SIZE - DATA_HEADER_SIZE;
+    if (payload <= 0 || connectionIntervalMs <= 0.0) {
+        return 0.0;
+    }
+    return payload * packetsPerEvent * 1000.0 / connectionIntervalMs;
+}
+
+// ── Initiator ──
+
+bool BulkTransfer::startDownload(const QString &remoteName, const QString &localPath)
+{
+    if (isActive()) {
+        qWarning() << "BulkTransfer: Transfer already in progress";
+        return false;
+    }
+
+    resetTransfer();
+    m_isSender = false;
+    m_finalPath = localPath;
+    m_transferId = m_nextTransferId++;
+
+    // Resume from whatever a previous attempt flushed to disk
+    qint64 resumeOffset = 0;
+    if (QFile::exists(localPath + QStringLiteral(".part"))) {
+        resumeOffset = readResumeOffset(localPath + QStringLiteral(".resume"));
+    }
+
+    QByteArray body;
+    body.append(static_cast<char>(0));   // download
+    appendUint32(body, static_cast<quint32>(resumeOffset));
+    appendUint32(body, 0);
+    body.append(remoteName.toUtf8());
+    m_openBody = body;
+    sendPacket(Open, body);
+
+    qDebug() << "BulkTransfer: Requesting download of" << remoteName
+             << "to" << localPath << "from offset" << resumeOffset;
+
+    setState(Opening);
+    m_retransmitTimer->start();
+    return true;
+}
+
+bool BulkTransfer::startUpload(const QString &localPath, const QString &remoteName)
+{
+    if (isActive()) {
+        qWarning() << "BulkTransfer: Transfer already in progress";
+        return false;
+    }
+
+    resetTransfer();
+    m_isSender = true;
+    m_transferId = m_nextTransferId++;
+
+    if (!openSource(localPath, 0)) {
+        return false;
+    }
+
+    QByteArray body;
+    body.append(static_cast<char>(1));   // upload
+    appendUint32(body, 0);
+    appendUint32(body, static_cast<quint32>(m_totalSize));
+    body.append(remoteName.toUtf8());
+    m_openBody = body;
+    sendPacket(Open, body);
+
+    qDebug() << "BulkTransfer: Requesting upload of" << localPath << "as" << remoteName
+             << "(" << m_totalSize << "bytes)";
+
+    setState(Opening);
+    m_retransmitTimer->start();
+    return true;
+}
+
+void BulkTransfer::abort(const QString &reason)
+{
+    if (!isActive()) {
+        return;
+    }
+    fail(reason.isEmpty() ? QStringLiteral("Aborted") : reason, true);
+}
+
+// ── Incoming packets ──
+
+void BulkTransfer::onPacketReceived(const QByteArray &packet)
+{
+    if (packet.size() < 2) {
+        return;
+    }
+
+    const uint8_t kind = static_cast<uint8_t>(packet[0]);
+    const uint8_t id = static_cast<uint8_t>(packet[1]);
+
+    // The sender keeps retransmitting until it hears our final ACK; it may have been lost
+    if (m_state == Completed && !m_isSender && id == m_transferId
+        && (kind == Data || (kind == Open && !m_acceptBody.isEmpty()))) {
+        sendAck();
+        return;
+    }
+
+    if (kind == Open) {
+        handleOpen(packet);
+        return;
+    }
+
+    if (kind < Open || kind > Abort || id != m_transferId || !isActive()) {
+        return; // Not ours (RPC traffic, stale transfer, ...)
+    }
+
+    switch (kind) {
+    case Accept: {
+        if (m_state != Opening || packet.size() < 10) {
+            return;
+        }
+        const qint64 offset = readUint32(packet, 2);
+        const qint64 size = readUint32(packet, 6);
+        if (m_isSender) {
+            beginSending(std::min(offset, m_totalSize));
+        } else if (openSink(m_finalPath, size, std::min(offset, size))) {
+            sendAck();
+        }
+        break;
+    }
+    case Data:
+        if (m_state == Receiving && packet.size() >= DATA_HEADER_SIZE) {
+            handleData(readUint32(packet, 2), packet.constData() + DATA_HEADER_SIZE,
+                       packet.size() - DATA_HEADER_SIZE);
+        }
+        break;
+    case Ack:
+        if (m_state == Sending && packet.size() >= 6) {
+            handleAck(readUint32(packet, 2));
+        }
+        break;
+    case Abort:
+        fail(QStringLiteral("Peer aborted: ") + QString::fromUtf8(packet.mid(2)), false);
+        break;
+    default:
+        break;
+    }
+}
+
+void BulkTransfer::handleOpen(const QByteArray &packet)
+{
+    const uint8_t id = static_cast<uint8_t>(packet[1]);
+
+    auto reject = [this, id](const QString &reason) {
+        QByteArray out;
+        out.append(static_cast<char>(Abort));
+        out.append(static_cast<char>(id));
+        out.append(reason.toUtf8());
+        m_packetInterface->sendPacket(out);
+    };
+
+    if (packet.size() < 11) {
+        return;
+    }
+    if (isActive()) {
+        // The peer resends OPEN when our ACCEPT was lost
+        if (id == m_transferId && !m_acceptBody.isEmpty()) {
+            sendPacket(Accept, m_acceptBody);
+            return;
+        }
+        reject(QStringLiteral("busy"));
+        return;
+    }
+    if (m_serveDirectory.isEmpty()) {
+        reject(QStringLiteral("not serving"));
+        return;
+    }
+
+    const bool peerUploads = packet[2] != 0;
+    const qint64 offset = readUint32(packet, 3);
+    const qint64 size = readUint32(packet, 7);
+
+    // Only plain file names inside the serve directory
+    const QString name = QFileInfo(QString::fromUtf8(packet.mid(11))).fileName();
+    if (name.isEmpty()) {
+        reject(QStringLiteral("bad name"));
+        return;
+    }
+    const QString path = QDir(m_serveDirectory).filePath(name);
+
+    resetTransfer();
+    m_transferId = id;
+
+    QByteArray body;
+    if (peerUploads) {
+        m_isSender = false;
+        qint64 resumeOffset = 0;
+        if (QFile::exists(path + QStringLiteral(".part"))) {
+            resumeOffset = std::min(readResumeOffset(path + QStringLiteral(".resume")), size);
+        }
+        m_finalPath = path;
+        appendUint32(body, static_cast<quint32>(resumeOffset));
+        appendUint32(body, static_cast<quint32>(size));
+        m_acceptBody = body;
+        sendPacket(Accept, body);
+        openSink(path, size, resumeOffset);
+    } else {
+        m_isSender = true;
+        if (!openSource(path, 0)) {
+            return;
+        }
+        const qint64 start = std::min(offset, m_totalSize);
+        appendUint32(body, static_cast<quint32>(start));
+        appendUint32(body, static_cast<quint32>(m_totalSize));
+        m_acceptBody = body;
+        sendPacket(Accept, body);
+        beginSending(start);
+    }
+}
+
+// ── Sender ──
+
+bool BulkTransfer::openSource(const QString &path, qint64 offset)
+{
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        fail(QStringLiteral("Cannot open %1: %2").arg(path, m_file.errorString()), true);
+        return false;
+    }
+    if (m_file.size() > 0xFFFFFFFFLL) {
+        fail(QStringLiteral("File too large for transfer: %1").arg(path), true);
+        return false;
+    }
+    m_totalSize = m_file.size();
+    m_startOffset = offset;
+    m_ackedOffset = offset;
+    m_nextOffset = offset;
+    return true;
+}
+
+void BulkTransfer::beginSending(qint64 offset)
+{
+    m_startOffset = offset;
+    m_ackedOffset = offset;
+    m_nextOffset = offset;
+    m_elapsed.start();
+    setState(Sending);
+
+    if (m_ackedOffset >= m_totalSize) {
+        complete();
+        return;
+    }
+    pumpWindow();
+}
+
+void BulkTransfer::pumpWindow()
+{
+    const qint64 windowBytes = qint64(m_windowSize) * m_chunkSize;
+
+    while (m_state == Sending && m_nextOffset < m_totalSize
+           && m_nextOffset - m_ackedOffset < windowBytes) {
+        const int length = static_cast<int>(std::min<qint64>(m_chunkSize, m_totalSize - m_nextOffset));
+
+        // DATA packet: kind, id, offset, payload — read straight into the packet buffer
+        m_sendBuffer.resize(DATA_HEADER_SIZE + length);
+        char *out = m_sendBuffer.data();
+        out[0] = static_cast<char>(Data);
+        out[1] = static_cast<char>(m_transferId);
+        const quint32 offset = static_cast<quint32>(m_nextOffset);
+        out[2] = static_cast<char>(offset & 0xFF);
+        out[3] = static_cast<char>((offset >> 8) & 0xFF);
+        out[4] = static_cast<char>((offset >> 16) & 0xFF);
+        out[5] = static_cast<char>((offset >> 24) & 0xFF);
+
+        if (m_file.pos() != m_nextOffset && !m_file.seek(m_nextOffset)) {
+            fail(QStringLiteral("Seek failed: ") + m_file.errorString(), true);
+            return;
+        }
+        if (m_file.read(out + DATA_HEADER_SIZE, length) != length) {
+            fail(QStringLiteral("Read failed: ") + m_file.errorString(), true);
+            return;
+        }
+
+        // Advance before sending: a synchronous ACK may re-enter pumpWindow()
+        m_nextOffset += length;
+        m_packetInterface->sendPacket(m_sendBuffer);
+    }
+
+    if (!m_retransmitTimer->isActive()) {
+        m_retransmitTimer->start();
+    }
+}
+
+void BulkTransfer::handleAck(qint64 offset)
+{
+    offset = std::min(offset, m_totalSize);
+
+    if (offset <= m_ackedOffset) {
+        // Duplicate ACK: the receiver saw a gap; go back after a few of them
+        if (m_nextOffset > m_ackedOffset && ++m_duplicateAcks >= 3) {
+            m_duplicateAcks = 0;
+            m_nextOffset = m_ackedOffset;
+            pumpWindow();
+        }
+        return;
+    }
+
+    m_ackedOffset = offset;
+    if (m_nextOffset < m_ackedOffset) {
+        m_nextOffset = m_ackedOffset;
+    }
+    m_retransmits = 0;
+    m_duplicateAcks = 0;
+    m_retransmitTimer->start();
+    emit progressChanged();
+
+    if (m_ackedOffset >= m_totalSize) {
+        complete();
+        return;
+    }
+    pumpWindow();
+}
+
+// ── Receiver ──
+
+bool BulkTransfer::openSink(const QString &path, qint64 totalSize, qint64 offset)
+{
+    // Preallocate the whole file so in-order writes never extend it
+    m_file.setFileName(path + QStringLiteral(".part"));
+    if (!m_file.open(QIODevice::ReadWrite | QIODevice::Unbuffered)) {
+        fail(QStringLiteral("Cannot open %1: %2").arg(m_file.fileName(), m_file.errorString()), true);
+        return false;
+    }
+    if (m_file.size() != totalSize && !m_file.resize(totalSize)) {
+        fail(QStringLiteral("Cannot preallocate %1 bytes: %2").arg(totalSize).arg(m_file.errorString()), true);
+        return false;
+    }
+    if (!m_file.seek(offset)) {
+        fail(QStringLiteral("Seek failed: ") + m_file.errorString(), true);
+        return false;
+    }
+
+    if (m_staging.size() != STAGING_BUFFER_SIZE) {
+        m_staging.resize(STAGING_BUFFER_SIZE);
+    }
+    m_stagingUsed = 0;
+
+    m_totalSize = totalSize;
+    m_startOffset = offset;
+    m_ackedOffset = offset;
+    m_nextOffset = offset;
+    m_elapsed.start();
+    setState(Receiving);
+    m_retransmitTimer->start();
+
+    qDebug() << "BulkTransfer: Receiving" << totalSize << "bytes into" << m_file.fileName()
+             << "from offset" << offset;
+
+    if (m_nextOffset >= m_totalSize) {
+        sendAck();
+        complete();
+        return false;
+    }
+    return true;
+}
+
+void BulkTransfer::handleData(qint64 offset, const char *data, int length)
+{
+    if (offset != m_nextOffset) {
+        // Duplicate after a retransmit, or a gap: tell the sender where we are
+        sendAck();
+        return;
+    }
+
+    length = static_cast<int>(std::min<qint64>(length, m_totalSize - m_nextOffset));
+    while (length > 0) {
+        const int room = STAGING_BUFFER_SIZE - m_stagingUsed;
+        const int n = std::min(room, length);
+        memcpy(m_staging.data() + m_stagingUsed, data, n);
+        m_stagingUsed += n;
+        data += n;
+        length -= n;
+        m_nextOffset += n;
+        if (m_stagingUsed == STAGING_BUFFER_SIZE && !flushStaging()) {
+            return;
+        }
+    }
+
+    m_retransmits = 0;
+    m_retransmitTimer->start();
+
+    if (m_nextOffset >= m_totalSize) {
+        if (flushStaging()) {
+            sendAck();
+            complete();
+        }
+        return;
+    }
+
+    if (++m_packetsSinceAck >= std::max(1, m_windowSize / 2)) {
+        sendAck();
+    }
+}
+
+bool BulkTransfer::flushStaging()
+{
+    if (m_stagingUsed == 0) {
+        return true;
+    }
+
+    if (m_file.write(m_staging.constData(), m_stagingUsed) != m_stagingUsed) {
+        fail(QStringLiteral("Write failed: ") + m_file.errorString(), true);
+        return false;
+    }
+    m_ackedOffset += m_stagingUsed;
+    m_stagingUsed = 0;
+
+    writeResumeOffset(m_finalPath + QStringLiteral(".resume"), m_ackedOffset);
+    return true;
+}
+
+void BulkTransfer::sendAck()
+{
+    QByteArray body;
+    appendUint32(body, static_cast<quint32>(m_nextOffset));
+    sendPacket(Ack, body);
+    m_packetsSinceAck = 0;
+    emit progressChanged();
+}
+
+// ── Timeouts / completion ──
+
+void BulkTransfer::onRetransmitTimeout()
+{
+    if (!isActive()) {
+        return;
+    }
+
+    if (++m_retransmits > MAX_RETRANSMITS) {
+        fail(QStringLiteral("Peer not responding"), true);
+        return;
+    }
+
+    if (m_state == Opening) {
+        qDebug() << "BulkTransfer: No ACCEPT, resending OPEN";
+        sendPacket(Open, m_openBody);
+    } else if (m_state == Sending) {
+        qDebug() << "BulkTransfer: No ACK progress, resending from" << m_ackedOffset;
+        m_nextOffset = m_ackedOffset;
+        pumpWindow();
+    } else if (m_state == Receiving) {
+        sendAck();
+    }
+    m_retransmitTimer->start();
+}
+
+void BulkTransfer::complete()
+{
+    m_retransmitTimer->stop();
+    m_elapsedAtFinishMs = m_elapsed.isValid() ? m_elapsed.elapsed() : 0;
+
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+
+    if (!m_isSender) {
+        const QString partPath = m_finalPath + QStringLiteral(".part");
+        QFile::remove(m_finalPath);
+        if (!QFile::rename(partPath, m_finalPath)) {
+            fail(QStringLiteral("Cannot rename %1").arg(partPath), false);
+            return;
+        }
+        QFile::remove(m_finalPath + QStringLiteral(".resume"));
+    }
+
+    qDebug() << "BulkTransfer: Completed" << bytesTransferred() << "bytes in"
+             << m_elapsedAtFinishMs << "ms (" << qRound(throughput()) << "B/s)";
+
+    setState(Completed);
+    emit progressChanged();
+    emit finished(true, QString());
+}
+
+void BulkTransfer::fail(const QString &error, bool notifyPeer)
+{
+    qWarning() << "BulkTransfer: Failed:" << error;
+
+    m_retransmitTimer->stop();
+    m_elapsedAtFinishMs = m_elapsed.isValid() ? m_elapsed.elapsed() : 0;
+    m_lastError = error;
+
+    if (notifyPeer) {
+        sendPacket(Abort, error.toUtf8());
+    }
+
+    if (m_file.isOpen()) {
+        if (!m_isSender && m_state == Receiving) {
+            // Keep what we have so the next attempt can resume
+            m_file.write(m_staging.constData(), m_stagingUsed);
+            m_ackedOffset += m_stagingUsed;
+            m_stagingUsed = 0;
+            writeResumeOffset(m_finalPath + QStringLiteral(".resume"), m_ackedOffset);
+        }
+        m_file.close();
+    }
+
+    setState(Failed);
+    emit finished(false, error);
+}
+
+void BulkTransfer::resetTransfer()
+{
+    m_retransmitTimer->stop();
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+    m_elapsed.invalidate();
+    m_elapsedAtFinishMs = -1;
+    m_lastError.clear();
+    m_finalPath.clear();
+    m_totalSize = 0;
+    m_startOffset = 0;
+    m_ackedOffset = 0;
+    m_nextOffset = 0;
+    m_retransmits = 0;
+    m_duplicateAcks = 0;
+    m_packetsSinceAck = 0;
+    m_stagingUsed = 0;
+    m_openBody.clear();
+    m_acceptBody.clear();
+}
+
+void BulkTransfer::setState(State state)
+{
+    if (m_state != state) {
+        m_state = state;
+        emit stateChanged();
+    }
+}
+
+// ── Helpers ──
+
+void BulkTransfer::sendPacket(uint8_t kind, const QByteArray &body)
+{
+    QByteArray packet;
+    packet.reserve(2 + body.size());
+    packet.append(static_cast<char>(kind));
+    packet.append(static_cast<char>(m_transferId));
+    packet.append(body);
+    m_packetInterface->sendPacket(packet);
+}
+
+void BulkTransfer::appendUint32(QByteArray &out, quint32 value)
+{
+    out.append(static_cast<char>(value & 0xFF));
+    out.append(static_cast<char>((value >> 8) & 0xFF));
+    out.append(static_cast<char>((value >> 16) & 0xFF));
+    out.append(static_cast<char>((value >> 24) & 0xFF));
+}
+
+quint32 BulkTransfer::readUint32(const QByteArray &in, int offset)
+{
+    return quint32(static_cast<uint8_t>(in[offset]))
+         | quint32(static_cast<uint8_t>(in[offset + 1])) << 8
+         | quint32(static_cast<uint8_t>(in[offset + 2])) << 16
+         | quint32(static_cast<uint8_t>(in[offset + 3])) << 24;
+}
+
+qint64 BulkTransfer::readResumeOffset(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return 0;
+    }
+    bool ok = false;
+    const qint64 offset = file.readAll().trimmed().toLongLong(&ok);
+    return ok && offset > 0 ? offset : 0;
+}
+
+void BulkTransfer::writeResumeOffset(const QString &path, qint64 offset)
+{
+    QFile file(path);
+    if (file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        file.write(QByteArray::number(offset));
+    }
+}
@@ -0,0 +1,179 @@
+#ifndef BULKTRANSFER_H
+#define BULKTRANSFER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QString>
+#include <QTimer>
+
+class PacketInterface;
+
+/**
+ * BulkTransfer - windowed, resumable file transfer over a PacketInterface link.
+ *
+ * One side sends DATA packets for up to windowSize() chunks ahead of the last
+ * cumulative ACK; the other side writes in-order data straight into a
+ * preallocated ".part" file through a fixed staging buffer and acknowledges
+ * every half window. A stalled window is retransmitted from the last ACK
+ * (go-back-N), and an unanswered OPEN is resent; a responder answers a
+ * repeated OPEN with its ACCEPT again, and a receiver that completed answers
+ * late DATA of that transfer with its final ACK again, in case it was lost.
+ * Progress is persisted in a ".resume" sidecar so an interrupted download
+ * continues from the last flushed offset.
+ *
+ * Either end can initiate (startDownload/startUpload). The responding end only
+ * needs setServeDirectory(); two instances whose PacketInterfaces are wired
+ * back to back (packetToSend -> onDataReceived, queued) make a simulated peer
+ * for exercising the protocol without a robot.
+ *
+ * Packet layout (inside a PacketInterface frame), little-endian:
+ *   OPEN   10 <id> <dir> <offset:4> <size:4> <name...>   dir 0=download, 1=upload
+ *   ACCEPT 11 <id> <offset:4> <size:4>
+ *   DATA   12 <id> <offset:4> <bytes...>
+ *   ACK    13 <id> <offset:4>
+ *   ABORT  14 <id> <reason...>
+ */
+class BulkTransfer : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(State state READ state NOTIFY stateChanged)
+    Q_PROPERTY(qint64 bytesTransferred READ bytesTransferred NOTIFY progressChanged)
+    Q_PROPERTY(qint64 totalBytes READ totalBytes NOTIFY progressChanged)
+    Q_PROPERTY(double throughput READ throughput NOTIFY progressChanged)
+
+public:
+    enum PacketKind : uint8_t {
+        Open   = 0x10,
+        Accept = 0x11,
+        Data   = 0x12,
+        Ack    = 0x13,
+        Abort  = 0x14
+    };
+
+    enum State {
+        Idle,
+        Opening,
+        Sending,
+        Receiving,
+        Completed,
+        Failed
+    };
+    Q_ENUM(State)
+
+    static constexpr int DATA_HEADER_SIZE = 6;
+    static constexpr int DEFAULT_CHUNK_SIZE = 20 - 3 - DATA_HEADER_SIZE;
+    static constexpr int DEFAULT_WINDOW_SIZE = 16;
+    static constexpr int STAGING_BUFFER_SIZE = 64 * 1024;
+    static constexpr int RETRANSMIT_TIMEOUT_MS = 1500;
+    static constexpr int MAX_RETRANSMITS = 8;
+
+    explicit BulkTransfer(PacketInterface *packetInterface, QObject *parent = nullptr);
+    ~BulkTransfer();
+
+    /** Pull remoteName from the peer into localPath (resumes a partial download) */
+    bool startDownload(const QString &remoteName, const QString &localPath);
+
+    /** Push localPath to the peer as remoteName (peer decides the resume offset) */
+    bool startUpload(const QString &localPath, const QString &remoteName);
+
+    /** Abort the running transfer and tell the peer */
+    void abort(const QString &reason = QString());
+
+    /** Serve/store files for transfers the peer initiates (robot side / simulated peer) */
+    void setServeDirectory(const QString &directory) { m_serveDirectory = directory; }
+
+    /** Payload bytes per DATA packet; derive from the negotiated ATT MTU */
+    void setChunkSize(int bytes);
+    int chunkSize() const { return m_chunkSize; }
+
+    /** Number of DATA packets allowed ahead of the last ACK */
+    void setWindowSize(int packets);
+    int windowSize() const { return m_windowSize; }
+
+    State state() const { return m_state; }
+    bool isActive() const { return m_state == Opening || m_state == Sending || m_state == Receiving; }
+    qint64 bytesTransferred() const;
+    qint64 totalBytes() const { return m_totalSize; }
+    QString lastError() const { return m_lastError; }
+
+    /** Payload throughput of the current/last transfer in bytes per second */
+    double throughput() const;
+
+    /**
+     * Upper bound for payload throughput on a link: chunk payload per packet,
+     * times packets per connection event, per connection interval.
+     */
+    static double theoreticalThroughput(int attMtu, double connectionIntervalMs,
+                                        int packetsPerEvent = 4);
+
+signals:
+    void stateChanged();
+    void progressChanged();
+    void finished(bool success, const QString &error);
+
+private slots:
+    void onPacketReceived(const QByteArray &packet);
+    void onRetransmitTimeout();
+
+private:
+    void setState(State state);
+    void fail(const QString &error, bool notifyPeer);
+    void complete();
+    void resetTransfer();
+
+    // Sender side
+    bool openSource(const QString &path, qint64 offset);
+    void beginSending(qint64 offset);
+    void pumpWindow();
+    void handleAck(qint64 offset);
+
+    // Receiver side
+    bool openSink(const QString &path, qint64 totalSize, qint64 offset);
+    void handleData(qint64 offset, const char *data, int length);
+    bool flushStaging();
+    void sendAck();
+
+    // Responder side
+    void handleOpen(const QByteArray &packet);
+
+    void sendPacket(uint8_t kind, const QByteArray &body);
+    static void appendUint32(QByteArray &out, quint32 value);
+    static quint32 readUint32(const QByteArray &in, int offset);
+    static qint64 readResumeOffset(const QString &path);
+    static void writeResumeOffset(const QString &path, qint64 offset);
+
+    PacketInterface *m_packetInterface;
+    QTimer *m_retransmitTimer;
+    QElapsedTimer m_elapsed;
+    qint64 m_elapsedAtFinishMs;
+
+    State m_state;
+    uint8_t m_transferId;
+    uint8_t m_nextTransferId;
+    QString m_lastError;
+    QString m_serveDirectory;
+
+    int m_chunkSize;
+    int m_windowSize;
+
+    qint64 m_totalSize;
+    qint64 m_startOffset;
+    qint64 m_ackedOffset;       // sender: peer ACKed; receiver: flushed to disk
+    qint64 m_nextOffset;        // sender: next byte to send; receiver: next byte expected
+    bool m_isSender;
+    int m_retransmits;
+    int m_duplicateAcks;
+    int m_packetsSinceAck;
+
+    QFile m_file;
+    QString m_finalPath;
+    QByteArray m_staging;
+    int m_stagingUsed;
+    QByteArray m_sendBuffer;
+    QByteArray m_openBody;      // initiator: resent until ACCEPT arrives
+    QByteArray m_acceptBody;    // responder: resent when the peer repeats OPEN
+};
+
+#endif // BULKTRANSFER_H
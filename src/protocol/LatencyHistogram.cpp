@@ -0,0 +1,105 @@
+#include "LatencyHistogram.h"
+#include <QtAlgorithms>
+#include <cmath>
+#include <limits>
+
+LatencyHistogram::LatencyHistogram()
+{
+    reset();
+}
+
+void LatencyHistogram::reset()
+{
+    m_buckets.fill(0);
+    m_count = 0;
+    m_sum = 0;
+    m_min = std::numeric_limits<qint64>::max();
+    m_max = 0;
+}
+
+int LatencyHistogram::bucketIndex(qint64 valueUs)
+{
+    // Values below SUB_BUCKET_COUNT map 1:1; above that, each octave is split
+    // into SUB_BUCKET_HALF linear sub-buckets:
+    //   index = shift * SUB_BUCKET_HALF + (value >> shift)
+    const quint64 value = static_cast<quint64>(valueUs);
+    if (value < quint64(SUB_BUCKET_COUNT))
+        return int(value);
+
+    const int msb = 63 - int(qCountLeadingZeroBits(value));
+    const int shift = msb - (SUB_BUCKET_BITS - 1);
+    const int sub = int(value >> shift);
+    return shift * SUB_BUCKET_HALF + sub;
+}
+
+qint64 LatencyHistogram::bucketUpperBound(int index)
+{
+    if (index < SUB_BUCKET_COUNT)
+        return index;
+
+    const int shift = index / SUB_BUCKET_HALF - 1;
+    const qint64 sub = index % SUB_BUCKET_HALF + SUB_BUCKET_HALF;
+    return ((sub + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(qint64 valueUs)
+{
+    const qint64 maxValue = (qint64(1) << MAX_VALUE_BITS) - 1;
+    if (valueUs < 0)
+        valueUs = 0;
+    else if (valueUs > maxValue)
+        valueUs = maxValue;
+
+    m_buckets[bucketIndex(valueUs)]++;
+    m_count++;
+    m_sum += valueUs;
+    if (valueUs < m_min) m_min = valueUs;
+    if (valueUs > m_max) m_max = valueUs;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram &other)
+{
+    if (other.m_count == 0)
+        return;
+
+    for (int i = 0; i < BUCKET_COUNT; ++i)
+        m_buckets[i] += other.m_buckets[i];
+    m_count += other.m_count;
+    m_sum += other.m_sum;
+    if (other.m_min < m_min) m_min = other.m_min;
+    if (other.m_max > m_max) m_max = other.m_max;
+}
+
+qint64 LatencyHistogram::percentile(double pct) const
+{
+    if (m_count == 0)
+        return 0;
+
+    if (pct < 0.0) pct = 0.0;
+    if (pct > 100.0) pct = 100.0;
+
+    // Rank of the requested sample (1-based), rounded up (nearest-rank)
+    quint64 rank = quint64(std::ceil(pct / 100.0 * double(m_count)));
+    if (rank < 1) rank = 1;
+    if (rank > m_count) rank = m_count;
+
+    quint64 seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        seen += m_buckets[i];
+        if (seen >= rank) {
+            const qint64 upper = bucketUpperBound(i);
+            return upper < m_max ? upper : m_max;
+        }
+    }
+    return m_max;
+}
+
+QString LatencyHistogram::summary() const
+{
+    auto ms = [](qint64 us) { return QString::number(us / 1000.0, 'f', 2); };
+
+    return QStringLiteral("n=%1 min=%2 p50=%3 p90=%4 p99=%5 max=%6 ms")
+        .arg(m_count)
+        .arg(ms(min()), ms(percentile(50)), ms(percentile(90)),
+             ms(percentile(99)), ms(max()));
+}
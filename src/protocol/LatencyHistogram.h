@@ -0,0 +1,54 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <QtGlobal>
+#include <QString>
+#include <array>
+
+/**
+ * LatencyHistogram - fixed-size, HDR-style latency histogram (microseconds).
+ *
+ * Values are bucketed by power of two with 16 linear sub-buckets per octave,
+ * so every recorded value is kept with ~6% relative precision from 1 us up to
+ * ~12 days. Recording is O(1) and allocation-free; the whole histogram is a
+ * flat array that can be copied or merged cheaply.
+ */
+class LatencyHistogram
+{
+public:
+    static constexpr int SUB_BUCKET_BITS = 5;
+    static constexpr int SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;         // 32
+    static constexpr int SUB_BUCKET_HALF = SUB_BUCKET_COUNT / 2;          // 16
+    static constexpr int MAX_VALUE_BITS = 40;
+    static constexpr int BUCKET_COUNT = (MAX_VALUE_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKET_HALF
+                                    + SUB_BUCKET_HALF;
+
+    LatencyHistogram();
+
+    void record(qint64 valueUs);
+    void merge(const LatencyHistogram &other);
+    void reset();
+
+    quint64 count() const { return m_count; }
+    qint64 min() const { return m_count ? m_min : 0; }
+    qint64 max() const { return m_max; }
+    double mean() const { return m_count ? double(m_sum) / double(m_count) : 0.0; }
+
+    /** Value at the given percentile (0..100), reported as the bucket's upper bound */
+    qint64 percentile(double pct) const;
+
+    /** One-line summary: count, min, p50, p90, p99, max (milliseconds) */
+    QString summary() const;
+
+private:
+    static int bucketIndex(qint64 valueUs);
+    static qint64 bucketUpperBound(int index);
+
+    std::array<quint32, BUCKET_COUNT> m_buckets;
+    quint64 m_count;
+    qint64 m_sum;
+    qint64 m_min;
+    qint64 m_max;
+};
+
+#endif // LATENCYHISTOGRAM_H
@@ -0,0 +1,23 @@
+#include "MonotonicClock.h"
+#include <chrono>
+
+qint64 MonotonicClock::nowNs()
+{
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+QDateTime MonotonicClock::toDateTime(qint64 stampNs)
+{
+    // Age of the stamp on the monotonic clock, applied to the wall clock now
+    const qint64 ageMs = (nowNs() - stampNs) / 1000000;
+    return QDateTime::currentDateTime().addMSecs(-ageMs);
+}
+
+QString MonotonicClock::toString(qint64 stampNs, const QString &format)
+{
+    if (stampNs <= 0) {
+        return QString();
+    }
+    return toDateTime(stampNs).toString(format);
+}
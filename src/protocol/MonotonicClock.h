@@ -0,0 +1,31 @@
+#ifndef MONOTONICCLOCK_H
+#define MONOTONICCLOCK_H
+
+#include <QtGlobal>
+#include <QDateTime>
+#include <QString>
+
+/**
+ * MonotonicClock - the one clock every internal timestamp comes from.
+ *
+ * Nanoseconds from std::chrono::steady_clock, stored as qint64. Reading it is
+ * a vDSO call with no timezone work, it never jumps with NTP or manual clock
+ * changes, and stamps taken on the BLE worker and the GUI thread compare
+ * directly. Latency metrics, staleness checks and recordings all use it;
+ * wall-clock time is only derived when a stamp is shown or exported.
+ */
+class MonotonicClock
+{
+public:
+    static qint64 nowNs();
+    static qint64 nowUs() { return nowNs() / 1000; }
+    static qint64 nowMs() { return nowNs() / 1000000; }
+
+    /** Wall-clock time of a stamp, as seen from the current wall clock */
+    static QDateTime toDateTime(qint64 stampNs);
+
+    /** toDateTime(stampNs) formatted; empty for stamps <= 0 (never set) */
+    static QString toString(qint64 stampNs, const QString &format);
+};
+
+#endif // MONOTONICCLOCK_H
@@ -1,4 +1,6 @@
 #include "PacketInterface.h"
+#include "MonotonicClock.h"
+#include <QDebug>
 
 PacketInterface::PacketInterface(QObject *parent)
     : QObject(parent)
@@ -7,12 +9,80 @@ PacketInterface::PacketInterface(QObject *parent)
 
 void PacketInterface::sendPacket(const QByteArray &data)
 {
-    // For now, just pass through the raw data
-    emit packetToSend(data);
+    if (data.size() > MAX_PAYLOAD_SIZE) {
+        qWarning() << "PacketInterface: Packet too large:" << data.size();
+        return;
+    }
+
+    QByteArray frame;
+    frame.reserve(HEADER_SIZE + data.size());
+    frame.append(static_cast<char>(FRAME_START));
+    frame.append(static_cast<char>(data.size() & 0xFF));
+    frame.append(static_cast<char>((data.size() >> 8) & 0xFF));
+    frame.append(data);
+
+    emit packetToSend(frame);
+}
+
+void PacketInterface::reset()
+{
+    m_rxBuffer.clear();
+    m_partialSinceNs = -1;
 }
 
 void PacketInterface::onDataReceived(const QByteArray &data)
 {
-    // For now, just pass through the raw data
-    emit packetReceived(data);
+    const qint64 nowNs = MonotonicClock::nowNs();
+    if (m_partialSinceNs >= 0 && nowNs - m_partialSinceNs > qint64(RESYNC_TIMEOUT_MS) * 1000000) {
+        // Never completed: most likely a stray start byte, not a frame
+        qWarning() << "PacketInterface: Frame incomplete after" << RESYNC_TIMEOUT_MS
+                   << "ms, resynchronising";
+        m_rxBuffer.remove(0, 1);
+        m_partialSinceNs = -1;
+    }
+
+    m_rxBuffer.append(data);
+
+    // Extract as many complete frames as the buffer holds
+    int pos = 0;
+    while (m_rxBuffer.size() - pos >= HEADER_SIZE) {
+        const uint8_t start = static_cast<uint8_t>(m_rxBuffer[pos]);
+        if (start != FRAME_START && start != SEQUENCED_FRAME_START) {
+            // Not a frame start; resynchronise on the next start byte
+            int next = pos + 1;
+            while (next < m_rxBuffer.size()
+                   && static_cast<uint8_t>(m_rxBuffer[next]) != FRAME_START
+                   && static_cast<uint8_t>(m_rxBuffer[next]) != SEQUENCED_FRAME_START) {
+                next++;
+            }
+            pos = next;
+            continue;
+        }
+
+        const int headerLen = start == SEQUENCED_FRAME_START ? HEADER_SIZE + SEQUENCE_SIZE
+                                                             : HEADER_SIZE;
+        int payloadLen = static_cast<uint8_t>(m_rxBuffer[pos + 1]) |
+                         (static_cast<uint8_t>(m_rxBuffer[pos + 2]) << 8);
+        if (m_rxBuffer.size() - pos < headerLen + payloadLen) {
+            break; // Need more data
+        }
+
+        if (start == SEQUENCED_FRAME_START) {
+            emit sequenceReceived(static_cast<uint8_t>(m_rxBuffer[pos + 3]) |
+                                  (static_cast<uint8_t>(m_rxBuffer[pos + 4]) << 8));
+        }
+        emit packetReceived(m_rxBuffer.mid(pos + headerLen, payloadLen));
+        pos += headerLen + payloadLen;
+    }
+
+    if (pos > 0) {
+        m_rxBuffer.remove(0, pos);
+    }
+
+    // What is left is the start of a frame; its clock starts when it is first seen
+    if (m_rxBuffer.isEmpty()) {
+        m_partialSinceNs = -1;
+    } else if (pos > 0 || m_partialSinceNs < 0) {
+        m_partialSinceNs = nowNs;
+    }
 }
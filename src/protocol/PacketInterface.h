@@ -4,21 +4,54 @@
 #include <QObject>
 #include <QByteArray>
 
+/**
+ * PacketInterface - length-prefixed packet framing over a byte stream (NUS).
+ *
+ * Frame layout:  FA <len_lo> <len_hi> <payload...>
+ * Sequenced:     FB <len_lo> <len_hi> <seq_lo> <seq_hi> <payload...>
+ *
+ * Outgoing packets are framed and handed to the transport via packetToSend();
+ * incoming notification chunks are reassembled and complete payloads are
+ * emitted via packetReceived(). Several frames may share one notification and
+ * one frame may span several, so the link can be kept full. Peripherals may
+ * number their frames (length covers the payload only); the number is
+ * reported through sequenceReceived() ahead of the payload.
+ *
+ * Frames carry no checksum, so a stray start byte reads as a header with an
+ * arbitrary length. A frame still incomplete RESYNC_TIMEOUT_MS after it began
+ * is taken for one: its start byte is dropped when more data arrives and the
+ * parser resynchronises on the next start byte.
+ */
 class PacketInterface : public QObject
 {
     Q_OBJECT
 
 public:
+    static const uint8_t FRAME_START = 0xFA;
+    static const uint8_t SEQUENCED_FRAME_START = 0xFB;
+    static constexpr int HEADER_SIZE = 3;
+    static constexpr int SEQUENCE_SIZE = 2;
+    static constexpr int MAX_PAYLOAD_SIZE = 0xFFFF;
+    static constexpr int RESYNC_TIMEOUT_MS = 2000;
+
     explicit PacketInterface(QObject *parent = nullptr);
 
     void sendPacket(const QByteArray &data);
 
+    /** Drop any partially received frame (e.g. after a reconnect) */
+    void reset();
+
 signals:
     void packetReceived(const QByteArray &data);
+    void sequenceReceived(quint16 sequence);
     void packetToSend(const QByteArray &data);
 
 public slots:
     void onDataReceived(const QByteArray &data);
+
+private:
+    QByteArray m_rxBuffer;
+    qint64 m_partialSinceNs = -1;      // MonotonicClock; when the incomplete frame began
 };
 
 #endif // PACKETINTERFACE_H
@@ -0,0 +1,234 @@
+#include "RpcClient.h"
+#include "PacketInterface.h"
+#include <QDebug>
+#include <QStringList>
+#include <algorithm>
+#include <limits>
+
+RpcClient::RpcClient(PacketInterface *packetInterface, QObject *parent)
+    : QObject(parent)
+    , m_packetInterface(packetInterface)
+    , m_timeoutTimer(new QTimer(this))
+    , m_lastCallId(0)
+    , m_inFlight(0)
+    , m_maxInFlight(DEFAULT_MAX_IN_FLIGHT)
+{
+    m_timeoutTimer->setSingleShot(true);
+    connect(m_timeoutTimer, &QTimer::timeout, this, &RpcClient::checkTimeouts);
+
+    connect(m_packetInterface, &PacketInterface::packetReceived,
+            this, &RpcClient::onPacketReceived);
+}
+
+RpcClient::~RpcClient()
+{
+    // Callbacks may capture objects that are going away too; drop them silently
+    m_pending.clear();
+    m_sendQueue.clear();
+}
+
+quint16 RpcClient::nextCallId()
+{
+    // 0 is reserved as "no call"; skip ids that are still pending after wrap-around
+    do {
+        ++m_lastCallId;
+    } while (m_lastCallId == 0 || m_pending.contains(m_lastCallId));
+    return m_lastCallId;
+}
+
+quint16 RpcClient::call(uint8_t method, const QByteArray &payload, Callback callback, int timeoutMs)
+{
+    const quint16 callId = nextCallId();
+
+    PendingCall pending;
+    pending.method = method;
+    pending.payload = payload;
+    pending.callback = std::move(callback);
+    pending.deadlineUs = nowUs() + qint64(timeoutMs) * 1000;
+    m_pending.insert(callId, pending);
+    m_sendQueue.append(callId);
+
+    sendQueued();
+    updateTimeoutTimer();
+    return callId;
+}
+
+void RpcClient::sendQueued()
+{
+    while (m_inFlight < m_maxInFlight && !m_sendQueue.isEmpty()) {
+        const quint16 callId = m_sendQueue.takeFirst();
+        auto it = m_pending.find(callId);
+        if (it == m_pending.end()) {
+            continue; // Cancelled while queued
+        }
+
+        QByteArray packet;
+        packet.reserve(HEADER_SIZE + it->payload.size());
+        packet.append(static_cast<char>(Request));
+        packet.append(static_cast<char>(callId & 0xFF));
+        packet.append(static_cast<char>((callId >> 8) & 0xFF));
+        packet.append(static_cast<char>(it->method));
+        packet.append(it->payload);
+
+        it->sentAtUs = nowUs();
+        it->payload.clear();
+        m_inFlight++;
+
+        m_packetInterface->sendPacket(packet);
+    }
+}
+
+bool RpcClient::cancel(quint16 callId)
+{
+    if (!m_pending.contains(callId)) {
+        return false;
+    }
+    finish(callId, Cancelled, QByteArray());
+    return true;
+}
+
+void RpcClient::cancelAll(CallStatus status)
+{
+    const QList<quint16> ids = m_pending.keys();
+    for (quint16 callId : ids) {
+        finish(callId, status, QByteArray());
+    }
+    m_sendQueue.clear();
+}
+
+void RpcClient::setMaxInFlight(int count)
+{
+    m_maxInFlight = std::max(1, count);
+    sendQueued();
+}
+
+void RpcClient::finish(quint16 callId, CallStatus status, const QByteArray &payload)
+{
+    auto it = m_pending.find(callId);
+    if (it == m_pending.end()) {
+        return;
+    }
+
+    // Take the call out before running the callback: it may issue new calls
+    PendingCall pending = std::move(it.value());
+    m_pending.erase(it);
+
+    qint64 latencyUs = -1;
+    if (pending.sentAtUs >= 0) {
+        m_inFlight--;
+        latencyUs = nowUs() - pending.sentAtUs;
+        if (status == Ok || status == RemoteError) {
+            m_methodLatency[pending.method].record(latencyUs);
+        }
+    } else {
+        m_sendQueue.removeOne(callId);
+    }
+
+    if (pending.callback) {
+        pending.callback(status, payload);
+    }
+    emit callFinished(callId, pending.method, status, payload, latencyUs);
+
+    sendQueued();
+    updateTimeoutTimer();
+}
+
+void RpcClient::onPacketReceived(const QByteArray &packet)
+{
+    if (packet.size() < HEADER_SIZE) {
+        return;
+    }
+
+    const uint8_t kind = static_cast<uint8_t>(packet[0]);
+    if (kind != Response && kind != ErrorResponse) {
+        return; // Not an RPC reply (unsolicited data is handled elsewhere)
+    }
+
+    const quint16 callId = static_cast<uint8_t>(packet[1]) |
+                           (static_cast<uint8_t>(packet[2]) << 8);
+    const uint8_t method = static_cast<uint8_t>(packet[3]);
+
+    auto it = m_pending.constFind(callId);
+    if (it == m_pending.constEnd() || it->sentAtUs < 0) {
+        qDebug() << "RpcClient: Late or unknown response id" << callId;
+        return;
+    }
+    if (it->method != method) {
+        qWarning() << "RpcClient: Method mismatch for id" << callId
+                   << "expected" << int(it->method) << "got" << int(method);
+        return;
+    }
+
+    finish(callId, kind == Response ? Ok : RemoteError, packet.mid(HEADER_SIZE));
+}
+
+void RpcClient::checkTimeouts()
+{
+    const qint64 now = nowUs();
+
+    QList<quint16> expired;
+    for (auto it = m_pending.constBegin(); it != m_pending.constEnd(); ++it) {
+        if (it->deadlineUs <= now) {
+            expired.append(it.key());
+        }
+    }
+
+    for (quint16 callId : expired) {
+        qWarning() << "RpcClient: Call" << callId << "timed out";
+        finish(callId, Timeout, QByteArray());
+    }
+
+    updateTimeoutTimer();
+}
+
+void RpcClient::updateTimeoutTimer()
+{
+    if (m_pending.isEmpty()) {
+        m_timeoutTimer->stop();
+        return;
+    }
+
+    qint64 earliest = std::numeric_limits<qint64>::max();
+    for (const PendingCall &pending : std::as_const(m_pending)) {
+        earliest = std::min(earliest, pending.deadlineUs);
+    }
+
+    const qint64 delayMs = std::max<qint64>(0, (earliest - nowUs() + 999) / 1000);
+    m_timeoutTimer->start(static_cast<int>(delayMs));
+}
+
+QString RpcClient::latencyReport() const
+{
+    QList<uint8_t> keys = m_methodLatency.keys();
+    std::sort(keys.begin(), keys.end());
+
+    QStringList lines;
+    for (uint8_t method : std::as_const(keys)) {
+        lines.append(methodName(method) + QStringLiteral(": ")
+                     + m_methodLatency.value(method).summary());
+    }
+    return lines.join('\n');
+}
+
+QString RpcClient::methodName(uint8_t method)
+{
+    switch (method) {
+    case Ping:        return QStringLiteral("Ping");
+    case ReadConfig:  return QStringLiteral("ReadConfig");
+    case WriteConfig: return QStringLiteral("WriteConfig");
+    case Diagnostics: return QStringLiteral("Diagnostics");
+    default:          return QStringLiteral("Method 0x%1").arg(int(method), 2, 16, QLatin1Char('0'));
+    }
+}
+
+QString RpcClient::statusToString(CallStatus status)
+{
+    switch (status) {
+    case Ok:          return QStringLiteral("Ok");
+    case RemoteError: return QStringLiteral("RemoteError");
+    case Timeout:     return QStringLiteral("Timeout");
+    case Cancelled:   return QStringLiteral("Cancelled");
+    case LinkDown:    return QStringLiteral("LinkDown");
+    default:          return QStringLiteral("Unknown");
+    }
+}
@@ -0,0 +1,125 @@
+#ifndef RPCCLIENT_H
+#define RPCCLIENT_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QTimer>
+#include <functional>
+#include "LatencyHistogram.h"
+#include "MonotonicClock.h"
+
+class PacketInterface;
+
+/**
+ * RpcClient - pipelined request/response calls on top of PacketInterface.
+ *
+ * Each call carries a 16-bit correlation id, so up to maxInFlight() requests
+ * can be outstanding on one link at the same time; further calls are queued
+ * and sent as responses come back. Every call has its own timeout and can be
+ * cancelled. Round-trip latency is recorded per method.
+ *
+ * RPC packet layout (inside a PacketInterface frame):
+ *   <kind> <id_lo> <id_hi> <method> <payload...>
+ */
+class RpcClient : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum PacketKind : uint8_t {
+        Request       = 0x01,
+        Response      = 0x02,
+        ErrorResponse = 0x03
+    };
+
+    // Well-known methods understood by the robot firmware
+    enum Method : uint8_t {
+        Ping        = 0x01,
+        ReadConfig  = 0x02,
+        WriteConfig = 0x03,
+        Diagnostics = 0x04
+    };
+
+    enum CallStatus {
+        Ok,
+        RemoteError,
+        Timeout,
+        Cancelled,
+        LinkDown
+    };
+
+    using Callback = std::function<void(CallStatus status, const QByteArray &payload)>;
+
+    static constexpr int HEADER_SIZE = 4;
+    static constexpr int DEFAULT_TIMEOUT_MS = 2000;
+    static constexpr int DEFAULT_MAX_IN_FLIGHT = 8;
+
+    explicit RpcClient(PacketInterface *packetInterface, QObject *parent = nullptr);
+    ~RpcClient();
+
+    /**
+     * Issue a request; returns its correlation id (never 0).
+     * The callback (optional) runs exactly once: on response, error, timeout
+     * or cancel. callFinished() is emitted right after it.
+     */
+    quint16 call(uint8_t method, const QByteArray &payload, Callback callback,
+                 int timeoutMs = DEFAULT_TIMEOUT_MS);
+
+    /** Cancel one call; returns false if it already completed */
+    bool cancel(quint16 callId);
+
+    /** Fail every pending call with the given status (e.g. LinkDown on disconnect) */
+    void cancelAll(CallStatus status = Cancelled);
+
+    int pendingCount() const { return m_pending.size(); }
+    int inFlightCount() const { return m_inFlight; }
+
+    int maxInFlight() const { return m_maxInFlight; }
+    void setMaxInFlight(int count);
+
+    /** Round-trip latency for one method (empty histogram if never called) */
+    LatencyHistogram methodLatency(uint8_t method) const { return m_methodLatency.value(method); }
+    QList<uint8_t> methods() const { return m_methodLatency.keys(); }
+
+    /** Multi-line per-method latency summary */
+    QString latencyReport() const;
+
+    static QString methodName(uint8_t method);
+    static QString statusToString(CallStatus status);
+
+signals:
+    void callFinished(quint16 callId, int method, int status, const QByteArray &payload,
+                      qint64 latencyUs);
+
+private slots:
+    void onPacketReceived(const QByteArray &packet);
+    void checkTimeouts();
+
+private:
+    struct PendingCall {
+        uint8_t method = 0;
+        QByteArray payload;
+        Callback callback;
+        qint64 deadlineUs = 0;
+        qint64 sentAtUs = -1;      // -1 while still queued
+    };
+
+    quint16 nextCallId();
+    void sendQueued();
+    void finish(quint16 callId, CallStatus status, const QByteArray &payload);
+    void updateTimeoutTimer();
+    static qint64 nowUs() { return MonotonicClock::nowUs(); }
+
+    PacketInterface *m_packetInterface;
+    QHash<quint16, PendingCall> m_pending;
+    QList<quint16> m_sendQueue;
+    QHash<uint8_t, LatencyHistogram> m_methodLatency;
+    QTimer *m_timeoutTimer;
+    quint16 m_lastCallId;
+    int m_inFlight;
+    int m_maxInFlight;
+};
+
+#endif // RPCCLIENT_H